@@ -53,6 +53,19 @@ namespace embree
 	for (size_t i=1; i<N; i++)
 	  passed &= src[i-1] <= src[i];
       }
+
+      /* keys that differ only in a single byte skip all other passes */
+      for (size_t N=10; N<1000000; N=size_t(2.1*N))
+      {
+	std::vector<Key> src(N); memset(src.data(),0,N*sizeof(Key));
+	std::vector<Key> tmp(N); memset(tmp.data(),0,N*sizeof(Key));
+	for (size_t i=0; i<N; i++) src[i] = Key(0x01000007) | (Key(rand() & 0xff) << 16);
+
+	radix_sort<Key>(src.data(),tmp.data(),N);
+
+	for (size_t i=1; i<N; i++)
+	  passed &= src[i-1] <= src[i];
+      }
       
       return passed;
     }
@@ -269,6 +269,7 @@ namespace embree
     static const size_t MAX_TASKS = 512;
     static const size_t BITS = 8;
     static const size_t BUCKETS = (1 << BITS);
+    static const size_t WC_ITEMS = 64/sizeof(Ty); // items per write combining buffer
     typedef unsigned int TyRadixCount[BUCKETS];
     
     template<typename T>
@@ -390,49 +391,103 @@ namespace embree
       }
       
       /* copy items into their buckets */
+      if (WC_ITEMS > 1)
+        scatterBlocked(shift,src,dst,offset,startID,endID);
+      else
+      {
 #if defined(__INTEL_COMPILER)
 #pragma nounroll
 #endif
-      for (size_t i=startID; i<endID; i++) {
+        for (size_t i=startID; i<endID; i++) {
+          const Ty elt = src[i];
+#if defined(__X86_64__)
+          const size_t index = ((size_t)(Key)src[i] >> (size_t)shift) & (size_t)mask;
+#else
+          const size_t index = ((Key)src[i] >> shift) & mask;
+#endif
+          dst[offset[index]++] = elt;
+        }
+      }
+    }
+
+    /* scatters items through one cache line sized buffer per bucket,
+     * such that the destination array is written in full cache lines */
+    __noinline void scatterBlocked(const Key shift,
+                                   const Ty* __restrict const src,
+                                   Ty* __restrict const dst,
+                                   unsigned int* __restrict const offset,
+                                   const size_t startID, const size_t endID)
+    {
+      const Key mask = BUCKETS-1;
+      __aligned(64) Ty buffer[BUCKETS][WC_ITEMS > 1 ? WC_ITEMS : 1];
+      __aligned(64) unsigned int fill[BUCKETS];
+      for (size_t i=0; i<BUCKETS; i++)
+        fill[i] = 0;
+
+      for (size_t i=startID; i<endID; i++)
+      {
         const Ty elt = src[i];
 #if defined(__X86_64__)
-        const size_t index = ((size_t)(Key)src[i] >> (size_t)shift) & (size_t)mask;
+        const size_t index = ((size_t)(Key)elt >> (size_t)shift) & (size_t)mask;
 #else
-        const size_t index = ((Key)src[i] >> shift) & mask;
+        const size_t index = ((Key)elt >> shift) & mask;
 #endif
-        dst[offset[index]++] = elt;
+        buffer[index][fill[index]++] = elt;
+        if (unlikely(fill[index] == WC_ITEMS))
+        {
+          Ty* __restrict const d = &dst[offset[index]];
+          for (size_t j=0; j<WC_ITEMS; j++) d[j] = buffer[index][j];
+          offset[index] += WC_ITEMS;
+          fill[index] = 0;
+        }
       }
+
+      /* flush partially filled buffers */
+      for (size_t i=0; i<BUCKETS; i++)
+        for (size_t j=0; j<fill[i]; j++)
+          dst[offset[i]++] = buffer[i][j];
     }
     
-    void tbbRadixIteration(const Key shift, const bool last,
+    /* returns false if the pass got skipped as all items fall into the same bucket */
+    bool tbbRadixIteration(const Key shift,
                            const Ty* __restrict src, Ty* __restrict dst,
                            const size_t numTasks)
     {
       affinity_partitioner ap;
       parallel_for_affinity(numTasks,[&] (size_t taskIndex) { tbbRadixIteration0(shift,src,dst,taskIndex,numTasks); },ap);
+
+      /* skip this pass if it would not reorder any items */
+      for (size_t b=0; b<BUCKETS; b++)
+      {
+        size_t total = 0;
+        for (size_t i=0; i<numTasks; i++) total += radixCount[i][b];
+        if (total == N) return false;
+        if (total != 0) break;
+      }
+
       parallel_for_affinity(numTasks,[&] (size_t taskIndex) { tbbRadixIteration1(shift,src,dst,taskIndex,numTasks); },ap);
+      return true;
     }
     
     void tbbRadixSort(const size_t numTasks)
     {
       radixCount = (TyRadixCount*) alignedMalloc(MAX_TASKS*sizeof(TyRadixCount),64);
-      
-      if (sizeof(Key) == sizeof(uint32_t)) {
-        tbbRadixIteration(0*BITS,0,src,tmp,numTasks);
-        tbbRadixIteration(1*BITS,0,tmp,src,numTasks);
-        tbbRadixIteration(2*BITS,0,src,tmp,numTasks);
-        tbbRadixIteration(3*BITS,1,tmp,src,numTasks);
+
+      /* LSB passes over all key bytes, ping-ponging between src and tmp */
+      Ty* in = src;
+      Ty* out = tmp;
+      for (size_t i=0; i<sizeof(Key); i++)
+      {
+        if (tbbRadixIteration(Key(i*BITS),in,out,numTasks))
+          std::swap(in,out);
       }
-      else if (sizeof(Key) == sizeof(uint64_t))
+
+      /* copy back if the sorted items ended up in the temporary array */
+      if (in != src)
       {
-        tbbRadixIteration(0*BITS,0,src,tmp,numTasks);
-        tbbRadixIteration(1*BITS,0,tmp,src,numTasks);
-        tbbRadixIteration(2*BITS,0,src,tmp,numTasks);
-        tbbRadixIteration(3*BITS,0,tmp,src,numTasks);
-        tbbRadixIteration(4*BITS,0,src,tmp,numTasks);
-        tbbRadixIteration(5*BITS,0,tmp,src,numTasks);
-        tbbRadixIteration(6*BITS,0,src,tmp,numTasks);
-        tbbRadixIteration(7*BITS,1,tmp,src,numTasks);
+        parallel_for(size_t(0), N, size_t(4096), [&] (const range<size_t>& r) {
+            for (size_t i=r.begin(); i<r.end(); i++) src[i] = tmp[i];
+          });
       }
     }
     
@@ -175,6 +175,58 @@ namespace embree
   void os_advise(void *ptr, size_t bytes)
   {
   }
+
+  void os_bind_node(void* ptr, size_t bytes, size_t node)
+  {
+  }
+
+  void* os_map_file(const char* fileName, size_t& bytes)
+  {
+    HANDLE file = CreateFileA(fileName,GENERIC_READ,FILE_SHARE_READ,nullptr,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file,&size) || size.QuadPart == 0) {
+      CloseHandle(file);
+      return nullptr;
+    }
+
+    /* the view keeps the file mapping alive, thus both handles can get closed */
+    HANDLE mapping = CreateFileMappingA(file,nullptr,PAGE_WRITECOPY,0,0,nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) return nullptr;
+    void* ptr = MapViewOfFile(mapping,FILE_MAP_COPY,0,0,0);
+    CloseHandle(mapping);
+    if (ptr == nullptr) return nullptr;
+
+    bytes = (size_t) size.QuadPart;
+    return ptr;
+  }
+
+  void os_unmap_file(void* ptr, size_t bytes)
+  {
+    if (ptr) UnmapViewOfFile(ptr);
+  }
+
+  void* os_map_temp_file(const char* dir, size_t bytes)
+  {
+    char fileName[MAX_PATH];
+    if (GetTempFileNameA(dir,"emb",0,fileName) == 0) throw std::bad_alloc();
+
+    /* the file gets deleted when the view got unmapped */
+    HANDLE file = CreateFileA(fileName,GENERIC_READ | GENERIC_WRITE,0,nullptr,CREATE_ALWAYS,FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE,nullptr);
+    if (file == INVALID_HANDLE_VALUE) throw std::bad_alloc();
+
+    ULARGE_INTEGER size;
+    size.QuadPart = bytes;
+    HANDLE mapping = CreateFileMappingA(file,nullptr,PAGE_READWRITE,size.HighPart,size.LowPart,nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) throw std::bad_alloc();
+    void* ptr = MapViewOfFile(mapping,FILE_MAP_ALL_ACCESS,0,0,bytes);
+    CloseHandle(mapping);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+  }
 }
 
 #endif
@@ -186,6 +238,9 @@ namespace embree
 #if defined(__UNIX__)
 
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
@@ -195,6 +250,10 @@ namespace embree
 #include <mach/vm_statistics.h>
 #endif
 
+#if defined(__LINUX__)
+#include <sys/syscall.h>
+#endif
+
 namespace embree
 {
   bool os_init(bool hugepages, bool verbose) 
@@ -314,6 +373,66 @@ namespace embree
     madvise(pptr,bytes,MADV_HUGEPAGE); 
 #endif
   }
+
+  void os_bind_node(void* pptr, size_t bytes, size_t node)
+  {
+#if defined(__LINUX__) && defined(SYS_mbind)
+    /* only complete pages can get bound */
+    const size_t begin = ((size_t)pptr+PAGE_SIZE_4K-1) & ~size_t(PAGE_SIZE_4K-1);
+    const size_t end = ((size_t)pptr+bytes) & ~size_t(PAGE_SIZE_4K-1);
+    if (begin >= end || node >= 8*sizeof(unsigned long)) return;
+
+    /* prefer the node, such that allocations still succeed when it runs out of memory */
+    const int MPOL_PREFERRED_ = 1;
+    const unsigned long nodemask = 1ul << node;
+    syscall(SYS_mbind,begin,end-begin,MPOL_PREFERRED_,&nodemask,8*sizeof(nodemask),0); // on purpose no error handling
+#endif
+  }
+
+  void* os_map_file(const char* fileName, size_t& bytes)
+  {
+    int fd = open(fileName,O_RDONLY);
+    if (fd == -1) return nullptr;
+
+    struct stat st;
+    if (fstat(fd,&st) == -1 || st.st_size == 0) {
+      close(fd);
+      return nullptr;
+    }
+
+    /* private mapping, thus pages get copied when written to */
+    void* ptr = mmap(0, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) return nullptr;
+
+    bytes = st.st_size;
+    return ptr;
+  }
+
+  void os_unmap_file(void* ptr, size_t bytes)
+  {
+    if (ptr) munmap(ptr,bytes);
+  }
+
+  void* os_map_temp_file(const char* dir, size_t bytes)
+  {
+    std::string fileName = std::string(dir) + "/embreeXXXXXX";
+    int fd = mkstemp(&fileName[0]);
+    if (fd == -1) throw std::bad_alloc();
+
+    /* the file gets deleted when the mapping got unmapped */
+    unlink(fileName.c_str());
+    if (ftruncate(fd,bytes) == -1) {
+      close(fd);
+      throw std::bad_alloc();
+    }
+
+    /* shared mapping, thus the OS writes pages back to the file instead of swap */
+    void* ptr = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) throw std::bad_alloc();
+    return ptr;
+  }
 }
 
 #endif
@@ -74,6 +74,16 @@ namespace embree
   void  os_free   (void* ptr, size_t bytes, bool hugepages);
   void  os_advise (void* ptr, size_t bytes);
 
+  /*! binds pages to a NUMA node, pages not touched yet get allocated from that node if possible */
+  void  os_bind_node (void* ptr, size_t bytes, size_t node);
+
+  /*! maps a file copy-on-write into memory, returns nullptr on failure */
+  void* os_map_file (const char* fileName, size_t& bytes);
+  void  os_unmap_file (void* ptr, size_t bytes);
+
+  /*! maps a temporary file created in some directory into memory, thus the OS can page it out, free with os_unmap_file */
+  void* os_map_temp_file (const char* dir, size_t bytes);
+
   /*! allocator that performs OS allocations */
   template<typename T>
     struct os_allocator
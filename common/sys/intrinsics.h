@@ -155,6 +155,17 @@ namespace embree
     return 31 - bsr(x);    
 #endif
   }
+
+  __forceinline int lzcnt(const uint64_t x)
+  {
+#if defined(__AVX2__) && defined(__X86_64__)
+    return int(_lzcnt_u64(x));
+#else
+    const int hi = int(x >> 32);
+    if (hi != 0) return lzcnt(hi);
+    return 32 + lzcnt(int(x));
+#endif
+  }
   
   __forceinline int btc(int v, int i) {
     long r = v; _bittestandcomplement(&r,i); return r;
@@ -326,6 +337,17 @@ namespace embree
 #endif
   }
 
+  __forceinline int lzcnt(const uint64_t x)
+  {
+#if defined(__AVX2__) && defined(__X86_64__)
+    return int(_lzcnt_u64(x));
+#else
+    const int hi = int(x >> 32);
+    if (hi != 0) return lzcnt(hi);
+    return 32 + lzcnt(int(x));
+#endif
+  }
+
   __forceinline size_t blsr(size_t v) {
 #if defined(__AVX2__) 
 #if defined(__INTEL_COMPILER)
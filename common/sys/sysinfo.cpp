@@ -432,6 +432,7 @@ namespace embree
 
 #include <stdio.h>
 #include <unistd.h>
+#include <sched.h>
 
 namespace embree
 {
@@ -445,6 +446,55 @@ namespace embree
     return std::string(buf);
   }
 
+  /* NUMA node of each logical thread, parsed from the sysfs node directories */
+  struct NumaTopology
+  {
+    NumaTopology () : numNodes(0)
+    {
+      for (size_t node=0;;node++)
+      {
+        std::ifstream file("/sys/devices/system/node/node" + toString(node) + "/cpulist");
+        if (!file.is_open()) break;
+        numNodes++;
+
+        /* the list consists of comma separated thread IDs and ranges of thread IDs */
+        size_t begin, end;
+        while (file >> begin)
+        {
+          end = begin;
+          if (file.peek() == '-') { file.ignore(); file >> end; }
+          if (nodeOfThread.size() <= end) nodeOfThread.resize(end+1,0);
+          for (size_t i=begin; i<=end; i++) nodeOfThread[i] = node;
+          if (file.peek() == ',') file.ignore();
+        }
+      }
+      numNodes = max(numNodes,size_t(1));
+    }
+
+    static const NumaTopology& get() {
+      static NumaTopology topology;
+      return topology;
+    }
+
+  public:
+    size_t numNodes;
+    std::vector<size_t> nodeOfThread;
+  };
+
+  size_t getNumberOfNumaNodes() {
+    return NumaTopology::get().numNodes;
+  }
+
+  size_t getNumaNodeOfLogicalThread(size_t threadID)
+  {
+    const NumaTopology& topology = NumaTopology::get();
+    return threadID < topology.nodeOfThread.size() ? topology.nodeOfThread[threadID] : 0;
+  }
+
+  ssize_t getCurrentLogicalThread() {
+    return sched_getcpu();
+  }
+
   size_t getVirtualMemoryBytes()
   {
     size_t virt, resident, shared;
@@ -464,6 +514,29 @@ namespace embree
 
 #endif
 
+////////////////////////////////////////////////////////////////////////////////
+/// Platforms without NUMA support
+////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(__LINUX__)
+
+namespace embree
+{
+  size_t getNumberOfNumaNodes() {
+    return 1;
+  }
+
+  size_t getNumaNodeOfLogicalThread(size_t threadID) {
+    return 0;
+  }
+
+  ssize_t getCurrentLogicalThread() {
+    return -1;
+  }
+}
+
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 /// FreeBSD Platform
 ////////////////////////////////////////////////////////////////////////////////
@@ -164,6 +164,15 @@ namespace embree
 
   /*! return the number of logical threads of the system */
   unsigned int getNumberOfLogicalThreads();
+
+  /*! return the number of NUMA nodes of the system */
+  size_t getNumberOfNumaNodes();
+
+  /*! return the NUMA node some logical thread belongs to */
+  size_t getNumaNodeOfLogicalThread(size_t threadID);
+
+  /*! return the logical thread the calling thread currently runs on, or -1 if unknown */
+  ssize_t getCurrentLogicalThread();
   
   /*! returns the size of the terminal window in characters */
   int getTerminalWidth();
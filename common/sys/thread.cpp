@@ -178,7 +178,7 @@ namespace embree
   static MutexSys mutex;
   static std::vector<size_t> threadIDs;
   
-  /* changes thread ID mapping such that we first fill up all thread on one core */
+  /* changes thread ID mapping such that we first fill up all thread on one core, and all cores of one NUMA node */
   size_t mapThreadID(size_t threadID)
   {
     Lock<MutexSys> lock(mutex);
@@ -204,6 +204,11 @@ namespace embree
         fs.close();
       }
 
+      /* fill up one NUMA node after the other */
+      std::stable_sort(threadIDs.begin(),threadIDs.end(),[] (size_t a, size_t b) {
+          return getNumaNodeOfLogicalThread(a) < getNumaNodeOfLogicalThread(b);
+        });
+
 #if 0
       for (size_t i=0;i<threadIDs.size();i++)
         std::cout << i << " -> " << threadIDs[i] << std::endl;
@@ -20,6 +20,8 @@
 #include <sys/types.h>
 #include <stdbool.h>
 
+#include "rtcore_config.h"
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -68,9 +70,6 @@ typedef int ssize_t;
 /* Maximum number of time steps */
 #define RTC_MAX_TIME_STEP_COUNT 129
 
-/* Maximum number of instancing levels */
-#define RTC_MAX_INSTANCE_LEVEL_COUNT 1
-
 /* Formats of buffers and other data structures */
 enum RTCFormat
 {
@@ -218,7 +217,10 @@ struct RTCIntersectContext
 {
   enum RTCIntersectContextFlags flags;               // intersection flags
   RTCFilterFunctionN filter;                         // filter function to execute
-  unsigned int instID[RTC_MAX_INSTANCE_LEVEL_COUNT]; // will be set to geomID of instance when instance is entered
+#if RTC_MAX_INSTANCE_LEVEL_COUNT > 1
+  unsigned int instStackSize;                        // number of instances currently entered
+#endif
+  unsigned int instID[RTC_MAX_INSTANCE_LEVEL_COUNT]; // stack of geomIDs of the currently entered instances
 };
 
 /* Initializes an intersection context. */
@@ -226,7 +228,11 @@ RTC_FORCEINLINE void rtcInitIntersectContext(struct RTCIntersectContext* context
 {
   context->flags = RTC_INTERSECT_CONTEXT_FLAG_INCOHERENT;
   context->filter = NULL;
-  context->instID[0] = RTC_INVALID_GEOMETRY_ID;
+#if RTC_MAX_INSTANCE_LEVEL_COUNT > 1
+  context->instStackSize = 0;
+#endif
+  for (unsigned int l = 0; l < RTC_MAX_INSTANCE_LEVEL_COUNT; l++)
+    context->instID[l] = RTC_INVALID_GEOMETRY_ID;
 }
   
 #if defined(__cplusplus)
@@ -59,7 +59,23 @@ enum RTCDeviceProperty
   RTC_DEVICE_PROPERTY_USER_GEOMETRY_SUPPORTED        = 100,
 
   RTC_DEVICE_PROPERTY_TASKING_SYSTEM        = 128,
-  RTC_DEVICE_PROPERTY_JOIN_COMMIT_SUPPORTED = 129
+  RTC_DEVICE_PROPERTY_JOIN_COMMIT_SUPPORTED = 129,
+
+  RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_SIZE      = 160,
+  RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_HITS      = 161,
+  RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_MISSES    = 162,
+  RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_EVICTIONS = 163,
+
+  RTC_DEVICE_PROPERTY_BUILD_PRIMITIVES_TIME = 192,
+  RTC_DEVICE_PROPERTY_BUILD_SORT_TIME       = 193,
+  RTC_DEVICE_PROPERTY_BUILD_HIERARCHY_TIME  = 194,
+  RTC_DEVICE_PROPERTY_BUILD_TOPLEVEL_TIME   = 195,
+  RTC_DEVICE_PROPERTY_BUILD_TOPLEVEL_NODES  = 196,
+
+  RTC_DEVICE_PROPERTY_BLOCK_POOL_SIZE   = 224,
+  RTC_DEVICE_PROPERTY_BLOCK_POOL_BYTES  = 225,
+  RTC_DEVICE_PROPERTY_BLOCK_POOL_HITS   = 226,
+  RTC_DEVICE_PROPERTY_BLOCK_POOL_MISSES = 227
 };
 
 /* Gets a device property. */
@@ -36,7 +36,9 @@ enum RTCSceneFlags
   RTC_SCENE_FLAG_DYNAMIC                 = (1 << 0),
   RTC_SCENE_FLAG_COMPACT                 = (1 << 1),
   RTC_SCENE_FLAG_ROBUST                  = (1 << 2),
-  RTC_SCENE_FLAG_CONTEXT_FILTER_FUNCTION = (1 << 3)
+  RTC_SCENE_FLAG_CONTEXT_FILTER_FUNCTION = (1 << 3),
+  RTC_SCENE_FLAG_COMPRESSED              = (1 << 4),
+  RTC_SCENE_FLAG_STATISTICS              = (1 << 5)
 };
 
 /* Creates a new scene. */
@@ -68,6 +70,21 @@ RTC_API void rtcCommitScene(RTCScene scene);
 /* Commits the scene from multiple threads. */
 RTC_API void rtcJoinCommitScene(RTCScene scene);
 
+/* Asynchronous scene commit completion callback function */
+typedef void (*RTCCommitSceneFunction)(void* userPtr, RTCScene scene, enum RTCError error);
+
+/* Commits the scene in the background while ray queries keep using the last commit. */
+RTC_API void rtcCommitSceneAsync(RTCScene scene, RTCCommitSceneFunction complete, void* userPtr);
+
+/* Returns true if no asynchronous commit of the scene is running. */
+RTC_API bool rtcIsSceneCommitDone(RTCScene scene);
+
+/* Writes the acceleration structures of a committed scene to a BVH file. */
+RTC_API void rtcSaveSceneBVH(RTCScene scene, const char* fileName);
+
+/* Commits the scene by memory mapping its acceleration structures from a BVH file instead of building them. */
+RTC_API void rtcLoadSceneBVH(RTCScene scene, const char* fileName);
+
 
 /* Progress monitor callback function */
 typedef bool (*RTCProgressMonitorFunction)(void* ptr, double n);
@@ -84,12 +101,96 @@ RTC_API void rtcSetSceneFlags(RTCScene scene, enum RTCSceneFlags flags);
 /* Returns the scene flags. */
 RTC_API enum RTCSceneFlags rtcGetSceneFlags(RTCScene scene);
 
+/* Sets the memory budget for building the scene, 0 disables the budget. */
+RTC_API void rtcSetSceneMemoryBudget(RTCScene scene, size_t bytes);
+
 /* Returns the axis-aligned bounds of the scene. */
 RTC_API void rtcGetSceneBounds(RTCScene scene, struct RTCBounds* bounds_o);
 
 /* Returns the linear axis-aligned bounds of the scene. */
 RTC_API void rtcGetSceneLinearBounds(RTCScene scene, struct RTCLinearBounds* bounds_o);
 
+/* Point query structure for closest point queries */
+struct RTC_ALIGN(16) RTCPointQuery
+{
+  float x;      // x coordinate of the query point
+  float y;      // y coordinate of the query point
+  float z;      // z coordinate of the query point
+  float time;   // time of the point query
+  float radius; // radius of the point query, may be reduced by the query function
+};
+
+/* Arguments for RTCPointQueryFunction */
+struct RTCPointQueryFunctionArguments
+{
+  struct RTCPointQuery* query;                       // point query in world space
+  void* userPtr;                                     // user pointer passed to rtcPointQuery
+  unsigned int primID;                               // primitive ID of the primitive in the query domain
+  unsigned int geomID;                               // geometry ID of the primitive in the query domain
+  unsigned int instID[RTC_MAX_INSTANCE_LEVEL_COUNT]; // instance ID stack of the primitive
+  float inst2world[16];                              // instance to world transformation (column-major 4x4)
+};
+
+/* Point query callback function, returns true if the query radius got reduced */
+typedef bool (*RTCPointQueryFunction)(struct RTCPointQueryFunctionArguments* args);
+
+/* Result of a closest point query */
+struct RTC_ALIGN(16) RTCClosestPoint
+{
+  float x;                                           // x coordinate of the closest point
+  float y;                                           // y coordinate of the closest point
+  float z;                                           // z coordinate of the closest point
+  float u;                                           // barycentric u coordinate of the closest point
+  float v;                                           // barycentric v coordinate of the closest point
+  unsigned int primID;                               // primitive ID
+  unsigned int geomID;                               // geometry ID
+  unsigned int instID[RTC_MAX_INSTANCE_LEVEL_COUNT]; // instance ID stack
+};
+
+/* Calls the query function for all primitives within the query radius, returns true if the radius got reduced. */
+RTC_API bool rtcPointQuery(RTCScene scene, struct RTCPointQuery* query, RTCPointQueryFunction queryFunc, void* userPtr);
+
+/* Finds the closest point on the triangles and quads of the scene within the query radius. */
+RTC_API bool rtcClosestPoint(RTCScene scene, struct RTCPointQuery* query, struct RTCClosestPoint* result);
+
+/* Pair of primitives with overlapping bounds reported by rtcCollide */
+struct RTCCollision
+{
+  unsigned int geomID0;                              // geometry ID of the primitive of the first scene
+  unsigned int primID0;                              // primitive ID of the primitive of the first scene
+  unsigned int geomID1;                              // geometry ID of the primitive of the second scene
+  unsigned int primID1;                              // primitive ID of the primitive of the second scene
+};
+
+/* Collision callback, may get invoked concurrently from multiple threads */
+typedef void (*RTCCollideFunc)(void* userPtr, struct RTCCollision* collisions, unsigned int num_collisions);
+
+/* Reports all pairs of primitives of two scenes with overlapping bounds. */
+RTC_API void rtcCollide(RTCScene scene0, RTCScene scene1, RTCCollideFunc callback, void* userPtr);
+
+/* Traversal statistics of one type of ray query */
+struct RTCTraversalStatistics
+{
+  size_t rays;                                       // number of rays traced
+  size_t nodes;                                      // number of BVH node traversal steps
+  size_t leaves;                                     // number of BVH leaves visited
+  size_t primitives;                                 // number of primitive intersection tests
+  size_t filters;                                    // number of filter function invocations
+};
+
+/* Traversal statistics of a scene, gathered with RTC_SCENE_FLAG_STATISTICS */
+struct RTCSceneStatistics
+{
+  struct RTCTraversalStatistics intersect;           // statistics of rtcIntersect queries
+  struct RTCTraversalStatistics occluded;            // statistics of rtcOccluded queries
+};
+
+/* Returns the traversal statistics gathered since the last reset. */
+RTC_API void rtcGetSceneStatistics(RTCScene scene, struct RTCSceneStatistics* statistics);
+
+/* Resets the traversal statistics of the scene. */
+RTC_API void rtcResetSceneStatistics(RTCScene scene);
+
 /* Intersects a single ray with the scene. */
 RTC_API void rtcIntersect1(RTCScene scene, struct RTCIntersectContext* context, struct RTCRayHit* rayhit);
 
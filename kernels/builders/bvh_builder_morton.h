@@ -56,19 +56,24 @@ namespace embree
         size_t singleThreadThreshold; //!< threshold when we switch to single threaded build
       };
 
-      /*! Build primitive consisting of morton code and primitive ID. */
+      /*! time spent in the individual phases of the build */
+      struct Timings
+      {
+        Timings () : sort(0.0), hierarchy(0.0) {}
+
+      public:
+        double sort;        //!< time to sort the morton codes
+        double hierarchy;   //!< time to build the hierarchy
+      };
+
+      /*! Build primitive consisting of 63 bit morton code and primitive ID. */
       struct __aligned(8) BuildPrim
       {
-        union {
-          struct {
-            unsigned int code;     //!< morton code
-            unsigned int index;    //!< i'th primitive
-          };
-          uint64_t t;
-        };
+        uint64_t code;         //!< morton code
+        unsigned int index;    //!< i'th primitive
 
         /*! interface for radix sort */
-        __forceinline operator unsigned() const { return code; }
+        __forceinline operator uint64_t() const { return code; }
 
         /*! interface for standard sort */
         __forceinline bool operator<(const BuildPrim &m) const { return code < m.code; }
@@ -77,7 +82,7 @@ namespace embree
       /*! maps bounding box to morton code */
       struct MortonCodeMapping
       {
-        static const size_t LATTICE_BITS_PER_DIM = 10;
+        static const size_t LATTICE_BITS_PER_DIM = 21;
         static const size_t LATTICE_SIZE_PER_DIM = size_t(1) << LATTICE_BITS_PER_DIM;
 
         vfloat4 base;
@@ -98,20 +103,21 @@ namespace embree
           return vint4((centroid-base)*scale);
         }
 
-        __forceinline unsigned int code (const BBox3fa& box) const
+        __forceinline uint64_t code (const BBox3fa& box) const
         {
           const vint4 binID = bin(box);
-          const unsigned int x = extract<0>(binID);
-          const unsigned int y = extract<1>(binID);
-          const unsigned int z = extract<2>(binID);
-          const unsigned int xyz = bitInterleave(x,y,z);
-          return xyz;
+          const uint64_t x = (unsigned int) extract<0>(binID);
+          const uint64_t y = (unsigned int) extract<1>(binID);
+          const uint64_t z = (unsigned int) extract<2>(binID);
+#if defined(__AVX2__) && defined(__X86_64__)
+          return pdep(size_t(x),size_t(0x1249249249249249ull)) | pdep(size_t(y),size_t(0x2492492492492492ull)) | pdep(size_t(z),size_t(0x4924924924924924ull));
+#else
+          return bitInterleave64(x,y,z);
+#endif
         }
       };
 
-#if defined (__AVX2__)
-
-      /*! for AVX2 there is a fast scalar bitInterleave */
+      /*! stores the morton code of each primitive */
       struct MortonCodeGenerator
       {
         __forceinline MortonCodeGenerator(const MortonCodeMapping& mapping, BuildPrim* dest)
@@ -127,58 +133,8 @@ namespace embree
       public:
         const MortonCodeMapping mapping;
         BuildPrim* dest;
-        size_t currentID;
       };
 
-#else
-
-      /*! before AVX2 is it better to use the SSE version of bitInterleave */
-      struct MortonCodeGenerator
-      {
-        __forceinline MortonCodeGenerator(const MortonCodeMapping& mapping, BuildPrim* dest)
-          : mapping(mapping), dest(dest), currentID(0), slots(0), ax(0), ay(0), az(0), ai(0) {}
-
-        __forceinline ~MortonCodeGenerator()
-        {
-          if (slots != 0)
-          {
-            const vint4 code = bitInterleave(ax,ay,az);
-            for (size_t i=0; i<slots; i++) {
-              dest[currentID-slots+i].index = ai[i];
-              dest[currentID-slots+i].code = code[i];
-            }
-          }
-        }
-
-        __forceinline void operator() (const BBox3fa& b, const unsigned index)
-        {
-          const vint4 binID = mapping.bin(b);
-          ax[slots] = extract<0>(binID);
-          ay[slots] = extract<1>(binID);
-          az[slots] = extract<2>(binID);
-          ai[slots] = index;
-          slots++;
-          currentID++;
-
-          if (slots == 4)
-          {
-            const vint4 code = bitInterleave(ax,ay,az);
-            vint4::storeu(&dest[currentID-4],unpacklo(code,ai));
-            vint4::storeu(&dest[currentID-2],unpackhi(code,ai));
-            slots = 0;
-          }
-        }
-
-      public:
-        const MortonCodeMapping mapping;
-        BuildPrim* dest;
-        size_t currentID;
-        size_t slots;
-        vint4 ax, ay, az, ai;
-      };
-
-#endif
-
       template<
         typename ReductionTy,
         typename Allocator,
@@ -308,45 +264,43 @@ namespace embree
               });
 
             /*! sort morton codes */
-#if defined(TASKING_TBB)
-            tbb::parallel_sort(morton+current.begin(),morton+current.end());
-#else
-            radixsort32(morton+current.begin(),current.size());
-#endif
+            BuildPrim* tmp = (BuildPrim*) alignedMalloc(current.size()*sizeof(BuildPrim),64);
+            radix_sort_u64(morton+current.begin(),tmp,current.size(),singleThreadThreshold);
+            alignedFree(tmp);
           }
         }
 
         __forceinline void split(const range<unsigned>& current, range<unsigned>& left, range<unsigned>& right) const
         {
-          const unsigned int code_start = morton[current.begin()].code;
-          const unsigned int code_end   = morton[current.end()-1].code;
-          unsigned int bitpos = lzcnt(code_start^code_end);
+          const uint64_t code_start = morton[current.begin()].code;
+          const uint64_t code_end   = morton[current.end()-1].code;
+          size_t bitpos = lzcnt(code_start^code_end);
 
           /* if all items mapped to same morton code, then re-create new morton codes for the items */
-          if (unlikely(bitpos == 32))
+          if (unlikely(bitpos == 64))
           {
             recreateMortonCodes(current);
-            const unsigned int code_start = morton[current.begin()].code;
-            const unsigned int code_end   = morton[current.end()-1].code;
+            const uint64_t code_start = morton[current.begin()].code;
+            const uint64_t code_end   = morton[current.end()-1].code;
             bitpos = lzcnt(code_start^code_end);
 
             /* if the morton code is still the same, goto fall back split */
-            if (unlikely(bitpos == 32)) {
+            if (unlikely(bitpos == 64)) {
               current.split(left,right);
               return;
             }
           }
 
           /* split the items at the topmost different morton code bit */
-          const unsigned int bitpos_diff = 31-bitpos;
-          const unsigned int bitmask = 1 << bitpos_diff;
+          const size_t bitpos_diff = 63-bitpos;
+          const uint64_t bitmask = uint64_t(1) << bitpos_diff;
 
           /* find location where bit differs using binary search */
           unsigned begin = current.begin();
           unsigned end   = current.end();
           while (begin + 1 != end) {
             const unsigned mid = (begin+end)/2;
-            const unsigned bit = morton[mid].code & bitmask;
+            const uint64_t bit = morton[mid].code & bitmask;
             if (bit == 0) begin = mid; else end = mid;
           }
           unsigned center = end;
@@ -439,15 +393,22 @@ namespace embree
         }
 
         /* build function */
-        ReductionTy build(BuildPrim* src, BuildPrim* tmp, size_t numPrimitives)
+        ReductionTy build(BuildPrim* src, BuildPrim* tmp, size_t numPrimitives, Timings* timings)
         {
           /* sort morton codes */
+          double t0 = timings ? getSeconds() : 0.0;
           morton = src;
-          radix_sort_u32(src,tmp,numPrimitives,singleThreadThreshold);
+          radix_sort_u64(src,tmp,numPrimitives,singleThreadThreshold);
+          double t1 = timings ? getSeconds() : 0.0;
 
           /* build BVH */
           const ReductionTy root = recurse(1, range<unsigned>(0,(unsigned)numPrimitives), nullptr, true);
           _mm_mfence(); // to allow non-temporal stores during build
+
+          if (timings) {
+            timings->sort = t1-t0;
+            timings->hierarchy = getSeconds()-t1;
+          }
           return root;
         }
 
@@ -482,7 +443,8 @@ namespace embree
                                  BuildPrim* src,
                                  BuildPrim* tmp,
                                  size_t numPrimitives,
-                                 const Settings& settings)
+                                 const Settings& settings,
+                                 Timings* timings = nullptr)
         {
           typedef BuilderT<
             ReductionTy,
@@ -502,7 +464,7 @@ namespace embree
                           progressMonitor,
                           settings);
 
-          return builder.build(src,tmp,numPrimitives);
+          return builder.build(src,tmp,numPrimitives,timings);
         }
     };
   }
@@ -0,0 +1,493 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "bvh_builder_morton.h"
+#include "priminfo.h"
+#include "../../common/algorithms/parallel_prefix_sum.h"
+
+namespace embree
+{
+  namespace isa
+  {
+    /*! Parallel locally-ordered clustering (PLOC) builder. The
+     *  primitives get sorted along a Morton curve and are then
+     *  iteratively merged with their nearest neighbor inside a small
+     *  window of that order, which builds a binary tree bottom
+     *  up. The binary tree is finally collapsed into a wide BVH using
+     *  the SAH to decide where to place leaves. */
+    struct BVHBuilderPLOC
+    {
+      static const size_t MAX_BRANCHING_FACTOR = 8;          //!< maximum supported BVH branching factor
+      static const size_t MIN_LARGE_LEAF_LEVELS = 8;         //!< create balanced tree if we are that many levels before the maximum tree depth
+
+      /*! settings for PLOC builder */
+      struct Settings
+      {
+        /*! default settings */
+        Settings ()
+        : branchingFactor(2), maxDepth(32), searchRadius(16), logBlockSize(0), maxLeafSize(8), travCost(1.0f), intCost(1.0f), singleThreadThreshold(1024) {}
+
+        Settings (size_t branchingFactor, size_t maxDepth, size_t searchRadius, size_t sahBlockSize, size_t maxLeafSize, float travCost, float intCost, size_t singleThreadThreshold)
+        : branchingFactor(branchingFactor), maxDepth(maxDepth), searchRadius(searchRadius), logBlockSize(bsr(sahBlockSize)), maxLeafSize(maxLeafSize),
+          travCost(travCost), intCost(intCost), singleThreadThreshold(singleThreadThreshold) {}
+
+      public:
+        size_t branchingFactor;  //!< branching factor of BVH to build
+        size_t maxDepth;         //!< maximum depth of BVH to build
+        size_t searchRadius;     //!< number of clusters searched to each side for the nearest neighbor
+        size_t logBlockSize;     //!< log2 of blocksize for SAH heuristic
+        size_t maxLeafSize;      //!< maximum size of a leaf
+        float travCost;          //!< estimated cost of one traversal step
+        float intCost;           //!< estimated cost of one primitive intersection
+        size_t singleThreadThreshold; //!< threshold when we switch to single threaded build
+      };
+
+      /*! node of the temporary binary cluster tree */
+      struct __aligned(16) Cluster
+      {
+        static const unsigned int LEAF_FLAG = 0x80000000;  //!< marks clusters that become leaves of the final BVH
+        static const unsigned int INVALID = 0xFFFFFFFF;
+
+        __forceinline size_t size() const { return num & ~LEAF_FLAG; }
+        __forceinline bool isLeaf() const { return num & LEAF_FLAG; }
+        __forceinline bool isPrimitive() const { return right == INVALID; }
+
+      public:
+        BBox3fa bounds;        //!< bounds of all primitives of the cluster
+        unsigned int left;     //!< left child, or index into the Morton ordered primitives for single primitive clusters
+        unsigned int right;    //!< right child, or INVALID for single primitive clusters
+        unsigned int num;      //!< number of primitives and leaf flag
+        float cost;            //!< SAH cost of the cluster
+      };
+
+      template<
+        typename NodeRef,
+        typename CreateAllocFunc,
+        typename CreateNodeFunc,
+        typename SetNodeFunc,
+        typename CreateLeafFunc,
+        typename ProgressMonitor>
+
+        class BuilderT : private Settings
+      {
+        typedef decltype(std::declval<CreateAllocFunc>()()) Allocator;
+
+      public:
+
+        BuilderT (CreateAllocFunc& createAllocator,
+                  CreateNodeFunc& createNode,
+                  SetNodeFunc& setNode,
+                  CreateLeafFunc& createLeaf,
+                  ProgressMonitor& progressMonitor,
+                  const Settings& settings)
+
+          : Settings(settings),
+          createAllocator(createAllocator),
+          createNode(createNode),
+          setNode(setNode),
+          createLeaf(createLeaf),
+          progressMonitor(progressMonitor),
+          prims(nullptr), sortedPrims(nullptr) {}
+
+        __forceinline float leafCost(size_t num, const BBox3fa& bounds) const {
+          return intCost*float((num+(size_t(1)<<logBlockSize)-1) >> logBlockSize)*halfArea(bounds);
+        }
+
+        /*! merges two clusters and decides whether the result should become a leaf */
+        __forceinline void makeCluster(Cluster& dst, unsigned int left, unsigned int right) const
+        {
+          const Cluster& l = clusters[left];
+          const Cluster& r = clusters[right];
+          dst.bounds = embree::merge(l.bounds,r.bounds);
+          dst.left = left;
+          dst.right = right;
+          const size_t num = l.size()+r.size();
+          const float splitCost = travCost*halfArea(dst.bounds) + l.cost + r.cost;
+          dst.cost = splitCost;
+          dst.num = (unsigned int) num;
+          if (num <= maxLeafSize) {
+            const float lcost = leafCost(num,dst.bounds);
+            if (lcost <= splitCost) {
+              dst.cost = lcost;
+              dst.num |= Cluster::LEAF_FLAG;
+            }
+          }
+        }
+
+        /*! finds for each cluster the closest cluster inside the search window */
+        void findNearestNeighbors(size_t numClusters)
+        {
+          const ssize_t radius = searchRadius;
+          parallel_for(size_t(0), numClusters, size_t(1024), [&] (const range<size_t>& r)
+          {
+            for (size_t i=r.begin(); i<r.end(); i++)
+            {
+              const ssize_t j0 = max(ssize_t(i)-radius,ssize_t(0));
+              const ssize_t j1 = min(ssize_t(i)+radius+1,ssize_t(numClusters));
+              const BBox3fa bi = clusterBounds[i];
+              float bestArea = pos_inf;
+              ssize_t best = ssize_t(i) == j0 ? j0+1 : j0;
+
+              /* ties are resolved towards the lowest index, thus the pair
+               * with the smallest merged area is always mutual neighbors,
+               * which guarantees progress */
+              for (ssize_t j=j0; j<j1; j++)
+              {
+                if (j == ssize_t(i)) continue;
+                const float area = halfArea(embree::merge(bi,clusterBounds[j]));
+                if (area < bestArea) { bestArea = area; best = j; }
+              }
+              neighbor[i] = (unsigned int) best;
+            }
+          });
+        }
+
+        /*! merges mutual nearest neighbors and compacts the cluster list */
+        size_t mergeClusters(size_t numClusters)
+        {
+          auto survives = [&] (size_t i) -> bool {
+            const size_t j = neighbor[i];
+            return neighbor[j] != i || i < j;
+          };
+
+          ParallelPrefixSumState<size_t> pstate;
+          parallel_prefix_sum( pstate, size_t(0), numClusters, size_t(1024), size_t(0), [&](const range<size_t>& r, const size_t base) -> size_t {
+              size_t num = 0;
+              for (size_t i=r.begin(); i<r.end(); i++)
+                num += survives(i);
+              return num;
+            }, std::plus<size_t>());
+
+          return parallel_prefix_sum( pstate, size_t(0), numClusters, size_t(1024), size_t(0), [&](const range<size_t>& r, const size_t base) -> size_t {
+              size_t num = 0;
+              for (size_t i=r.begin(); i<r.end(); i++)
+              {
+                if (!survives(i)) continue;
+                const size_t j = neighbor[i];
+                if (neighbor[j] == i)
+                {
+                  const unsigned int id = nextCluster++;
+                  makeCluster(clusters[id],clusterIDs[i],clusterIDs[j]);
+                  nextClusterIDs[base+num] = id;
+                  nextClusterBounds[base+num] = clusters[id].bounds;
+                }
+                else
+                {
+                  nextClusterIDs[base+num] = clusterIDs[i];
+                  nextClusterBounds[base+num] = clusterBounds[i];
+                }
+                num++;
+              }
+              return num;
+            }, std::plus<size_t>());
+        }
+
+        /*! writes the primitives of a cluster in tree order back to the primitive array */
+        void gatherPrimitives(unsigned int root, size_t begin) const
+        {
+          typedef std::pair<unsigned int,size_t> StackItem;
+
+          /* each stack item is a disjoint subtree, thus the stack never
+           * holds more items than the cluster has primitives */
+          const size_t num = clusters[root].size();
+          StackItem stack_local[64];
+          std::vector<StackItem> stack_heap;
+          StackItem* stack = stack_local;
+          if (num > 64) {
+            stack_heap.resize(num);
+            stack = stack_heap.data();
+          }
+
+          size_t sp = 0;
+          stack[sp++] = StackItem(root,begin);
+          while (sp)
+          {
+            const StackItem item = stack[--sp];
+            const Cluster& c = clusters[item.first];
+            if (c.isPrimitive()) {
+              prims[item.second] = sortedPrims[c.left];
+              continue;
+            }
+            stack[sp++] = StackItem(c.right,item.second+clusters[c.left].size());
+            stack[sp++] = StackItem(c.left,item.second);
+          }
+        }
+
+        /*! creates a balanced tree for clusters too deep in the hierarchy */
+        NodeRef createLargeLeaf(size_t depth, const range<size_t>& current, Allocator alloc)
+        {
+          /* this should never occur but is a fatal error */
+          if (depth > maxDepth)
+            throw_RTCError(RTC_ERROR_UNKNOWN,"depth limit reached");
+
+          /* create leaf for few primitives */
+          if (current.size() <= maxLeafSize)
+            return createLeaf(prims,current,alloc);
+
+          /* fill all children by always splitting the largest one */
+          range<size_t> children[MAX_BRANCHING_FACTOR];
+          size_t numChildren = 1;
+          children[0] = current;
+
+          do {
+            size_t bestChild = -1;
+            size_t bestSize = 0;
+            for (size_t i=0; i<numChildren; i++)
+            {
+              if (children[i].size() <= maxLeafSize)
+                continue;
+
+              if (children[i].size() > bestSize) {
+                bestSize = children[i].size();
+                bestChild = i;
+              }
+            }
+            if (bestChild == size_t(-1)) break;
+
+            auto split = children[bestChild].split();
+            children[bestChild] = children[numChildren-1];
+            children[numChildren-1] = split.first;
+            children[numChildren+0] = split.second;
+            numChildren++;
+
+          } while (numChildren < branchingFactor);
+
+          NodeRef node = createNode(alloc,numChildren);
+          for (size_t i=0; i<numChildren; i++)
+          {
+            BBox3fa bounds = empty;
+            for (size_t j=children[i].begin(); j<children[i].end(); j++)
+              bounds.extend(prims[j].bounds());
+            setNode(node,i,createLargeLeaf(depth+1,children[i],alloc),bounds);
+          }
+          return node;
+        }
+
+        NodeRef recurse(size_t depth, unsigned int id, size_t begin, Allocator alloc, bool toplevel)
+        {
+          /* get thread local allocator */
+          if (!alloc)
+            alloc = createAllocator();
+
+          const Cluster& cluster = clusters[id];
+          const range<size_t> current(begin,begin+cluster.size());
+
+          /* call memory monitor function to signal progress */
+          if (toplevel && current.size() <= singleThreadThreshold)
+            progressMonitor(current.size());
+
+          /* create leaf node */
+          if (cluster.isPrimitive() || cluster.isLeaf()) {
+            gatherPrimitives(id,begin);
+            return createLeaf(prims,current,alloc);
+          }
+
+          /* switch to balanced tree when approaching the depth limit */
+          if (unlikely(depth+MIN_LARGE_LEAF_LEVELS >= maxDepth)) {
+            gatherPrimitives(id,begin);
+            return createLargeLeaf(depth,current,alloc);
+          }
+
+          /* open the child with the largest surface area until the node is full */
+          unsigned int children[MAX_BRANCHING_FACTOR];
+          size_t childBegin[MAX_BRANCHING_FACTOR];
+          children[0] = cluster.left;  childBegin[0] = begin;
+          children[1] = cluster.right; childBegin[1] = begin+clusters[cluster.left].size();
+          size_t numChildren = 2;
+
+          while (numChildren < branchingFactor)
+          {
+            ssize_t bestChild = -1;
+            float bestArea = neg_inf;
+            for (size_t i=0; i<numChildren; i++)
+            {
+              const Cluster& c = clusters[children[i]];
+              if (c.isPrimitive() || c.isLeaf())
+                continue;
+
+              const float area = halfArea(c.bounds);
+              if (area > bestArea) {
+                bestArea = area;
+                bestChild = i;
+              }
+            }
+            if (bestChild == -1) break;
+
+            const Cluster& c = clusters[children[bestChild]];
+            const size_t b = childBegin[bestChild];
+            children[bestChild] = c.left;
+            childBegin[bestChild] = b;
+            children[numChildren] = c.right;
+            childBegin[numChildren] = b+clusters[c.left].size();
+            numChildren++;
+          }
+
+          /* allocate node */
+          NodeRef node = createNode(alloc,numChildren);
+
+          /* process top parts of tree parallel */
+          NodeRef refs[MAX_BRANCHING_FACTOR];
+          if (current.size() > singleThreadThreshold)
+          {
+            parallel_for(size_t(0), numChildren, [&] (const range<size_t>& r) {
+                for (size_t i=r.begin(); i<r.end(); i++) {
+                  refs[i] = recurse(depth+1,children[i],childBegin[i],nullptr,true);
+                  _mm_mfence(); // to allow non-temporal stores during build
+                }
+              });
+          }
+
+          /* finish tree sequentially */
+          else
+          {
+            for (size_t i=0; i<numChildren; i++)
+              refs[i] = recurse(depth+1,children[i],childBegin[i],alloc,false);
+          }
+
+          for (size_t i=0; i<numChildren; i++)
+            setNode(node,i,refs[i],clusters[children[i]].bounds);
+
+          return node;
+        }
+
+        /* build function */
+        NodeRef build(PrimRef* prims_i, PrimRef* tmp, const PrimInfo& pinfo)
+        {
+          const size_t numPrimitives = pinfo.size();
+          prims = prims_i;
+          sortedPrims = tmp;
+
+          /* sort primitives along the morton curve */
+          avector<BVHBuilderMorton::BuildPrim> morton(numPrimitives);
+          {
+            avector<BVHBuilderMorton::BuildPrim> morton_tmp(numPrimitives);
+            BVHBuilderMorton::MortonCodeMapping mapping(pinfo.centBounds);
+            parallel_for(size_t(0), numPrimitives, size_t(1024), [&] (const range<size_t>& r) {
+                BVHBuilderMorton::MortonCodeGenerator generator(mapping,&morton[r.begin()]);
+                for (size_t i=r.begin(); i<r.end(); i++)
+                  generator(prims[i].bounds(),unsigned(i));
+              });
+            radix_sort_u64(morton.data(),morton_tmp.data(),numPrimitives,singleThreadThreshold);
+          }
+
+          /* every primitive starts as a single cluster, the primitives
+           * get copied in Morton order to gather them coherently later */
+          clusters.resize(2*numPrimitives-1);
+          clusterIDs.resize(numPrimitives);
+          clusterBounds.resize(numPrimitives);
+          nextClusterIDs.resize(numPrimitives);
+          nextClusterBounds.resize(numPrimitives);
+          neighbor.resize(numPrimitives);
+          parallel_for(size_t(0), numPrimitives, size_t(1024), [&] (const range<size_t>& r) {
+              for (size_t i=r.begin(); i<r.end(); i++)
+              {
+                sortedPrims[i] = prims[morton[i].index];
+                Cluster& c = clusters[i];
+                c.bounds = sortedPrims[i].bounds();
+                c.left = (unsigned int) i;
+                c.right = Cluster::INVALID;
+                c.num = 1 | Cluster::LEAF_FLAG;
+                c.cost = leafCost(1,c.bounds);
+                clusterIDs[i] = (unsigned int) i;
+                clusterBounds[i] = c.bounds;
+              }
+            });
+          morton.clear();
+          nextCluster = (unsigned int) numPrimitives;
+
+          /* merge clusters until only the root is left */
+          size_t numClusters = numPrimitives;
+          while (numClusters > 1)
+          {
+            findNearestNeighbors(numClusters);
+            const size_t numMerged = mergeClusters(numClusters);
+            assert(numMerged < numClusters);
+            numClusters = numMerged;
+            std::swap(clusterIDs,nextClusterIDs);
+            std::swap(clusterBounds,nextClusterBounds);
+          }
+
+          /* collapse binary tree into BVH */
+          const NodeRef root = recurse(1,clusterIDs[0],0,nullptr,true);
+          _mm_mfence(); // to allow non-temporal stores during build
+
+          clusters.clear();
+          clusterIDs.clear();
+          clusterBounds.clear();
+          nextClusterIDs.clear();
+          nextClusterBounds.clear();
+          neighbor.clear();
+          return root;
+        }
+
+      public:
+        CreateAllocFunc& createAllocator;
+        CreateNodeFunc& createNode;
+        SetNodeFunc& setNode;
+        CreateLeafFunc& createLeaf;
+        ProgressMonitor& progressMonitor;
+
+      private:
+        PrimRef* prims;
+        PrimRef* sortedPrims;
+        avector<Cluster> clusters;
+        std::atomic<unsigned int> nextCluster;
+        avector<unsigned int> clusterIDs, nextClusterIDs;
+        avector<BBox3fa> clusterBounds, nextClusterBounds;
+        avector<unsigned int> neighbor;
+      };
+
+      /*! builds a BVH over the primitives, which get reordered such that leaves reference consecutive ranges, tmp has to hold as many primitives */
+      template<
+        typename NodeRef,
+        typename CreateAllocFunc,
+        typename CreateNodeFunc,
+        typename SetNodeFunc,
+        typename CreateLeafFunc,
+        typename ProgressMonitor>
+
+        static NodeRef build(CreateAllocFunc createAllocator,
+                             CreateNodeFunc createNode,
+                             SetNodeFunc setNode,
+                             CreateLeafFunc createLeaf,
+                             ProgressMonitor progressMonitor,
+                             PrimRef* prims,
+                             PrimRef* tmp,
+                             const PrimInfo& pinfo,
+                             const Settings& settings)
+        {
+          typedef BuilderT<
+            NodeRef,
+            CreateAllocFunc,
+            CreateNodeFunc,
+            SetNodeFunc,
+            CreateLeafFunc,
+            ProgressMonitor> Builder;
+
+          Builder builder(createAllocator,
+                          createNode,
+                          setNode,
+                          createLeaf,
+                          progressMonitor,
+                          settings);
+
+          return builder.build(prims,tmp,pinfo);
+        }
+    };
+  }
+}
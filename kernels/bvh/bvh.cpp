@@ -16,6 +16,9 @@
 
 #include "bvh.h"
 #include "bvh_statistics.h"
+#include "bvh_collider.h"
+#include "bvh_serializer.h"
+#include "../common/point_query.h"
 
 namespace embree
 {
@@ -23,7 +26,7 @@ namespace embree
   BVHN<N>::BVHN (const PrimitiveType& primTy, Scene* scene)
     : AccelData((N==4) ? AccelData::TY_BVH4 : (N==8) ? AccelData::TY_BVH8 : AccelData::TY_UNKNOWN),
       primTy(&primTy), device(scene->device), scene(scene),
-      root(emptyNode), alloc(scene->device,scene->isStaticAccel()), numPrimitives(0), numVertices(0)
+      root(emptyNode), alloc(scene->device,scene->isStaticAccel(),scene), numPrimitives(0), numVertices(0)
   {
   }
 
@@ -39,6 +42,137 @@ namespace embree
   {
     set(BVHN::emptyNode,empty,0);
     alloc.clear();
+    image = nullptr;
+  }
+
+  template<int N>
+  bool BVHN<N>::pointQuery(PointQueryContext* context)
+  {
+    struct StackItem {
+      NodeRef ref;  //!< node reference
+      float dist2;  //!< squared distance of the query point to the node bounds
+    };
+
+    /* squared distance of the query point to a box */
+    const Vec3fa p = context->point();
+    auto distance2 = [&] (const BBox3fa& b) -> float {
+      const Vec3fa d = max(b.lower-p,Vec3fa(zero),p-b.upper);
+      return dot(d,d);
+    };
+
+    static const size_t stackSize = 1+(N-1)*maxDepth;
+    StackItem stack[stackSize];
+    StackItem* stackPtr = stack;
+    if (root == emptyNode) return false;
+    *stackPtr++ = { root, 0.0f };
+
+    const float time = context->time();
+    bool changed = false;
+
+    while (stackPtr != stack)
+    {
+      /* pop next node and cull it against the possibly reduced radius */
+      const StackItem cur = *--stackPtr;
+      if (cur.dist2 > sqr(context->radius())) continue;
+      const NodeRef node = cur.ref;
+
+      /* process all primitives of a leaf */
+      if (node.isLeaf())
+      {
+        size_t num; const char* prim = node.leaf(num);
+        for (size_t b=0; b<num; b++)
+        {
+          const size_t numPrims = primTy->sizeTotal(prim);
+          for (size_t i=0; i<numPrims; i++) {
+            unsigned int geomID, primID;
+            if (primTy->getIDs(prim,i,geomID,primID))
+              changed |= context->primitive(geomID,primID);
+          }
+          prim += primTy->getBytes(prim);
+        }
+        continue;
+      }
+
+      /* gather children that overlap the query sphere */
+      StackItem children[N];
+      size_t numChildren = 0;
+      const float radius2 = sqr(context->radius());
+      for (size_t i=0; i<N; i++)
+      {
+        NodeRef child; float dist2 = 0.0f;
+        if (node.isAlignedNode()) {
+          const AlignedNode* n = node.alignedNode();
+          child = n->child(i); if (child == emptyNode) continue;
+          dist2 = distance2(n->bounds(i));
+        }
+        else if (node.isAlignedNodeMB()) {
+          const AlignedNodeMB* n = node.alignedNodeMB();
+          child = n->child(i); if (child == emptyNode) continue;
+          dist2 = distance2(n->bounds(i,time));
+        }
+        else if (node.isAlignedNodeMB4D()) {
+          const AlignedNodeMB4D* n = node.alignedNodeMB4D();
+          child = n->child(i); if (child == emptyNode) continue;
+          if (!(n->lower_t[i] <= time && time < n->upper_t[i])) continue;
+          dist2 = distance2(n->bounds(i,time));
+        }
+        else if (node.isQuantizedNode()) {
+          const QuantizedNode* n = node.quantizedNode();
+          child = n->child(i); if (child == emptyNode) continue;
+          dist2 = distance2(n->bounds(i));
+        }
+        /* unaligned nodes are conservatively always entered */
+        else if (node.isUnalignedNode()) {
+          child = node.unalignedNode()->child(i); if (child == emptyNode) continue;
+        }
+        else if (node.isUnalignedNodeMB()) {
+          child = node.unalignedNodeMB()->child(i); if (child == emptyNode) continue;
+        }
+        else
+          throw_RTCError(RTC_ERROR_UNKNOWN,"unsupported node type in point query");
+
+        if (dist2 > radius2) continue;
+
+        /* sort children by decreasing distance */
+        size_t j = numChildren++;
+        for (; j>0 && children[j-1].dist2 < dist2; j--)
+          children[j] = children[j-1];
+        children[j] = { child, dist2 };
+      }
+
+      /* push children such that the closest one is processed first */
+      for (size_t i=0; i<numChildren; i++)
+        *stackPtr++ = children[i];
+    }
+    return changed;
+  }
+
+  template<int N>
+  void BVHN<N>::collide(AccelData* other, const CollideContext* context)
+  {
+    if (other == this)
+      BVHNSelfCollider<N>::collide(this,context);
+    else if (other->type == TY_BVH4)
+      BVHNCollider<N,4>::collide(this,(BVHN<4>*)other,context);
+#if defined(__AVX__)
+    else if (other->type == TY_BVH8)
+      BVHNCollider<N,8>::collide(this,(BVHN<8>*)other,context);
+#endif
+    /* let the other acceleration structure drive the traversal */
+    else {
+      const CollideContext swapped = context->swap();
+      other->collide(this,&swapped);
+    }
+  }
+
+  template<int N>
+  bool BVHN<N>::save(std::ostream& stream, AccelImageHeader& header) const {
+    return BVHNSerializer<N>::save(this,stream,header);
+  }
+
+  template<int N>
+  bool BVHN<N>::load(SceneImage* image, const AccelImageHeader& header) {
+    return BVHNSerializer<N>::load(this,image,header);
   }
 
   template<int N>
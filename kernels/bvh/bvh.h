@@ -1433,6 +1433,18 @@ namespace embree
     /*! clears the acceleration structure */
     void clear();
 
+    /*! processes all primitives within the point query radius */
+    bool pointQuery(PointQueryContext* context);
+
+    /*! reports all pairs of primitives of this and some other acceleration structure with overlapping bounds */
+    void collide(AccelData* other, const CollideContext* context);
+
+    /*! writes the BVH as relocatable image to a stream */
+    bool save(std::ostream& stream, AccelImageHeader& header) const;
+
+    /*! maps the BVH from a BVH file */
+    bool load(SceneImage* image, const AccelImageHeader& header);
+
     /*! sets BVH members after build */
     void set (NodeRef root, const LBBox3fa& bounds, size_t numPrimitives);
 
@@ -1532,6 +1544,7 @@ namespace embree
     Scene* scene;                      //!< scene pointer
     NodeRef root;                      //!< root node
     FastAllocator alloc;               //!< allocator used to allocate nodes
+    Ref<SceneImage> image;             //!< BVH file the nodes got mapped from
 
     /*! statistics data */
   public:
@@ -43,6 +43,44 @@ namespace embree
     /************************************************************************************/
     /************************************************************************************/
 
+    /*! Adapts the minimal leaf size to the memory budget of the
+     *  scene. Larger leaves reduce the number of nodes, thus the leaf
+     *  size gets doubled until the estimated nodes and leaves fit into
+     *  the available memory, minus the temporary bytes the builder
+     *  still has to allocate. If even leaves of maximal size do not
+     *  fit, the build proceeds and the memory monitor of the scene
+     *  raises an out of memory error once the budget gets exceeded. */
+    template<int N, typename Primitive>
+      void adaptLeafSizeToMemoryBudget(Scene* scene, size_t numPrimitives, size_t tempBytes, GeneralBVHBuilder::Settings& settings)
+    {
+      const size_t available = scene->availableMemory();
+      if (available == std::numeric_limits<size_t>::max()) return;
+
+      const size_t leaf_bytes = size_t(1.2*Primitive::blocks(numPrimitives)*sizeof(Primitive));
+      size_t leafSize = max(settings.minLeafSize,size_t(4));
+      while (leafSize < settings.maxLeafSize) {
+        const size_t node_bytes = numPrimitives*sizeof(typename BVHN<N>::AlignedNode)/(leafSize*N);
+        if (tempBytes+node_bytes+leaf_bytes <= available) break;
+        leafSize = min(2*leafSize,settings.maxLeafSize);
+      }
+      settings.minLeafSize = max(settings.minLeafSize,leafSize);
+    }
+
+    /*! Limits the number of primitive references of a spatial split
+     *  build to what fits into the memory budget of the scene. Each
+     *  replication costs a primitive reference, leaf space, and node
+     *  space. Once the replication budget is exhausted for a subtree,
+     *  the builder does not perform spatial splits in that subtree. */
+    template<int N, typename Primitive>
+      size_t limitSplitPrimitivesToMemoryBudget(Scene* scene, size_t numPrimitives, size_t numSplitPrimitives)
+    {
+      const size_t available = scene->availableMemory();
+      if (available == std::numeric_limits<size_t>::max()) return numSplitPrimitives;
+
+      const size_t bytesPerPrimitive = sizeof(PrimRef) + size_t(1.2*sizeof(Primitive)/Primitive::max_size()) + sizeof(typename BVHN<N>::AlignedNode)/(4*N);
+      return max(numPrimitives,min(numSplitPrimitives,available/bytesPerPrimitive));
+    }
+
     template<int N>
       struct BVHNBuilderVirtual
       {
@@ -0,0 +1,335 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#include "bvh_builder_incremental.h"
+#include "../builders/bvh_builder_sah.h"
+#include "../geometry/instance.h"
+
+/* subtrees whose surface area grew by more than this factor get rebuilt */
+#define MAX_AREA_INCREASE 2.0f
+
+/* minimal depth budget required to rebuild a subtree */
+#define MIN_REBUILD_DEPTH 8
+
+namespace embree
+{
+  namespace isa
+  {
+    static __forceinline size_t instanceCommitCounter(const Instance* instance) {
+      return ((Scene*)instance->object)->commitCounter;
+    }
+
+    template<int N>
+    BVHNBuilderIncremental<N>::BVHNBuilderIncremental (BVH* bvh, Scene* scene, Builder* builder)
+      : bvh(bvh), scene(scene), builder(builder), root(BVH::emptyNode), prims(scene->device,0), numDeadNodes(0) {}
+
+    template<int N>
+    void BVHNBuilderIncremental<N>::build()
+    {
+      if (update())
+        return;
+
+      builder->build();
+
+      if (!gather()) {
+        nodes.clear();
+        leaves.clear();
+      }
+    }
+
+    template<int N>
+    void BVHNBuilderIncremental<N>::deleteGeometry(size_t geomID)
+    {
+      /* deleted instances are detected by the next build */
+      builder->deleteGeometry(geomID);
+    }
+
+    template<int N>
+    void BVHNBuilderIncremental<N>::clear()
+    {
+      builder->clear();
+      root = BVH::emptyNode;
+      nodes.clear();
+      leaves.clear();
+      dirty.clear();
+      queued.clear();
+      prims.clear();
+      numDeadNodes = 0;
+    }
+
+    template<int N>
+    bool BVHNBuilderIncremental<N>::update()
+    {
+      const size_t numGeometries = scene->size();
+      if (nodes.empty() || bvh->root != root || leaves.size() != numGeometries || 2*numDeadNodes > nodes.size())
+        return false;
+
+      /* write new bounds of modified instances into their parent nodes */
+      std::atomic<bool> changed(false);
+      std::atomic<size_t> numDirty(0);
+      dirty.resize(numGeometries);
+
+      parallel_for(size_t(0), numGeometries, size_t(1024), [&] (const range<size_t>& r)
+      {
+        for (size_t geomID=r.begin(); geomID<r.end(); geomID++)
+        {
+          Leaf& leaf = leaves[geomID];
+          Instance* instance = scene->getSafe<Instance>(geomID);
+          if (instance == nullptr || !instance->isEnabled() || instance->numTimeSteps != 1) {
+            if (leaf.node != INVALID && leaf.node != SKIPPED) changed = true;
+            continue;
+          }
+
+          const size_t commitCounter = instanceCommitCounter(instance);
+          if (!instance->isModified() && commitCounter == leaf.commitCounter) {
+            if (leaf.node == INVALID) changed = true;
+            continue;
+          }
+
+          if (leaf.node == INVALID || leaf.node == SKIPPED) {
+            changed = true;
+            continue;
+          }
+
+          /* geometry IDs may get reused by new instances */
+          AlignedNode* node = nodes[leaf.node].ref.alignedNode();
+          size_t num; const InstancePrimitive* prim = (const InstancePrimitive*) node->child(leaf.slot).leaf(num);
+          const BBox3fa bounds = instance->bounds(0);
+          if (prim->instance != instance || !isvalid(bounds)) {
+            changed = true;
+            continue;
+          }
+
+          node->setBounds(leaf.slot,bounds);
+          leaf.commitCounter = commitCounter;
+          dirty[numDirty++] = leaf.node;
+        }
+      });
+
+      if (changed)
+        return false;
+
+      if (numDirty == 0)
+        return true;
+
+      double t0 = bvh->preBuild(TOSTRING(isa) "::BVH" + toString(N) + "BuilderIncremental");
+
+      /* refit bottom up, children are always processed before their parents */
+      std::vector<unsigned int> damaged;
+      std::vector<unsigned int> heap;
+      queued.resize(nodes.size(),0);
+      for (size_t i=0; i<numDirty; i++) {
+        if (queued[dirty[i]]) continue;
+        queued[dirty[i]] = 1;
+        heap.push_back(dirty[i]);
+      }
+      std::make_heap(heap.begin(),heap.end());
+
+      while (heap.size())
+      {
+        std::pop_heap(heap.begin(),heap.end());
+        const unsigned int nodeID = heap.back(); heap.pop_back();
+        queued[nodeID] = 0;
+
+        const Node& node = nodes[nodeID];
+        const BBox3fa bounds = node.ref.alignedNode()->bounds();
+        if (area(bounds) > MAX_AREA_INCREASE*node.buildArea)
+          damaged.push_back(nodeID);
+
+        if (node.parent == INVALID) {
+          bvh->bounds = LBBox3fa(bounds);
+          continue;
+        }
+
+        AlignedNode* parent = nodes[node.parent].ref.alignedNode();
+        if (parent->bounds(node.slot) == bounds)
+          continue;
+
+        parent->setBounds(node.slot,bounds);
+        if (queued[node.parent]) continue;
+        queued[node.parent] = 1;
+        heap.push_back(node.parent);
+        std::push_heap(heap.begin(),heap.end());
+      }
+
+      /* locally rebuild the topmost damaged subtrees */
+      if (damaged.size())
+      {
+        for (auto nodeID : damaged) queued[nodeID] = 1;
+
+        bool ok = true;
+        for (auto nodeID : damaged)
+        {
+          bool top = true;
+          for (unsigned int p = nodes[nodeID].parent; p != INVALID; p = nodes[p].parent)
+            if (queued[p]) { top = false; break; }
+
+          if (top && !rebuild(nodeID)) {
+            ok = false;
+            break;
+          }
+        }
+
+        for (auto nodeID : damaged) queued[nodeID] = 0;
+        queued.resize(nodes.size(),0);
+        bvh->alloc.cleanup();
+
+        if (!ok) return false;
+      }
+
+      bvh->postBuild(t0);
+      return true;
+    }
+
+    template<int N>
+    bool BVHNBuilderIncremental<N>::gather()
+    {
+      root = bvh->root;
+      nodes.clear();
+      queued.clear();
+      numDeadNodes = 0;
+
+      const size_t numGeometries = scene->size();
+      leaves.clear();
+      leaves.resize(numGeometries);
+
+      /* a single instance or an empty BVH is cheap to rebuild */
+      if (!root.isAlignedNode())
+        return false;
+
+      if (!gather(root,bvh->bounds.bounds(),INVALID,0,0))
+        return false;
+
+      /* remember enabled instances that got skipped because of invalid bounds */
+      parallel_for(size_t(0), numGeometries, size_t(1024), [&] (const range<size_t>& r)
+      {
+        for (size_t geomID=r.begin(); geomID<r.end(); geomID++)
+        {
+          Instance* instance = scene->getSafe<Instance>(geomID);
+          if (instance == nullptr || !instance->isEnabled() || instance->numTimeSteps != 1) continue;
+          if (leaves[geomID].node != INVALID) continue;
+          leaves[geomID].node = SKIPPED;
+          leaves[geomID].commitCounter = instanceCommitCounter(instance);
+        }
+      });
+      return true;
+    }
+
+    template<int N>
+    bool BVHNBuilderIncremental<N>::gather(NodeRef ref, const BBox3fa& bounds, unsigned int parent, unsigned int slot, unsigned int depth)
+    {
+      if (ref.isLeaf())
+      {
+        size_t num; const InstancePrimitive* prim = (const InstancePrimitive*) ref.leaf(num);
+        for (size_t i=0; i<num; i++) {
+          Leaf& leaf = leaves[prim[i].instance->geomID];
+          leaf.node = parent;
+          leaf.slot = slot;
+          leaf.commitCounter = instanceCommitCounter(prim[i].instance);
+        }
+        return true;
+      }
+
+      if (!ref.isAlignedNode())
+        return false;
+
+      const unsigned int nodeID = (unsigned int) nodes.size();
+      nodes.push_back(Node(ref,parent,slot,depth,area(bounds)));
+
+      AlignedNode* node = ref.alignedNode();
+      for (size_t i=0; i<N; i++) {
+        if (node->child(i) == BVH::emptyNode) continue;
+        if (!gather(node->child(i),node->bounds(i),nodeID,(unsigned int)i,depth+1))
+          return false;
+      }
+      return true;
+    }
+
+    template<int N>
+    void BVHNBuilderIncremental<N>::collect(NodeRef ref, const BBox3fa& bounds)
+    {
+      if (ref.isLeaf()) {
+        prims.push_back(PrimRef(bounds,(size_t)ref));
+        return;
+      }
+
+      numDeadNodes++;
+      AlignedNode* node = ref.alignedNode();
+      for (size_t i=0; i<N; i++) {
+        if (node->child(i) == BVH::emptyNode) continue;
+        collect(node->child(i),node->bounds(i));
+      }
+    }
+
+    template<int N>
+    bool BVHNBuilderIncremental<N>::rebuild(unsigned int nodeID)
+    {
+      const Node node = nodes[nodeID];
+      if (node.parent == INVALID || node.depth+MIN_REBUILD_DEPTH > BVH::maxBuildDepthLeaf)
+        return false;
+
+      AlignedNode* parent = nodes[node.parent].ref.alignedNode();
+      const BBox3fa bounds = parent->bounds(node.slot);
+
+      /* use the leaves of the subtree as build primitives */
+      prims.clear();
+      collect(node.ref,bounds);
+
+      PrimInfo pinfo(empty);
+      for (size_t i=0; i<prims.size(); i++)
+        pinfo.add_center2(prims[i]);
+
+      GeneralBVHBuilder::Settings settings;
+      settings.branchingFactor = N;
+      settings.maxDepth = BVH::maxBuildDepthLeaf-node.depth;
+      settings.logBlockSize = bsr(N);
+      settings.minLeafSize = 1;
+      settings.maxLeafSize = 1;
+      settings.travCost = 1.0f;
+      settings.intCost = 1.0f;
+      settings.singleThreadThreshold = DEFAULT_SINGLE_THREAD_THRESHOLD;
+
+      NodeRef ref = BVHBuilderBinnedSAH::build<NodeRef>(
+        typename BVH::CreateAlloc(bvh),
+        typename BVH::AlignedNode::Create2(),
+        typename BVH::AlignedNode::Set2(),
+
+        [&] (const PrimRef* prims, const range<size_t>& range, const FastAllocator::CachedAllocator& alloc) -> NodeRef {
+          assert(range.size() == 1);
+          return (NodeRef) prims[range.begin()].ID();
+        },
+        [&] (size_t dn) { bvh->scene->progressMonitor(0); },
+        prims.data(),pinfo,settings);
+
+      parent->child(node.slot) = ref;
+      return gather(ref,bounds,node.parent,node.slot,node.depth);
+    }
+
+#if defined(EMBREE_GEOMETRY_INSTANCE)
+    Builder* BVH4InstanceSceneBuilderSAH (void* bvh, Scene* scene, size_t mode);
+    Builder* BVH4InstanceSceneBuilderIncremental (void* bvh, Scene* scene, size_t mode) {
+      return new BVHNBuilderIncremental<4>((BVH4*)bvh,scene,BVH4InstanceSceneBuilderSAH(bvh,scene,mode));
+    }
+#if defined(__AVX__)
+    Builder* BVH8InstanceSceneBuilderSAH (void* bvh, Scene* scene, size_t mode);
+    Builder* BVH8InstanceSceneBuilderIncremental (void* bvh, Scene* scene, size_t mode) {
+      return new BVHNBuilderIncremental<8>((BVH8*)bvh,scene,BVH8InstanceSceneBuilderSAH(bvh,scene,mode));
+    }
+#endif
+#endif
+  }
+}
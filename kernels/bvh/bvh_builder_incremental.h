@@ -0,0 +1,105 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#pragma once
+
+#include "bvh.h"
+#include "../common/primref.h"
+
+namespace embree
+{
+  namespace isa
+  {
+    /*! Incremental builder for the instance level of dynamic
+     *  scenes. Bounds of modified instances are refitted along their
+     *  path to the root, subtrees whose surface area grew too much
+     *  are rebuilt locally, and adding, removing, enabling or
+     *  disabling instances triggers a full rebuild. */
+    template<int N>
+    class BVHNBuilderIncremental : public Builder
+    {
+      typedef BVHN<N> BVH;
+      typedef typename BVH::AlignedNode AlignedNode;
+      typedef typename BVH::NodeRef NodeRef;
+
+      static const unsigned int INVALID = -1;
+      static const unsigned int SKIPPED = -2;
+
+      /*! inner node of the BVH together with its location in the parent */
+      struct Node
+      {
+        __forceinline Node () {}
+        __forceinline Node (NodeRef ref, unsigned int parent, unsigned int slot, unsigned int depth, float buildArea)
+          : ref(ref), parent(parent), slot(slot), depth(depth), buildArea(buildArea) {}
+
+        NodeRef ref;
+        unsigned int parent;   //!< index of parent node or INVALID for the root
+        unsigned int slot;     //!< child slot in parent node
+        unsigned int depth;    //!< depth of node in the BVH
+        float buildArea;       //!< surface area when the node got built
+      };
+
+      /*! location of an instance in the BVH */
+      struct Leaf
+      {
+        __forceinline Leaf ()
+          : node(INVALID), slot(0), commitCounter(0) {}
+
+        unsigned int node;     //!< index of parent node, INVALID if not in BVH, SKIPPED for invalid bounds
+        unsigned int slot;     //!< child slot in parent node
+        size_t commitCounter;  //!< commit counter of instanced scene when the bounds got set
+      };
+
+    public:
+
+      /*! Constructor. */
+      BVHNBuilderIncremental (BVH* bvh, Scene* scene, Builder* builder);
+
+      /*! builder entry point */
+      void build();
+      void deleteGeometry(size_t geomID);
+      void clear();
+
+    private:
+
+      /*! refits the BVH and rebuilds damaged subtrees, returns false if a full rebuild is required */
+      bool update();
+
+      /*! records the nodes and instances of the BVH after a full build */
+      bool gather();
+      bool gather(NodeRef ref, const BBox3fa& bounds, unsigned int parent, unsigned int slot, unsigned int depth);
+
+      /*! rebuilds the subtree of some node, returns false if not possible */
+      bool rebuild(unsigned int nodeID);
+      void collect(NodeRef ref, const BBox3fa& bounds);
+
+    public:
+      BVH* bvh;
+      Scene* scene;
+      std::unique_ptr<Builder> builder;
+
+    private:
+      NodeRef root;                   //!< root of the BVH the node array got recorded for
+      std::vector<Node> nodes;        //!< inner nodes, parents are always stored before their children
+      std::vector<Leaf> leaves;       //!< location of each geometry in the BVH
+      std::vector<unsigned int> dirty;
+      std::vector<char> queued;
+      mvector<PrimRef> prims;
+      size_t numDeadNodes;            //!< number of nodes freed by local rebuilds
+    };
+  }
+}
@@ -419,17 +419,22 @@ namespace embree
 
         /* create morton code array */
         BVHBuilderMorton::BuildPrim* dest = (BVHBuilderMorton::BuildPrim*) bvh->alloc.specialAlloc(bytesMortonCodes);
+        double t0 = getSeconds();
         size_t numPrimitivesGen = createMortonCodeArray<Mesh>(mesh,morton,bvh->scene->progressInterface);
+        bvh->device->addBuildPhaseTime(Device::BUILD_PHASE_PRIMITIVES,getSeconds()-t0);
 
         /* create BVH */
         SetBVHNBounds<N> setBounds(bvh);
         CreateMortonLeaf<N,Primitive> createLeaf(mesh,morton.data());
         CalculateMeshBounds<Mesh> calculateBounds(mesh);
+        BVHBuilderMorton::Timings timings;
         auto root = BVHBuilderMorton::build<NodeRecord>(
           typename BVH::CreateAlloc(bvh), 
           typename BVH::AlignedNode::Create(),
           setBounds,createLeaf,calculateBounds,bvh->scene->progressInterface,
-          morton.data(),dest,numPrimitivesGen,settings);
+          morton.data(),dest,numPrimitivesGen,settings,&timings);
+        bvh->device->addBuildPhaseTime(Device::BUILD_PHASE_SORT,timings.sort);
+        bvh->device->addBuildPhaseTime(Device::BUILD_PHASE_HIERARCHY,timings.hierarchy);
         
         bvh->set(root.ref,LBBox3fa(root.bounds),numPrimitives);
         
@@ -0,0 +1,164 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "bvh.h"
+#include "bvh_builder.h"
+
+#include "../builders/primrefgen.h"
+#include "../builders/bvh_builder_ploc.h"
+
+#include "../geometry/triangle.h"
+#include "../geometry/trianglev.h"
+#include "../geometry/trianglei.h"
+#include "../geometry/quadv.h"
+#include "../geometry/quadi.h"
+
+namespace embree
+{
+  namespace isa
+  {
+    template<int N, typename Primitive>
+    struct CreateLeafPLOC
+    {
+      typedef BVHN<N> BVH;
+      typedef typename BVH::NodeRef NodeRef;
+
+      __forceinline CreateLeafPLOC (BVH* bvh) : bvh(bvh) {}
+
+      __forceinline NodeRef operator() (const PrimRef* prims, const range<size_t>& set, const FastAllocator::CachedAllocator& alloc) const
+      {
+        size_t n = set.size();
+        size_t items = Primitive::blocks(n);
+        size_t start = set.begin();
+        Primitive* accel = (Primitive*) alloc.malloc1(items*sizeof(Primitive),BVH::byteAlignment);
+        typename BVH::NodeRef node = BVH::encodeLeaf((char*)accel,items);
+        for (size_t i=0; i<items; i++) {
+          accel[i].fill(prims,start,set.end(),bvh->scene);
+        }
+        return node;
+      }
+
+      BVH* bvh;
+    };
+
+    template<int N, typename Mesh, typename Primitive>
+    struct BVHNBuilderPLOC : public Builder
+    {
+      typedef BVHN<N> BVH;
+      typedef typename BVH::NodeRef NodeRef;
+
+      BVH* bvh;
+      Scene* scene;
+      mvector<PrimRef> prims;
+      mvector<PrimRef> sortedPrims;
+      BVHBuilderPLOC::Settings settings;
+
+      BVHNBuilderPLOC (BVH* bvh, Scene* scene, const size_t sahBlockSize, const float intCost, const size_t maxLeafSize)
+        : bvh(bvh), scene(scene), prims(scene->device,0), sortedPrims(scene->device,0),
+          settings(N, BVH::maxBuildDepthLeaf, scene->device->ploc_search_radius, sahBlockSize, min(maxLeafSize,Primitive::max_size()*BVH::maxLeafBlocks), travCost, intCost, DEFAULT_SINGLE_THREAD_THRESHOLD) {}
+
+      void build()
+      {
+	/* skip build for empty scene */
+        const size_t numPrimitives = scene->getNumPrimitives<Mesh,false>();
+        if (numPrimitives == 0) {
+          bvh->clear();
+          prims.clear();
+          sortedPrims.clear();
+          return;
+        }
+
+        double t0 = bvh->preBuild(TOSTRING(isa) "::BVH" + toString(N) + "BuilderPLOC");
+
+        /* create primref array */
+        prims.resize(numPrimitives);
+        double t1 = getSeconds();
+        PrimInfo pinfo = createPrimRefArray(scene,Mesh::geom_type,false,prims,bvh->scene->progressInterface);
+        double t2 = getSeconds();
+        bvh->device->addBuildPhaseTime(Device::BUILD_PHASE_PRIMITIVES,t2-t1);
+
+        /* pinfo might has zero size due to invalid geometry */
+        if (unlikely(pinfo.size() == 0))
+        {
+          bvh->clear();
+          prims.clear();
+          sortedPrims.clear();
+          return;
+        }
+
+        /* initialize allocator */
+        const size_t node_bytes = pinfo.size()*sizeof(typename BVH::AlignedNode)/(4*N);
+        const size_t leaf_bytes = size_t(1.2*Primitive::blocks(pinfo.size())*sizeof(Primitive));
+        bvh->alloc.init_estimate(node_bytes+leaf_bytes);
+        settings.singleThreadThreshold = bvh->alloc.fixSingleThreadThreshold(N,DEFAULT_SINGLE_THREAD_THRESHOLD,pinfo.size(),node_bytes+leaf_bytes);
+        sortedPrims.resize(pinfo.size());
+
+        /* call BVH builder */
+        NodeRef root = BVHBuilderPLOC::build<NodeRef>(
+          typename BVH::CreateAlloc(bvh),
+          typename BVH::AlignedNode::Create(),
+          typename BVH::AlignedNode::Set(),
+          CreateLeafPLOC<N,Primitive>(bvh),
+          bvh->scene->progressInterface,
+          prims.data(),sortedPrims.data(),pinfo,settings);
+        bvh->device->addBuildPhaseTime(Device::BUILD_PHASE_HIERARCHY,getSeconds()-t2);
+        sortedPrims.clear();
+
+        bvh->set(root,LBBox3fa(pinfo.geomBounds),pinfo.size());
+        bvh->layoutLargeNodes(size_t(pinfo.size()*0.005f));
+
+	/* clear temporary data for static geometry */
+	if (scene->isStaticAccel()) {
+          prims.clear();
+          bvh->shrink();
+        }
+	bvh->cleanup();
+        bvh->postBuild(t0);
+      }
+
+      void clear() {
+        prims.clear();
+        sortedPrims.clear();
+      }
+    };
+
+    /************************************************************************************/
+    /************************************************************************************/
+    /************************************************************************************/
+    /************************************************************************************/
+
+#if defined(EMBREE_GEOMETRY_TRIANGLE)
+
+    Builder* BVH4Triangle4SceneBuilderPLOC  (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderPLOC<4,TriangleMesh,Triangle4> ((BVH4*)bvh,scene,4,1.0f,inf); }
+    Builder* BVH4Triangle4vSceneBuilderPLOC (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderPLOC<4,TriangleMesh,Triangle4v>((BVH4*)bvh,scene,4,1.0f,inf); }
+    Builder* BVH4Triangle4iSceneBuilderPLOC (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderPLOC<4,TriangleMesh,Triangle4i>((BVH4*)bvh,scene,4,1.0f,inf); }
+
+#if defined(__AVX__)
+    Builder* BVH8Triangle4SceneBuilderPLOC  (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderPLOC<8,TriangleMesh,Triangle4> ((BVH8*)bvh,scene,4,1.0f,inf); }
+    Builder* BVH8Triangle4vSceneBuilderPLOC (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderPLOC<8,TriangleMesh,Triangle4v>((BVH8*)bvh,scene,4,1.0f,inf); }
+#endif
+#endif
+
+#if defined(EMBREE_GEOMETRY_QUAD)
+    Builder* BVH4Quad4vSceneBuilderPLOC  (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderPLOC<4,QuadMesh,Quad4v>((BVH4*)bvh,scene,4,1.0f,inf); }
+    Builder* BVH4Quad4iSceneBuilderPLOC  (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderPLOC<4,QuadMesh,Quad4i>((BVH4*)bvh,scene,4,1.0f,inf); }
+
+#if defined(__AVX__)
+    Builder* BVH8Quad4vSceneBuilderPLOC  (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderPLOC<8,QuadMesh,Quad4v>((BVH8*)bvh,scene,4,1.0f,inf); }
+#endif
+#endif
+  }
+}
@@ -110,11 +110,11 @@ namespace embree
 
       BVHNBuilderSAH (BVH* bvh, Scene* scene, const size_t sahBlockSize, const float intCost, const size_t minLeafSize, const size_t maxLeafSize,
                       const size_t mode, bool primrefarrayalloc = false)
-        : bvh(bvh), scene(scene), mesh(nullptr), prims(scene->device,0),
+        : bvh(bvh), scene(scene), mesh(nullptr), prims(scene,0),
           settings(sahBlockSize, minLeafSize, min(maxLeafSize,Primitive::max_size()*BVH::maxLeafBlocks), travCost, intCost, DEFAULT_SINGLE_THREAD_THRESHOLD), primrefarrayalloc(primrefarrayalloc) {}
 
       BVHNBuilderSAH (BVH* bvh, Mesh* mesh, const size_t sahBlockSize, const float intCost, const size_t minLeafSize, const size_t maxLeafSize, const size_t mode)
-        : bvh(bvh), scene(nullptr), mesh(mesh), prims(bvh->device,0), settings(sahBlockSize, minLeafSize, min(maxLeafSize,Primitive::max_size()*BVH::maxLeafBlocks), travCost, intCost, DEFAULT_SINGLE_THREAD_THRESHOLD), primrefarrayalloc(false) {}
+        : bvh(bvh), scene(nullptr), mesh(mesh), prims(bvh->scene,0), settings(sahBlockSize, minLeafSize, min(maxLeafSize,Primitive::max_size()*BVH::maxLeafBlocks), travCost, intCost, DEFAULT_SINGLE_THREAD_THRESHOLD), primrefarrayalloc(false) {}
 
       // FIXME: shrink bvh->alloc in destructor here and in other builders too
 
@@ -159,11 +159,18 @@ namespace embree
             const size_t leaf_bytes = size_t(1.2*Primitive::blocks(numPrimitives)*sizeof(Primitive));
             bvh->alloc.init_estimate(node_bytes+leaf_bytes);
             settings.singleThreadThreshold = bvh->alloc.fixSingleThreadThreshold(N,DEFAULT_SINGLE_THREAD_THRESHOLD,numPrimitives,node_bytes+leaf_bytes);
+
+            /* use larger leaves to meet the memory budget of the scene */
+            GeneralBVHBuilder::Settings buildSettings = settings;
+            adaptLeafSizeToMemoryBudget<N,Primitive>(bvh->scene,numPrimitives,numPrimitives*sizeof(PrimRef),buildSettings);
             prims.resize(numPrimitives); 
 
+            double t1 = getSeconds();
             PrimInfo pinfo = mesh ?
               createPrimRefArray(mesh,prims,bvh->scene->progressInterface) :
               createPrimRefArray(scene,Mesh::geom_type,false,prims,bvh->scene->progressInterface);
+            double t2 = getSeconds();
+            bvh->device->addBuildPhaseTime(Device::BUILD_PHASE_PRIMITIVES,t2-t1);
 
             /* pinfo might has zero size due to invalid geometry */
             if (unlikely(pinfo.size() == 0))
@@ -174,7 +181,8 @@ namespace embree
             }
 
             /* call BVH builder */
-            NodeRef root = BVHNBuilderVirtual<N>::build(&bvh->alloc,CreateLeaf<N,Primitive>(bvh),bvh->scene->progressInterface,prims.data(),pinfo,settings);
+            NodeRef root = BVHNBuilderVirtual<N>::build(&bvh->alloc,CreateLeaf<N,Primitive>(bvh),bvh->scene->progressInterface,prims.data(),pinfo,buildSettings);
+            bvh->device->addBuildPhaseTime(Device::BUILD_PHASE_HIERARCHY,getSeconds()-t2);
             bvh->set(root,LBBox3fa(pinfo.geomBounds),pinfo.size());
             bvh->layoutLargeNodes(size_t(pinfo.size()*0.005f));
 
@@ -205,6 +213,210 @@ namespace embree
     /************************************************************************************/
     /************************************************************************************/
 
+    /*! Builds a BVH in chunks for scenes whose primitive references do
+     *  not fit into memory. The primitives get partitioned along a
+     *  coarse Morton grid into chunks of at most build_chunk_size
+     *  primitives. Each chunk gets its primitive references generated
+     *  and its sub-BVH built in a separate pass, thus only the
+     *  references of a single chunk are resident at any time. A top
+     *  level BVH gets finally built over the chunks. With a
+     *  build_spill_dir configured, nodes and leaves get allocated from
+     *  memory mapped temporary files, which lets the OS page out the
+     *  finished sub-BVHs. */
+    template<int N, typename Mesh, typename Primitive>
+    struct BVHNBuilderChunkedSAH : public Builder
+    {
+      typedef BVHN<N> BVH;
+      typedef typename BVHN<N>::NodeRef NodeRef;
+
+      static const size_t CELL_BITS = 18; //!< chunks are formed of the cells of a 64^3 grid
+      static const size_t NUM_CELLS = size_t(1) << CELL_BITS;
+
+      BVH* bvh;
+      Scene* scene;
+      mvector<PrimRef> prims;
+      GeneralBVHBuilder::Settings settings;
+
+      BVHNBuilderChunkedSAH (BVH* bvh, Scene* scene, const size_t sahBlockSize, const float intCost, const size_t minLeafSize, const size_t maxLeafSize)
+        : bvh(bvh), scene(scene), prims(scene->device,0),
+          settings(sahBlockSize, minLeafSize, min(maxLeafSize,Primitive::max_size()*BVH::maxLeafBlocks), travCost, intCost, DEFAULT_SINGLE_THREAD_THRESHOLD) {}
+
+      /*! returns the grid cell of some primitive */
+      __forceinline size_t cellID(const BVHBuilderMorton::MortonCodeMapping& mapping, const BBox3fa& bounds) const {
+        return size_t(mapping.code(bounds) >> (3*BVHBuilderMorton::MortonCodeMapping::LATTICE_BITS_PER_DIM-CELL_BITS));
+      }
+
+      void build()
+      {
+	/* skip build for empty scene */
+        const size_t numPrimitives = scene->getNumPrimitives<Mesh,false>();
+        if (numPrimitives == 0) {
+          bvh->clear();
+          prims.clear();
+          return;
+        }
+
+        double t0 = bvh->preBuild(TOSTRING(isa) "::BVH" + toString(N) + "BuilderChunkedSAH");
+
+        /* initialize allocator */
+        const size_t node_bytes = numPrimitives*sizeof(typename BVH::AlignedNode)/(4*N);
+        const size_t leaf_bytes = size_t(1.2*Primitive::blocks(numPrimitives)*sizeof(Primitive));
+        bvh->alloc.setSpillDirectory(scene->device->build_spill_dir);
+        bvh->alloc.init_estimate(node_bytes+leaf_bytes);
+        settings.singleThreadThreshold = bvh->alloc.fixSingleThreadThreshold(N,DEFAULT_SINGLE_THREAD_THRESHOLD,numPrimitives,node_bytes+leaf_bytes);
+
+        /* first pass calculates the bounds of all primitives */
+        double t1 = getSeconds();
+        Scene::Iterator<Mesh,false> iter(scene);
+        const PrimInfo pinfo = parallel_for_for_reduce(iter, size_t(1024), PrimInfo(empty), [&](Mesh* mesh, const range<size_t>& r, size_t k) -> PrimInfo
+        {
+          PrimInfo pinfo(empty);
+          for (size_t j=r.begin(); j<r.end(); j++)
+          {
+            BBox3fa bounds = empty;
+            if (!mesh->buildBounds(j,&bounds)) continue;
+            pinfo.add_center2(PrimRef(bounds,mesh->geomID,unsigned(j)));
+          }
+          return pinfo;
+        }, [](const PrimInfo& a, const PrimInfo& b) -> PrimInfo { return PrimInfo::merge(a,b); });
+
+        /* pinfo might has zero size due to invalid geometry */
+        if (unlikely(pinfo.size() == 0))
+        {
+          bvh->clear();
+          prims.clear();
+          return;
+        }
+
+        /* second pass counts the primitives of each grid cell */
+        const BVHBuilderMorton::MortonCodeMapping mapping(pinfo.centBounds);
+        std::vector<std::atomic<size_t>> cellCounts(NUM_CELLS);
+        for (size_t i=0; i<NUM_CELLS; i++) cellCounts[i] = 0;
+        parallel_for_for(iter, size_t(1024), [&](Mesh* mesh, const range<size_t>& r, size_t k)
+        {
+          for (size_t j=r.begin(); j<r.end(); j++)
+          {
+            BBox3fa bounds = empty;
+            if (!mesh->buildBounds(j,&bounds)) continue;
+            cellCounts[cellID(mapping,bounds)]++;
+          }
+        });
+
+        /* consecutive cells along the Morton curve form the chunks */
+        const size_t chunkSize = scene->device->build_chunk_size;
+        std::vector<range<size_t>> chunks;
+        size_t maxChunkPrimitives = 0;
+        size_t chunkBegin = 0, chunkPrimitives = 0;
+        for (size_t i=0; i<=NUM_CELLS; i++)
+        {
+          const size_t num = i < NUM_CELLS ? size_t(cellCounts[i]) : 0;
+          if (chunkPrimitives && (i == NUM_CELLS || chunkPrimitives+num > chunkSize)) {
+            chunks.push_back(range<size_t>(chunkBegin,i));
+            maxChunkPrimitives = max(maxChunkPrimitives,chunkPrimitives);
+            chunkPrimitives = 0;
+          }
+          if (chunkPrimitives == 0) chunkBegin = i;
+          chunkPrimitives += num;
+        }
+        bvh->device->addBuildPhaseTime(Device::BUILD_PHASE_PRIMITIVES,getSeconds()-t1);
+
+        /* build one sub-BVH per chunk, the primitive references of a chunk get generated in two passes */
+        prims.resize(maxChunkPrimitives);
+        mvector<PrimRef> roots(scene->device,chunks.size());
+        PrimInfo rinfo(empty);
+        ParallelForForPrefixSumState<PrimInfo> pstate;
+        pstate.init(iter,size_t(1024));
+
+        for (size_t c=0; c<chunks.size(); c++)
+        {
+          const range<size_t> cells = chunks[c];
+          double t2 = getSeconds();
+          parallel_for_for_prefix_sum0( pstate, iter, PrimInfo(empty), [&](Mesh* mesh, const range<size_t>& r, size_t k) -> PrimInfo
+          {
+            PrimInfo pinfo(empty);
+            for (size_t j=r.begin(); j<r.end(); j++)
+            {
+              BBox3fa bounds = empty;
+              if (!mesh->buildBounds(j,&bounds)) continue;
+              const size_t cell = cellID(mapping,bounds);
+              if (cell < cells.begin() || cell >= cells.end()) continue;
+              pinfo.add_center2(PrimRef(bounds,mesh->geomID,unsigned(j)));
+            }
+            return pinfo;
+          }, [](const PrimInfo& a, const PrimInfo& b) -> PrimInfo { return PrimInfo::merge(a,b); });
+
+          const PrimInfo cinfo = parallel_for_for_prefix_sum1( pstate, iter, PrimInfo(empty), [&](Mesh* mesh, const range<size_t>& r, size_t k, const PrimInfo& base) -> PrimInfo
+          {
+            PrimInfo pinfo(empty);
+            for (size_t j=r.begin(); j<r.end(); j++)
+            {
+              BBox3fa bounds = empty;
+              if (!mesh->buildBounds(j,&bounds)) continue;
+              const size_t cell = cellID(mapping,bounds);
+              if (cell < cells.begin() || cell >= cells.end()) continue;
+              const PrimRef prim(bounds,mesh->geomID,unsigned(j));
+              prims[base.size()+pinfo.size()] = prim;
+              pinfo.add_center2(prim);
+            }
+            return pinfo;
+          }, [](const PrimInfo& a, const PrimInfo& b) -> PrimInfo { return PrimInfo::merge(a,b); });
+
+          double t3 = getSeconds();
+          bvh->device->addBuildPhaseTime(Device::BUILD_PHASE_PRIMITIVES,t3-t2);
+
+          NodeRef root = BVHNBuilderVirtual<N>::build(&bvh->alloc,CreateLeaf<N,Primitive>(bvh),bvh->scene->progressInterface,prims.data(),cinfo,settings);
+          roots[c] = PrimRef(cinfo.geomBounds,(size_t)root);
+          rinfo.add_center2(roots[c]);
+          bvh->device->addBuildPhaseTime(Device::BUILD_PHASE_HIERARCHY,getSeconds()-t3);
+        }
+        prims.clear();
+
+        /* build top level BVH over the chunks */
+        double t4 = getSeconds();
+        NodeRef root = (NodeRef) roots[0].ID();
+        if (roots.size() > 1)
+        {
+          GeneralBVHBuilder::Settings topSettings;
+          topSettings.branchingFactor = N;
+          topSettings.maxDepth = BVH::maxBuildDepthLeaf;
+          topSettings.logBlockSize = bsr(N);
+          topSettings.minLeafSize = 1;
+          topSettings.maxLeafSize = 1;
+          topSettings.travCost = 1.0f;
+          topSettings.intCost = 1.0f;
+          topSettings.singleThreadThreshold = settings.singleThreadThreshold;
+
+          root = BVHBuilderBinnedSAH::build<NodeRef>(
+            typename BVH::CreateAlloc(bvh),
+            typename BVH::AlignedNode::Create2(),
+            typename BVH::AlignedNode::Set2(),
+            [&] (const PrimRef* prims, const range<size_t>& range, const FastAllocator::CachedAllocator& alloc) -> NodeRef {
+              assert(range.size() == 1);
+              return (NodeRef) prims[range.begin()].ID();
+            },
+            [&] (size_t dn) { bvh->scene->progressMonitor(0); },
+            roots.data(),rinfo,topSettings);
+        }
+        bvh->device->addBuildPhaseTime(Device::BUILD_PHASE_HIERARCHY,getSeconds()-t4);
+        bvh->set(root,LBBox3fa(pinfo.geomBounds),pinfo.size());
+
+        /* for static geometries we can do some cleanups */
+        if (scene->isStaticAccel())
+          bvh->shrink();
+	bvh->cleanup();
+        bvh->postBuild(t0);
+      }
+
+      void clear() {
+        prims.clear();
+      }
+    };
+
+    /************************************************************************************/
+    /************************************************************************************/
+    /************************************************************************************/
+    /************************************************************************************/
+
     template<int N, typename Mesh, typename Primitive>
     struct BVHNBuilderSAHQuantized : public Builder
     {
@@ -562,6 +774,9 @@ namespace embree
     Builder* BVH4Triangle4SceneBuilderSAH  (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAH<4,TriangleMesh,Triangle4>((BVH4*)bvh,scene,4,1.0f,4,inf,mode); }
     Builder* BVH4Triangle4vSceneBuilderSAH (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAH<4,TriangleMesh,Triangle4v>((BVH4*)bvh,scene,4,1.0f,4,inf,mode); }
     Builder* BVH4Triangle4iSceneBuilderSAH (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAH<4,TriangleMesh,Triangle4i>((BVH4*)bvh,scene,4,1.0f,4,inf,mode,true); }
+    Builder* BVH4Triangle4SceneBuilderChunkedSAH  (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderChunkedSAH<4,TriangleMesh,Triangle4>((BVH4*)bvh,scene,4,1.0f,4,inf); }
+    Builder* BVH4Triangle4vSceneBuilderChunkedSAH (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderChunkedSAH<4,TriangleMesh,Triangle4v>((BVH4*)bvh,scene,4,1.0f,4,inf); }
+    Builder* BVH4Triangle4iSceneBuilderChunkedSAH (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderChunkedSAH<4,TriangleMesh,Triangle4i>((BVH4*)bvh,scene,4,1.0f,4,inf); }
 
 
     Builder* BVH4QuantizedTriangle4iSceneBuilderSAH (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAHQuantized<4,TriangleMesh,Triangle4i>((BVH4*)bvh,scene,4,1.0f,4,inf,mode); }
@@ -572,6 +787,8 @@ namespace embree
 
     Builder* BVH8Triangle4SceneBuilderSAH  (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAH<8,TriangleMesh,Triangle4>((BVH8*)bvh,scene,4,1.0f,4,inf,mode); }
     Builder* BVH8Triangle4vSceneBuilderSAH  (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAH<8,TriangleMesh,Triangle4v>((BVH8*)bvh,scene,4,1.0f,4,inf,mode); }
+    Builder* BVH8Triangle4SceneBuilderChunkedSAH  (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderChunkedSAH<8,TriangleMesh,Triangle4>((BVH8*)bvh,scene,4,1.0f,4,inf); }
+    Builder* BVH8Triangle4vSceneBuilderChunkedSAH (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderChunkedSAH<8,TriangleMesh,Triangle4v>((BVH8*)bvh,scene,4,1.0f,4,inf); }
     Builder* BVH8Triangle4iSceneBuilderSAH     (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAH<8,TriangleMesh,Triangle4i>((BVH8*)bvh,scene,4,1.0f,4,inf,mode,true); }
     Builder* BVH8QuantizedTriangle4iSceneBuilderSAH  (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAHQuantized<8,TriangleMesh,Triangle4i>((BVH8*)bvh,scene,4,1.0f,4,inf,mode); }
     Builder* BVH8QuantizedTriangle4SceneBuilderSAH  (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAHQuantized<8,TriangleMesh,Triangle4>((BVH8*)bvh,scene,4,1.0f,4,inf,mode); }
@@ -584,11 +801,14 @@ namespace embree
     Builder* BVH4Quad4iMeshBuilderSAH     (void* bvh, QuadMesh* mesh, size_t mode)     { return new BVHNBuilderSAH<4,QuadMesh,Quad4i>((BVH4*)bvh,mesh,4,1.0f,4,inf,mode); }
     Builder* BVH4Quad4vSceneBuilderSAH     (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAH<4,QuadMesh,Quad4v>((BVH4*)bvh,scene,4,1.0f,4,inf,mode); }
     Builder* BVH4Quad4iSceneBuilderSAH     (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAH<4,QuadMesh,Quad4i>((BVH4*)bvh,scene,4,1.0f,4,inf,mode,true); }
+    Builder* BVH4Quad4vSceneBuilderChunkedSAH     (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderChunkedSAH<4,QuadMesh,Quad4v>((BVH4*)bvh,scene,4,1.0f,4,inf); }
+    Builder* BVH4Quad4iSceneBuilderChunkedSAH     (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderChunkedSAH<4,QuadMesh,Quad4i>((BVH4*)bvh,scene,4,1.0f,4,inf); }
     Builder* BVH4QuantizedQuad4vSceneBuilderSAH     (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAHQuantized<4,QuadMesh,Quad4v>((BVH4*)bvh,scene,4,1.0f,4,inf,mode); }
     Builder* BVH4QuantizedQuad4iSceneBuilderSAH     (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAHQuantized<4,QuadMesh,Quad4i>((BVH4*)bvh,scene,4,1.0f,4,inf,mode); }
 
 #if defined(__AVX__)
     Builder* BVH8Quad4vSceneBuilderSAH     (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAH<8,QuadMesh,Quad4v>((BVH8*)bvh,scene,4,1.0f,4,inf,mode); }
+    Builder* BVH8Quad4vSceneBuilderChunkedSAH     (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderChunkedSAH<8,QuadMesh,Quad4v>((BVH8*)bvh,scene,4,1.0f,4,inf); }
     Builder* BVH8Quad4iSceneBuilderSAH     (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAH<8,QuadMesh,Quad4i>((BVH8*)bvh,scene,4,1.0f,4,inf,mode,true); }
     Builder* BVH8QuantizedQuad4vSceneBuilderSAH     (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAHQuantized<8,QuadMesh,Quad4v>((BVH8*)bvh,scene,4,1.0f,4,inf,mode); }
     Builder* BVH8QuantizedQuad4iSceneBuilderSAH     (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAHQuantized<8,QuadMesh,Quad4i>((BVH8*)bvh,scene,4,1.0f,4,inf,mode); }
@@ -624,6 +844,7 @@ namespace embree
 
 #if defined(EMBREE_GEOMETRY_INSTANCE)
     Builder* BVH4InstanceSceneBuilderSAH (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAH<4,Instance,InstancePrimitive>((BVH4*)bvh,scene,4,1.0f,1,1,mode); }
+    Builder* BVH4QuantizedInstanceSceneBuilderSAH (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAHQuantized<4,Instance,InstancePrimitive>((BVH4*)bvh,scene,4,1.0f,1,1,mode); }
 #if defined(__AVX__)
     Builder* BVH8InstanceSceneBuilderSAH (void* bvh, Scene* scene, size_t mode) { return new BVHNBuilderSAH<8,Instance,InstancePrimitive>((BVH8*)bvh,scene,8,1.0f,1,1,mode); }
 #endif
@@ -74,12 +74,12 @@ namespace embree
       const float splitFactor;
 
       BVHNBuilderFastSpatialSAH (BVH* bvh, Scene* scene, const size_t sahBlockSize, const float intCost, const size_t minLeafSize, const size_t maxLeafSize, const size_t mode)
-        : bvh(bvh), scene(scene), mesh(nullptr), prims0(scene->device,0), settings(sahBlockSize, minLeafSize, min(maxLeafSize,Primitive::max_size()*BVH::maxLeafBlocks), travCost, intCost, DEFAULT_SINGLE_THREAD_THRESHOLD),
+        : bvh(bvh), scene(scene), mesh(nullptr), prims0(scene,0), settings(sahBlockSize, minLeafSize, min(maxLeafSize,Primitive::max_size()*BVH::maxLeafBlocks), travCost, intCost, DEFAULT_SINGLE_THREAD_THRESHOLD),
           splitFactor(scene->device->max_spatial_split_replications) {}
 
       BVHNBuilderFastSpatialSAH (BVH* bvh, Mesh* mesh, const size_t sahBlockSize, const float intCost, const size_t minLeafSize, const size_t maxLeafSize, const size_t mode)
-        : bvh(bvh), scene(nullptr), mesh(mesh), prims0(bvh->device,0), settings(sahBlockSize, minLeafSize, min(maxLeafSize,Primitive::max_size()*BVH::maxLeafBlocks), travCost, intCost, DEFAULT_SINGLE_THREAD_THRESHOLD),
-          splitFactor(scene->device->max_spatial_split_replications) {}
+        : bvh(bvh), scene(nullptr), mesh(mesh), prims0(bvh->scene,0), settings(sahBlockSize, minLeafSize, min(maxLeafSize,Primitive::max_size()*BVH::maxLeafBlocks), travCost, intCost, DEFAULT_SINGLE_THREAD_THRESHOLD),
+          splitFactor(bvh->device->max_spatial_split_replications) {}
 
       // FIXME: shrink bvh->alloc in destructor here and in other builders too
 
@@ -100,8 +100,9 @@ namespace embree
 
         double t0 = bvh->preBuild(mesh ? "" : TOSTRING(isa) "::BVH" + toString(N) + "BuilderFastSpatialSAH");
 
-        /* create primref array */
-        const size_t numSplitPrimitives = max(numOriginalPrimitives,size_t(splitFactor*numOriginalPrimitives));
+        /* create primref array, replications for spatial splits are limited by the memory budget of the scene */
+        size_t numSplitPrimitives = max(numOriginalPrimitives,size_t(splitFactor*numOriginalPrimitives));
+        numSplitPrimitives = limitSplitPrimitivesToMemoryBudget<N,Primitive>(bvh->scene,numOriginalPrimitives,numSplitPrimitives);
         prims0.resize(numSplitPrimitives);
         PrimInfo pinfo = mesh ?
           createPrimRefArray(mesh,prims0,bvh->scene->progressInterface) :
@@ -121,6 +122,10 @@ namespace embree
         settings.branchingFactor = N;
         settings.maxDepth = BVH::maxBuildDepthLeaf;
 
+        /* use larger leaves to meet the memory budget of the scene */
+        GeneralBVHBuilder::Settings buildSettings = settings;
+        adaptLeafSizeToMemoryBudget<N,Primitive>(bvh->scene,numSplitPrimitives,0,buildSettings);
+
         NodeRef root = BVHBuilderBinnedFastSpatialSAH::build<NodeRef>(
           typename BVH::CreateAlloc(bvh),
           typename BVH::AlignedNode::Create2(),
@@ -130,7 +135,7 @@ namespace embree
           bvh->scene->progressInterface,
           prims0.data(),
           numSplitPrimitives,
-          pinfo,settings);
+          pinfo,buildSettings);
 
         bvh->set(root,LBBox3fa(pinfo.geomBounds),pinfo.size());
         bvh->layoutLargeNodes(size_t(pinfo.size()*0.005f));
@@ -17,6 +17,7 @@
 #include "bvh_builder_twolevel.h"
 #include "bvh_statistics.h"
 #include "../builders/bvh_builder_sah.h"
+#include "../builders/bvh_builder_morton.h"
 #include "../common/scene_line_segments.h"
 #include "../common/scene_triangle_mesh.h"
 #include "../common/scene_quad_mesh.h"
@@ -29,14 +30,33 @@
 #define SPLIT_MEMORY_RESERVE_FACTOR 1000
 #define SPLIT_MEMORY_RESERVE_SCALE 2
 #define SPLIT_MIN_EXT_SPACE 1000
+#define CLUSTER_SIZE 4096
 
 namespace embree
 {
   namespace isa
   {
+    /*! node creation that counts the created nodes */
+    template<typename NodeRef, typename CreateNode>
+    struct CreateCountedNode
+    {
+      __forceinline CreateCountedNode (std::atomic<size_t>& numNodes)
+        : numNodes(numNodes) {}
+
+      template<typename BuildRecord>
+      __forceinline NodeRef operator() (BuildRecord* children, const size_t num, const FastAllocator::CachedAllocator& alloc) const
+      {
+        numNodes++;
+        return CreateNode()(children,num,alloc);
+      }
+
+      std::atomic<size_t>& numNodes;
+    };
+
     template<int N, typename Mesh>
     BVHNBuilderTwoLevel<N,Mesh>::BVHNBuilderTwoLevel (BVH* bvh, Scene* scene, const createMeshAccelTy createMeshAccel, const size_t singleThreadThreshold)
-      : bvh(bvh), objects(bvh->objects), scene(scene), createMeshAccel(createMeshAccel), refs(scene->device,0), prims(scene->device,0), singleThreadThreshold(singleThreadThreshold) {}
+      : bvh(bvh), objects(bvh->objects), scene(scene), createMeshAccel(createMeshAccel), refs(scene->device,0), prims(scene->device,0), clusterRefs(scene->device,0), singleThreadThreshold(singleThreadThreshold),
+        recordTopLevel(false), topLevelValid(false), numTopLeaves(0), topNumRefs(0), topDeadNodes(0) {}
     
     template<int N, typename Mesh>
     BVHNBuilderTwoLevel<N,Mesh>::~BVHNBuilderTwoLevel () {
@@ -58,19 +78,19 @@ namespace embree
               delete objects[i]; objects[i] = nullptr;
             }
           });
+        topLevelValid = false;
       }
       
 #if PROFILE
       while(1) 
 #endif
       {
-      /* reset memory allocator */
-      bvh->alloc.reset();
-      
       /* skip build for empty scene */
       const size_t numPrimitives = scene->getNumPrimitives<Mesh,false>();
 
       if (numPrimitives == 0) {
+        bvh->alloc.reset();
+        topLevelValid = false;
         prims.resize(0);
         bvh->set(BVH::emptyNode,empty,0);
         return;
@@ -145,13 +165,24 @@ namespace embree
 #if PROFILE
       double d0 = getSeconds();
 #endif
+      double t1 = getSeconds();
+      std::atomic<size_t> numNodes(0);
+
       /* fast path for single geometry scenes */
       if (nextRef == 1) { 
+        bvh->alloc.reset();
         bvh->set(refs[0].node,LBBox3fa(refs[0].bounds()),numPrimitives);
+        topLevelValid = false;
       }
 
-      else
-      {     
+      /* refit the top level BVH of the last build if possible, otherwise rebuild it */
+      else if (!refit_toplevel(numPrimitives,numNodes))
+      {
+        /* reset memory allocator */
+        bvh->alloc.reset();
+        recordTopLevel = scene->device->twolevel_rebuild_threshold > 0.0f;
+        numTopLeaves = 0;
+
         /* open all large nodes */
         refs.resize(nextRef);
 
@@ -209,37 +240,41 @@ namespace embree
           else
           {
             /* settings for BVH build */
-            GeneralBVHBuilder::Settings settings;
-            settings.branchingFactor = N;
-            settings.maxDepth = BVH::maxBuildDepthLeaf;
-            settings.logBlockSize = bsr(N);
-            settings.minLeafSize = 1;
-            settings.maxLeafSize = 1;
-            settings.travCost = 1.0f;
-            settings.intCost = 1.0f;
-            settings.singleThreadThreshold = singleThreadThreshold;
+            const GeneralBVHBuilder::Settings settings = toplevel_settings();
       
 #if ENABLE_DIRECT_SAH_MERGE_BUILDER
-            refs.resize(extSize); 
+            /* huge numbers of geometries get built in parallel clusters */
+            if (refs.size() >= scene->device->twolevel_cluster_threshold)
+            {
+              NodeRef root = build_clusters(pinfo,settings,numNodes);
+              bvh->set(root,LBBox3fa(pinfo.geomBounds),numPrimitives);
+            }
+            else
+            {
+              refs.resize(extSize); 
+              if (recordTopLevel) topLeaves.resize(extSize);
          
-            NodeRef root = BVHBuilderBinnedOpenMergeSAH::build<NodeRef,BuildRef>(
-              typename BVH::CreateAlloc(bvh),
-              typename BVH::AlignedNode::Create2(),
-              typename BVH::AlignedNode::Set2(),
+              NodeRef root = BVHBuilderBinnedOpenMergeSAH::build<NodeRef,BuildRef>(
+                typename BVH::CreateAlloc(bvh),
+                CreateCountedNode<NodeRef,typename BVH::AlignedNode::Create2>(numNodes),
+                typename BVH::AlignedNode::Set2(),
               
-              [&] (const BuildRef* refs, const range<size_t>& range, const FastAllocator::CachedAllocator& alloc) -> NodeRef  {
-                assert(range.size() == 1);
-                return (NodeRef) refs[range.begin()].node;
-              },
-              [&] (BuildRef &bref, BuildRef *refs) -> size_t { 
-                return openBuildRef(bref,refs);
-              },              
-              [&] (size_t dn) { bvh->scene->progressMonitor(0); },
-              refs.data(),extSize,pinfo,settings);
+                [&] (const BuildRef* refs, const range<size_t>& range, const FastAllocator::CachedAllocator& alloc) -> NodeRef  {
+                  assert(range.size() == 1);
+                  return createTopLevelLeaf(refs[range.begin()]);
+                },
+                [&] (BuildRef &bref, BuildRef *refs) -> size_t { 
+                  return openBuildRef(bref,refs);
+                },              
+                [&] (size_t dn) { bvh->scene->progressMonitor(0); },
+                refs.data(),extSize,pinfo,settings);
+
+              bvh->set(root,LBBox3fa(pinfo.geomBounds),numPrimitives);
+            }
 #else
             NodeRef root = BVHBuilderBinnedSAH::build<NodeRef>(
               typename BVH::CreateAlloc(bvh),
-              typename BVH::AlignedNode::Create2(),
+              CreateCountedNode<NodeRef,typename BVH::AlignedNode::Create2>(numNodes),
               typename BVH::AlignedNode::Set2(),
               
               [&] (const PrimRef* pims, const range<size_t>& range, const FastAllocator::CachedAllocator& alloc) -> NodeRef {
@@ -248,17 +283,21 @@ namespace embree
               },
               [&] (size_t dn) { bvh->scene->progressMonitor(0); },
               prims.data(),pinfo,settings);
-#endif
 
-            
             bvh->set(root,LBBox3fa(pinfo.geomBounds),numPrimitives);
+#endif
           }
         }
 #if defined(TASKING_TBB) && defined(__AVX512ER__) && USE_TASK_ARENA // KNL
           );
 #endif
 
+        /* remember the top level BVH to refit it in the next build */
+        if (recordTopLevel) record_toplevel();
+        else topLevelValid = false;
       }  
+      bvh->device->addBuildPhaseTime(Device::BUILD_PHASE_TOPLEVEL,getSeconds()-t1);
+      bvh->device->addBuildTopLevelNodes(numNodes);
         
       bvh->alloc.cleanup();
       bvh->postBuild(t0);
@@ -270,10 +309,369 @@ namespace embree
 
     }
     
+    template<int N, typename Mesh>
+    typename BVHNBuilderTwoLevel<N,Mesh>::NodeRef BVHNBuilderTwoLevel<N,Mesh>::build_clusters(const PrimInfo& pinfo, const GeneralBVHBuilder::Settings& settings, std::atomic<size_t>& numNodes)
+    {
+      const size_t numRefs = refs.size();
+
+      /* sort references along the morton curve */
+      avector<BVHBuilderMorton::BuildPrim> morton(numRefs);
+      {
+        avector<BVHBuilderMorton::BuildPrim> morton_tmp(numRefs);
+        const BVHBuilderMorton::MortonCodeMapping mapping(pinfo.centBounds);
+        parallel_for(size_t(0), numRefs, size_t(1024), [&] (const range<size_t>& r) {
+            BVHBuilderMorton::MortonCodeGenerator generator(mapping,&morton[r.begin()]);
+            for (size_t i=r.begin(); i<r.end(); i++)
+              generator(refs[i].bounds(),unsigned(i));
+          });
+        radix_sort_u64(morton.data(),morton_tmp.data(),numRefs,singleThreadThreshold);
+      }
+
+      /* each cluster of consecutive references gets its own space to open references into */
+      const size_t numClusters = (numRefs+CLUSTER_SIZE-1)/CLUSTER_SIZE;
+      const size_t clusterExtSize = CLUSTER_SIZE*SPLIT_MEMORY_RESERVE_SCALE;
+      clusterRefs.resize(numClusters*clusterExtSize);
+      prims.resize(numClusters);
+      if (recordTopLevel) topLeaves.resize(numClusters*clusterExtSize);
+
+      /* build the BVHs of all clusters in parallel */
+      parallel_for(size_t(0), numClusters, [&] (const range<size_t>& r)
+      {
+        for (size_t c=r.begin(); c<r.end(); c++)
+        {
+          const size_t begin = c*CLUSTER_SIZE;
+          const size_t end = min(begin+CLUSTER_SIZE,numRefs);
+          BuildRef* crefs = &clusterRefs[c*clusterExtSize];
+
+          PrimInfo cinfo(empty);
+          for (size_t i=begin; i<end; i++) {
+            crefs[i-begin] = refs[morton[i].index];
+            cinfo.add_center2(crefs[i-begin]);
+          }
+
+          NodeRef root = BVHBuilderBinnedOpenMergeSAH::build<NodeRef,BuildRef>(
+            typename BVH::CreateAlloc(bvh),
+            CreateCountedNode<NodeRef,typename BVH::AlignedNode::Create2>(numNodes),
+            typename BVH::AlignedNode::Set2(),
+
+            [&] (const BuildRef* refs, const range<size_t>& range, const FastAllocator::CachedAllocator& alloc) -> NodeRef  {
+              assert(range.size() == 1);
+              return createTopLevelLeaf(refs[range.begin()]);
+            },
+            [&] (BuildRef &bref, BuildRef *refs) -> size_t {
+              return openBuildRef(bref,refs);
+            },
+            [&] (size_t dn) { bvh->scene->progressMonitor(0); },
+            crefs,clusterExtSize,cinfo,settings);
+
+          prims[c] = PrimRef(cinfo.geomBounds,(size_t)root);
+        }
+      });
+
+      /* merge the cluster BVHs */
+      PrimInfo rinfo(empty);
+      for (size_t c=0; c<numClusters; c++)
+        rinfo.add_center2(prims[c]);
+
+      return BVHBuilderBinnedSAH::build<NodeRef>(
+        typename BVH::CreateAlloc(bvh),
+        CreateCountedNode<NodeRef,typename BVH::AlignedNode::Create2>(numNodes),
+        typename BVH::AlignedNode::Set2(),
+
+        [&] (const PrimRef* prims, const range<size_t>& range, const FastAllocator::CachedAllocator& alloc) -> NodeRef {
+          assert(range.size() == 1);
+          return (NodeRef) prims[range.begin()].ID();
+        },
+        [&] (size_t dn) { bvh->scene->progressMonitor(0); },
+        prims.data(),rinfo,settings);
+    }
+
+    template<int N, typename Mesh>
+    GeneralBVHBuilder::Settings BVHNBuilderTwoLevel<N,Mesh>::toplevel_settings() const
+    {
+      GeneralBVHBuilder::Settings settings;
+      settings.branchingFactor = N;
+      settings.maxDepth = BVH::maxBuildDepthLeaf;
+      settings.logBlockSize = bsr(N);
+      settings.minLeafSize = 1;
+      settings.maxLeafSize = 1;
+      settings.travCost = 1.0f;
+      settings.intCost = 1.0f;
+      settings.singleThreadThreshold = singleThreadThreshold;
+      return settings;
+    }
+
+    template<int N, typename Mesh>
+    void BVHNBuilderTwoLevel<N,Mesh>::record_toplevel()
+    {
+      topLevelValid = false;
+      topLeaves.resize(numTopLeaves);
+      if (bvh->root == BVH::emptyNode || bvh->root.isLeaf())
+        return;
+
+      /* the leaves get identified by their references when walking the top level BVH */
+      std::vector<std::pair<size_t,unsigned int>> leafIDs(topLeaves.size());
+      topGeometryState.assign(objects.size(),TOPLEVEL_GEOMETRY_NONE);
+      topGeometryRoots.resize(objects.size());
+      for (size_t i=0; i<topLeaves.size(); i++)
+      {
+        const TopLevelLeaf& leaf = topLeaves[i];
+        leafIDs[i] = std::make_pair(size_t(leaf.node),(unsigned int)i);
+        topGeometryRoots[leaf.geomID] = objects[leaf.geomID]->root;
+        topGeometryState[leaf.geomID] = leaf.node == objects[leaf.geomID]->root ? TOPLEVEL_GEOMETRY_ROOT : TOPLEVEL_GEOMETRY_OPENED;
+      }
+      std::sort(leafIDs.begin(),leafIDs.end());
+
+      float area = 0.0f;
+      topNodes.clear();
+      record_toplevel_node(bvh->root,leafIDs,topNodes,area);
+      topNumRefs = nextRef;
+      topDeadNodes = 0;
+      topLevelValid = true;
+    }
+
+    template<int N, typename Mesh>
+    unsigned int BVHNBuilderTwoLevel<N,Mesh>::record_toplevel_node(NodeRef ref, const std::vector<std::pair<size_t,unsigned int>>& leafIDs, std::vector<TopLevelNode>& nodes, float& area)
+    {
+      const unsigned int nodeID = (unsigned int) nodes.size();
+      nodes.push_back(TopLevelNode());
+
+      AlignedNode* node = ref.alignedNode();
+      TopLevelNode tnode;
+      tnode.ref = ref;
+      float childArea = 0.0f;
+      for (size_t i=0; i<N; i++)
+      {
+        const NodeRef child = node->child(i);
+        if (child == BVH::emptyNode) {
+          tnode.children[i] = TopLevelNode::EMPTY;
+          continue;
+        }
+        childArea += halfArea(node->bounds(i));
+
+        auto leaf = std::lower_bound(leafIDs.begin(),leafIDs.end(),std::make_pair(size_t(child),0u));
+        if (leaf != leafIDs.end() && leaf->first == size_t(child))
+          tnode.children[i] = TopLevelNode::LEAF | leaf->second;
+        else
+          tnode.children[i] = record_toplevel_node(child,leafIDs,nodes,childArea);
+      }
+
+      /* SAH cost with unit traversal and intersection cost relative to the node */
+      const float nodeArea = halfArea(node->bounds());
+      tnode.buildSAH = tnode.refitSAH = nodeArea > 0.0f ? childArea/nodeArea : 0.0f;
+      nodes[nodeID] = tnode;
+      area += childArea;
+      return nodeID;
+    }
+
+    template<int N, typename Mesh>
+    bool BVHNBuilderTwoLevel<N,Mesh>::can_refit_toplevel()
+    {
+      if (!topLevelValid || scene->device->twolevel_rebuild_threshold <= 0.0f)
+        return false;
+
+      /* the memory of replaced subtrees gets reclaimed by a full build */
+      if (topDeadNodes > topNodes.size())
+        return false;
+
+      /* the same geometries have to be referenced, subtrees of modified geometries are gone */
+      if (size_t(nextRef) != topNumRefs)
+        return false;
+
+      for (size_t i=0; i<topNumRefs; i++)
+      {
+        const unsigned int geomID = refs[i].geomID();
+        if (geomID >= topGeometryState.size() || topGeometryState[geomID] == TOPLEVEL_GEOMETRY_NONE)
+          return false;
+
+        if (topGeometryState[geomID] == TOPLEVEL_GEOMETRY_OPENED)
+        {
+          Mesh* mesh = scene->getSafe<Mesh>(geomID);
+          if (mesh->isModified() || objects[geomID]->root != topGeometryRoots[geomID])
+            return false;
+        }
+      }
+      return true;
+    }
+
+    template<int N, typename Mesh>
+    BBox3fa BVHNBuilderTwoLevel<N,Mesh>::refit_toplevel_node(const unsigned int nodeID, float& area, const size_t depth)
+    {
+      TopLevelNode& tnode = topNodes[nodeID];
+      AlignedNode* node = tnode.ref.alignedNode();
+
+      BBox3fa bounds[N];
+      float areas[N];
+      auto refitChild = [&] (size_t i)
+      {
+        bounds[i] = empty;
+        areas[i] = 0.0f;
+        const unsigned int child = tnode.children[i];
+        if (child == TopLevelNode::EMPTY)
+          return;
+
+        if (child & TopLevelNode::LEAF)
+        {
+          /* only leaves that reference the root of a geometry BVH can change */
+          TopLevelLeaf& leaf = topLeaves[child & ~TopLevelNode::LEAF];
+          if (topGeometryState[leaf.geomID] == TOPLEVEL_GEOMETRY_ROOT) {
+            leaf.node = node->child(i) = objects[leaf.geomID]->root;
+            bounds[i] = objects[leaf.geomID]->getBounds();
+          }
+          else
+            bounds[i] = node->bounds(i);
+        }
+        else
+          bounds[i] = refit_toplevel_node(child,areas[i],depth+1);
+      };
+
+      /* refit the upper levels in parallel */
+      if (depth < 3)
+        parallel_for(size_t(0), size_t(N), [&] (const range<size_t>& r) {
+            for (size_t i=r.begin(); i<r.end(); i++)
+              refitChild(i);
+          });
+      else
+        for (size_t i=0; i<N; i++)
+          refitChild(i);
+
+      BBox3fa nodeBounds = empty;
+      float childArea = 0.0f;
+      for (size_t i=0; i<N; i++)
+      {
+        if (tnode.children[i] == TopLevelNode::EMPTY) continue;
+        node->setBounds(i,bounds[i]);
+        nodeBounds.extend(bounds[i]);
+        childArea += areas[i] + halfArea(bounds[i]);
+      }
+
+      const float nodeArea = halfArea(nodeBounds);
+      tnode.refitSAH = nodeArea > 0.0f ? childArea/nodeArea : 0.0f;
+      area += childArea;
+      return nodeBounds;
+    }
+
+    template<int N, typename Mesh>
+    void BVHNBuilderTwoLevel<N,Mesh>::gather_toplevel_leaves(const unsigned int nodeID, size_t& numOldNodes)
+    {
+      const TopLevelNode& tnode = topNodes[nodeID];
+      const AlignedNode* node = tnode.ref.alignedNode();
+      numOldNodes++;
+      for (size_t i=0; i<N; i++)
+      {
+        const unsigned int child = tnode.children[i];
+        if (child == TopLevelNode::EMPTY) continue;
+        if (child & TopLevelNode::LEAF)
+          prims.push_back(PrimRef(node->bounds(i),size_t(child & ~TopLevelNode::LEAF)));
+        else
+          gather_toplevel_leaves(child,numOldNodes);
+      }
+    }
+
+    template<int N, typename Mesh>
+    bool BVHNBuilderTwoLevel<N,Mesh>::has_degraded_children(const unsigned int nodeID, const float threshold) const
+    {
+      for (size_t i=0; i<N; i++) {
+        const unsigned int child = topNodes[nodeID].children[i];
+        if (child == TopLevelNode::EMPTY || (child & TopLevelNode::LEAF)) continue;
+        if (topNodes[child].degraded(threshold)) return true;
+      }
+      return false;
+    }
+
+    template<int N, typename Mesh>
+    unsigned int BVHNBuilderTwoLevel<N,Mesh>::restructure_toplevel_node(const unsigned int nodeID, NodeRef& ref, std::vector<TopLevelNode>& nodes, std::atomic<size_t>& numNodes)
+    {
+      const float threshold = scene->device->twolevel_rebuild_threshold;
+      const TopLevelNode& tnode = topNodes[nodeID];
+
+      /* rebuild the subtree when its own split decisions got worse and not just the ones of its children */
+      if (tnode.degraded(threshold) && !has_degraded_children(nodeID,threshold))
+      {
+        size_t numOldNodes = 0;
+        prims.clear();
+        gather_toplevel_leaves(nodeID,numOldNodes);
+        topDeadNodes += numOldNodes;
+
+        PrimInfo pinfo(empty);
+        for (size_t i=0; i<prims.size(); i++)
+          pinfo.add_center2(prims[i]);
+
+        ref = BVHBuilderBinnedSAH::build<NodeRef>(
+          typename BVH::CreateAlloc(bvh),
+          CreateCountedNode<NodeRef,typename BVH::AlignedNode::Create2>(numNodes),
+          typename BVH::AlignedNode::Set2(),
+
+          [&] (const PrimRef* prims, const range<size_t>& range, const FastAllocator::CachedAllocator& alloc) -> NodeRef {
+            assert(range.size() == 1);
+            return topLeaves[prims[range.begin()].ID()].node;
+          },
+          [&] (size_t dn) { bvh->scene->progressMonitor(0); },
+          prims.data(),pinfo,toplevel_settings());
+
+        std::vector<std::pair<size_t,unsigned int>> leafIDs(prims.size());
+        for (size_t i=0; i<prims.size(); i++) {
+          const unsigned int leafID = (unsigned int) prims[i].ID();
+          leafIDs[i] = std::make_pair(size_t(topLeaves[leafID].node),leafID);
+        }
+        std::sort(leafIDs.begin(),leafIDs.end());
+
+        float area = 0.0f;
+        return record_toplevel_node(ref,leafIDs,nodes,area);
+      }
+
+      /* otherwise keep the node and continue with its children */
+      const unsigned int newID = (unsigned int) nodes.size();
+      nodes.push_back(tnode);
+      AlignedNode* node = ref.alignedNode();
+      for (size_t i=0; i<N; i++)
+      {
+        const unsigned int child = topNodes[nodeID].children[i];
+        if (child == TopLevelNode::EMPTY || (child & TopLevelNode::LEAF)) continue;
+        const unsigned int newChild = restructure_toplevel_node(child,node->child(i),nodes,numNodes);
+        nodes[newID].children[i] = newChild;
+      }
+      return newID;
+    }
+
+    template<int N, typename Mesh>
+    bool BVHNBuilderTwoLevel<N,Mesh>::refit_toplevel(const size_t numPrimitives, std::atomic<size_t>& numNodes)
+    {
+      if (!can_refit_toplevel())
+        return false;
+
+      float area = 0.0f;
+      const BBox3fa bounds = refit_toplevel_node(0,area);
+
+      /* degraded split decisions at the root require a full build */
+      const float threshold = scene->device->twolevel_rebuild_threshold;
+      if (topNodes[0].degraded(threshold) && !has_degraded_children(0,threshold)) {
+        topLevelValid = false;
+        return false;
+      }
+
+      /* rebuild degraded subtrees */
+      bool restructure = false;
+      for (size_t i=0; i<topNodes.size(); i++)
+        restructure |= topNodes[i].degraded(threshold);
+
+      if (restructure)
+      {
+        std::vector<TopLevelNode> nodes;
+        nodes.reserve(topNodes.size());
+        restructure_toplevel_node(0,bvh->root,nodes,numNodes);
+        topNodes.swap(nodes);
+      }
+
+      bvh->set(bvh->root,LBBox3fa(bounds),numPrimitives);
+      return true;
+    }
+
     template<int N, typename Mesh>
     void BVHNBuilderTwoLevel<N,Mesh>::deleteGeometry(size_t geomID)
     {
       if (geomID >= objects.size()) return;
+      topLevelValid = false;
       builders[geomID].clear();
       delete objects [geomID]; objects [geomID] = nullptr;
     }
@@ -288,6 +686,8 @@ namespace embree
 	if (builders[i].builder) builders[i].builder->clear();
 
       refs.clear();
+      clusterRefs.clear();
+      topLevelValid = false;
     }
 
     template<int N, typename Mesh>
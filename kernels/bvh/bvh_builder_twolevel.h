@@ -19,6 +19,7 @@
 #include "bvh.h"
 #include "../common/primref.h"
 #include "../builders/priminfo.h"
+#include "../builders/bvh_builder_sah.h"
 
 namespace embree
 {
@@ -100,6 +101,51 @@ namespace embree
         return n;        
       }
       
+      /*! leaf of the top level BVH, references the BVH of a geometry or one of its subtrees */
+      struct TopLevelLeaf
+      {
+        __forceinline TopLevelLeaf () {}
+
+        __forceinline TopLevelLeaf (NodeRef node, unsigned int geomID)
+          : node(node), geomID(geomID) {}
+
+      public:
+        NodeRef node;
+        unsigned int geomID;
+      };
+
+      /*! inner node of the top level BVH as recorded for refitting it in later builds */
+      struct TopLevelNode
+      {
+        static const unsigned int EMPTY = 0xFFFFFFFF; //!< marks empty child slots
+        static const unsigned int LEAF  = 0x80000000; //!< marks child slots that reference a leaf
+
+        __forceinline bool degraded(float threshold) const {
+          return refitSAH > threshold*buildSAH;
+        }
+
+      public:
+        NodeRef ref;               //!< node of the top level BVH
+        unsigned int children[N];  //!< indices of the inner child nodes or leaves
+        float buildSAH;            //!< relative SAH cost of the subtree after its last build
+        float refitSAH;            //!< relative SAH cost of the subtree after the last refit
+      };
+
+      /*! how the recorded top level BVH references some geometry */
+      enum TopLevelGeometryState
+      {
+        TOPLEVEL_GEOMETRY_NONE   = 0,  //!< geometry is not referenced
+        TOPLEVEL_GEOMETRY_ROOT   = 1,  //!< root of the geometry BVH is referenced by a single leaf
+        TOPLEVEL_GEOMETRY_OPENED = 2   //!< subtrees of the geometry BVH are referenced
+      };
+
+      __forceinline NodeRef createTopLevelLeaf(const BuildRef& ref)
+      {
+        if (recordTopLevel)
+          topLeaves[numTopLeaves++] = TopLevelLeaf(ref.node,ref.geomID());
+        return ref.node;
+      }
+
       /*! Constructor. */
       BVHNBuilderTwoLevel (BVH* bvh, Scene* scene, const createMeshAccelTy createMeshAcce, const size_t singleThreadThreshold = DEFAULT_SINGLE_THREAD_THRESHOLD);
       
@@ -113,6 +159,25 @@ namespace embree
 
       void open_sequential(const size_t extSize);
 
+      /*! builds the top level BVH over Morton ordered clusters of references in parallel */
+      NodeRef build_clusters(const PrimInfo& pinfo, const GeneralBVHBuilder::Settings& settings, std::atomic<size_t>& numNodes);
+
+      /*! refits the top level BVH of the last build and rebuilds its
+       *  degraded subtrees, returns false if a full build is required */
+      bool refit_toplevel(const size_t numPrimitives, std::atomic<size_t>& numNodes);
+
+      /*! records the top level BVH after a full build */
+      void record_toplevel();
+
+    private:
+      GeneralBVHBuilder::Settings toplevel_settings() const;
+      bool can_refit_toplevel();
+      bool has_degraded_children(const unsigned int nodeID, const float threshold) const;
+      BBox3fa refit_toplevel_node(const unsigned int nodeID, float& area, const size_t depth = 0);
+      unsigned int restructure_toplevel_node(const unsigned int nodeID, NodeRef& ref, std::vector<TopLevelNode>& nodes, std::atomic<size_t>& numNodes);
+      unsigned int record_toplevel_node(NodeRef ref, const std::vector<std::pair<size_t,unsigned int>>& leafIDs, std::vector<TopLevelNode>& nodes, float& area);
+      void gather_toplevel_leaves(const unsigned int nodeID, size_t& numOldNodes);
+
     public:
       
       struct BuilderState
@@ -143,9 +208,21 @@ namespace embree
       
       mvector<BuildRef> refs;
       mvector<PrimRef> prims;
+      mvector<BuildRef> clusterRefs;
       std::atomic<int> nextRef;
       const size_t singleThreadThreshold;
 
+      /* top level BVH of the last build, gets refitted instead of rebuilt when possible */
+      bool recordTopLevel;                       //!< records the top level BVH during the build
+      bool topLevelValid;                        //!< recorded top level BVH matches the current BVH
+      std::vector<TopLevelLeaf> topLeaves;       //!< leaves of the top level BVH
+      std::atomic<size_t> numTopLeaves;          //!< number of leaves recorded during the build
+      std::vector<TopLevelNode> topNodes;        //!< inner nodes of the top level BVH, root first
+      std::vector<char> topGeometryState;        //!< TopLevelGeometryState of each geometry
+      std::vector<NodeRef> topGeometryRoots;     //!< root of each geometry BVH at recording time
+      size_t topNumRefs;                         //!< number of build references at recording time
+      size_t topDeadNodes;                       //!< number of nodes of replaced subtrees
+
       typedef mvector<BuildRef> bvector;
 
     };
@@ -0,0 +1,275 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "bvh_collider.h"
+#include "../common/scene.h"
+#include "../common/scene_triangle_mesh.h"
+#include "../common/scene_quad_mesh.h"
+#include "../common/scene_user_geometry.h"
+#include "../../common/algorithms/parallel_for.h"
+
+namespace embree
+{
+  /*! primitive of a leaf together with its bounds over all time steps */
+  struct CollidePrim
+  {
+    BBox3fa bounds;
+    unsigned int geomID;
+    unsigned int primID;
+  };
+
+  /*! maximal number of primitives stored in a leaf */
+  static const size_t maxCollideLeafPrims = 64;
+
+  /*! number of collisions buffered before invoking the user callback */
+  static const size_t collisionBufferSize = 64;
+
+  /*! returns the bounds of a primitive over all time steps, or empty bounds for unsupported geometry types */
+  static BBox3fa collidePrimBounds(Scene* scene, unsigned int geomID, unsigned int primID)
+  {
+    Geometry* geometry = scene->get(geomID);
+    BBox3fa bounds = empty;
+    switch (geometry->getType())
+    {
+    case Geometry::GTY_TRIANGLE_MESH: {
+      TriangleMesh* mesh = (TriangleMesh*) geometry;
+      for (size_t t=0; t<mesh->numTimeSteps; t++) bounds.extend(mesh->bounds(primID,t));
+      break;
+    }
+    case Geometry::GTY_QUAD_MESH: {
+      QuadMesh* mesh = (QuadMesh*) geometry;
+      for (size_t t=0; t<mesh->numTimeSteps; t++) bounds.extend(mesh->bounds(primID,t));
+      break;
+    }
+    case Geometry::GTY_USER_GEOMETRY: {
+      AccelSet* set = (AccelSet*) geometry;
+      for (size_t t=0; t<set->numTimeSteps; t++) bounds.extend(set->bounds(primID,t));
+      break;
+    }
+    default:
+      break;
+    }
+    return bounds;
+  }
+
+  /*! returns the i'th child of a node and its bounds over all time steps */
+  template<int N>
+  static __forceinline typename BVHN<N>::NodeRef collideChild(typename BVHN<N>::NodeRef node, size_t i, BBox3fa& bounds)
+  {
+    typedef BVHN<N> BVH;
+    bounds = empty;
+    if (node.isAlignedNode()) {
+      bounds = node.alignedNode()->bounds(i);
+      return node.alignedNode()->child(i);
+    }
+    else if (node.isAlignedNodeMB()) {
+      bounds = node.alignedNodeMB()->bounds(i);
+      return node.alignedNodeMB()->child(i);
+    }
+    else if (node.isAlignedNodeMB4D()) {
+      bounds = node.alignedNodeMB4D()->bounds(i);
+      return node.alignedNodeMB4D()->child(i);
+    }
+    else if (node.isQuantizedNode()) {
+      bounds = node.quantizedNode()->bounds(i);
+      return node.quantizedNode()->child(i);
+    }
+    /* unaligned nodes only store curves, which are not supported by collision queries */
+    return BVH::emptyNode;
+  }
+
+  /*! gathers the supported primitives of a leaf, returns their number */
+  template<int N>
+  static size_t collideGatherLeaf(BVHN<N>* bvh, typename BVHN<N>::NodeRef node, CollidePrim* prims)
+  {
+    size_t numPrims = 0;
+    size_t num; const char* prim = node.leaf(num);
+    for (size_t b=0; b<num; b++)
+    {
+      const size_t numSlots = bvh->primTy->sizeTotal(prim);
+      for (size_t i=0; i<numSlots; i++)
+      {
+        unsigned int geomID, primID;
+        if (!bvh->primTy->getIDs(prim,i,geomID,primID)) continue;
+        const BBox3fa bounds = collidePrimBounds(bvh->scene,geomID,primID);
+        if (bounds.empty()) continue;
+        assert(numPrims < maxCollideLeafPrims);
+        prims[numPrims++] = { bounds, geomID, primID };
+      }
+      prim += bvh->primTy->getBytes(prim);
+    }
+    return numPrims;
+  }
+
+  /*! buffers collisions and passes them in batches to the user callback */
+  struct CollisionBuffer
+  {
+    CollisionBuffer (const CollideContext* context)
+      : context(context), num(0) {}
+
+    ~CollisionBuffer () {
+      flush();
+    }
+
+    __forceinline void add(const CollidePrim& prim0, const CollidePrim& prim1)
+    {
+      collisions[num++] = { prim0.geomID, prim0.primID, prim1.geomID, prim1.primID };
+      if (num == collisionBufferSize) flush();
+    }
+
+    __forceinline void flush() {
+      context->report(collisions,num);
+      num = 0;
+    }
+
+  private:
+    const CollideContext* context;
+    size_t num;
+    RTCCollision collisions[collisionBufferSize];
+  };
+
+  template<int N0, int N1>
+  void BVHNCollider<N0,N1>::collide(BVH0* bvh0, BVH1* bvh1, const CollideContext* context)
+  {
+    if (bvh0->root == BVH0::emptyNode || bvh1->root == BVH1::emptyNode) return;
+    BVHNCollider collider(bvh0,bvh1,context);
+    collider.collide(bvh0->root,bvh0->getBounds(),bvh1->root,bvh1->getBounds(),0);
+  }
+
+  template<int N0, int N1>
+  void BVHNCollider<N0,N1>::collide(NodeRef0 ref0, const BBox3fa& bounds0, NodeRef1 ref1, const BBox3fa& bounds1, size_t depth)
+  {
+    if (disjoint(bounds0,bounds1)) return;
+
+    if (ref0.isLeaf() && ref1.isLeaf()) {
+      collideLeaves(ref0,ref1);
+      return;
+    }
+
+    /* descend into the larger of both nodes */
+    if (!ref0.isLeaf() && (ref1.isLeaf() || halfArea(bounds0) >= halfArea(bounds1)))
+    {
+      NodeRef0 children[N0]; BBox3fa childBounds[N0]; size_t numChildren = 0;
+      for (size_t i=0; i<N0; i++) {
+        const NodeRef0 child = collideChild<N0>(ref0,i,childBounds[numChildren]);
+        if (child == BVH0::emptyNode || disjoint(childBounds[numChildren],bounds1)) continue;
+        children[numChildren++] = child;
+      }
+      if (depth < parallelDepth)
+        parallel_for(numChildren, [&] (size_t i) { collide(children[i],childBounds[i],ref1,bounds1,depth+1); });
+      else
+        for (size_t i=0; i<numChildren; i++) collide(children[i],childBounds[i],ref1,bounds1,depth+1);
+    }
+    else
+    {
+      NodeRef1 children[N1]; BBox3fa childBounds[N1]; size_t numChildren = 0;
+      for (size_t i=0; i<N1; i++) {
+        const NodeRef1 child = collideChild<N1>(ref1,i,childBounds[numChildren]);
+        if (child == BVH1::emptyNode || disjoint(bounds0,childBounds[numChildren])) continue;
+        children[numChildren++] = child;
+      }
+      if (depth < parallelDepth)
+        parallel_for(numChildren, [&] (size_t i) { collide(ref0,bounds0,children[i],childBounds[i],depth+1); });
+      else
+        for (size_t i=0; i<numChildren; i++) collide(ref0,bounds0,children[i],childBounds[i],depth+1);
+    }
+  }
+
+  template<int N0, int N1>
+  void BVHNCollider<N0,N1>::collideLeaves(NodeRef0 ref0, NodeRef1 ref1)
+  {
+    CollidePrim prims0[maxCollideLeafPrims];
+    CollidePrim prims1[maxCollideLeafPrims];
+    const size_t num0 = collideGatherLeaf<N0>(bvh0,ref0,prims0);
+    const size_t num1 = collideGatherLeaf<N1>(bvh1,ref1,prims1);
+
+    /* spatial splits may reference a primitive in multiple leaves, thus skip self pairs when colliding a BVH with itself */
+    const bool self = (void*)bvh0 == (void*)bvh1;
+
+    CollisionBuffer buffer(context);
+    for (size_t i=0; i<num0; i++)
+      for (size_t j=0; j<num1; j++)
+      {
+        if (self && prims0[i].geomID == prims1[j].geomID && prims0[i].primID == prims1[j].primID) continue;
+        if (conjoint(prims0[i].bounds,prims1[j].bounds))
+          buffer.add(prims0[i],prims1[j]);
+      }
+  }
+
+  template<int N>
+  void BVHNSelfCollider<N>::collide(BVHN<N>* bvh, const CollideContext* context)
+  {
+    if (bvh->root == BVHN<N>::emptyNode) return;
+    BVHNSelfCollider collider(bvh,context);
+    collider.collideSelf(bvh->root,0);
+  }
+
+  template<int N>
+  void BVHNSelfCollider<N>::collideSelf(NodeRef ref, size_t depth)
+  {
+    /* report each pair of different primitives of the leaf once */
+    if (ref.isLeaf())
+    {
+      CollidePrim prims[maxCollideLeafPrims];
+      const size_t num = collideGatherLeaf<N>(this->bvh0,ref,prims);
+
+      CollisionBuffer buffer(this->context);
+      for (size_t i=0; i<num; i++)
+        for (size_t j=i+1; j<num; j++)
+          if (conjoint(prims[i].bounds,prims[j].bounds))
+            buffer.add(prims[i],prims[j]);
+      return;
+    }
+
+    NodeRef children[N]; BBox3fa childBounds[N]; size_t numChildren = 0;
+    for (size_t i=0; i<N; i++) {
+      const NodeRef child = collideChild<N>(ref,i,childBounds[numChildren]);
+      if (child == BVHN<N>::emptyNode) continue;
+      children[numChildren++] = child;
+    }
+
+    /* collide each child with itself and with all following children */
+    auto collidePair = [&] (size_t i, size_t j) {
+      if (i == j) collideSelf(children[i],depth+1);
+      else        this->Collider::collide(children[i],childBounds[i],children[j],childBounds[j],depth+1);
+    };
+
+    if (depth < this->parallelDepth)
+      parallel_for(numChildren*numChildren, [&] (size_t k) {
+          const size_t i = k/numChildren, j = k%numChildren;
+          if (i <= j) collidePair(i,j);
+        });
+    else
+      for (size_t i=0; i<numChildren; i++)
+        for (size_t j=i; j<numChildren; j++)
+          collidePair(i,j);
+  }
+
+#if defined(__AVX__)
+  template class BVHNCollider<8,8>;
+  template class BVHNCollider<8,4>;
+  template class BVHNSelfCollider<8>;
+#endif
+
+#if defined(__AVX__) && !defined(EMBREE_TARGET_SSE2) && !defined(EMBREE_TARGET_SSE42)
+  template class BVHNCollider<4,8>;
+#endif
+
+#if !defined(__AVX__) || !defined(EMBREE_TARGET_SSE2) && !defined(EMBREE_TARGET_SSE42)
+  template class BVHNCollider<4,4>;
+  template class BVHNSelfCollider<4>;
+#endif
+}
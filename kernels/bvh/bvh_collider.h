@@ -0,0 +1,77 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "bvh.h"
+#include "../common/collide.h"
+
+namespace embree
+{
+  /*! Simultaneous traversal of two BVHs that reports all pairs of
+   *  primitives with overlapping bounds. Top levels of the traversal
+   *  are processed in parallel. */
+  template<int N0, int N1>
+  class BVHNCollider
+  {
+    typedef BVHN<N0> BVH0;
+    typedef BVHN<N1> BVH1;
+    typedef typename BVH0::NodeRef NodeRef0;
+    typedef typename BVH1::NodeRef NodeRef1;
+
+  public:
+
+    /*! reports all overlapping primitives pairs of bvh0 and bvh1 */
+    static void collide(BVH0* bvh0, BVH1* bvh1, const CollideContext* context);
+
+  protected:
+
+    /*! depth up to which node pairs are processed in parallel */
+    static const size_t parallelDepth = 4;
+
+    BVHNCollider (BVH0* bvh0, BVH1* bvh1, const CollideContext* context)
+      : bvh0(bvh0), bvh1(bvh1), context(context) {}
+
+    /*! collides two subtrees */
+    void collide(NodeRef0 ref0, const BBox3fa& bounds0, NodeRef1 ref1, const BBox3fa& bounds1, size_t depth);
+
+    /*! collides the primitives of two leaves */
+    void collideLeaves(NodeRef0 ref0, NodeRef1 ref1);
+
+  protected:
+    BVH0* bvh0;
+    BVH1* bvh1;
+    const CollideContext* context;
+  };
+
+  /*! Collides a BVH with itself, reporting each unordered pair of different primitives once. */
+  template<int N>
+  class BVHNSelfCollider : public BVHNCollider<N,N>
+  {
+    typedef BVHNCollider<N,N> Collider;
+    typedef typename BVHN<N>::NodeRef NodeRef;
+
+  public:
+    static void collide(BVHN<N>* bvh, const CollideContext* context);
+
+  private:
+    BVHNSelfCollider (BVHN<N>* bvh, const CollideContext* context)
+      : Collider(bvh,bvh,context) {}
+
+    /*! collides a subtree with itself */
+    void collideSelf(NodeRef ref, size_t depth);
+  };
+}
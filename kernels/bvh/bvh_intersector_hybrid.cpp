@@ -56,6 +56,9 @@ namespace embree
                                                                                                 const TravRayK<K, robust>& tray,
                                                                                                 IntersectContext* context)
     {
+      /* count traversal steps for the scene statistics */
+      TraversalCounter counter(context->intersectCounters());
+
       /* stack state */
       StackItemT<NodeRef> stack[stackSizeSingle];  // stack of nodes
       StackItemT<NodeRef>* stackPtr = stack + 1;   // current stack pointer
@@ -90,6 +93,7 @@ namespace embree
           /* stop if we found a leaf node */
           if (unlikely(cur.isLeaf())) break;
           STAT3(normal.trav_nodes, 1, 1, 1);
+          counter.node();
 
           /* intersect node */
           size_t mask = 0;
@@ -108,6 +112,7 @@ namespace embree
         assert(cur != BVH::emptyNode);
         STAT3(normal.trav_leaves, 1, 1, 1);
         size_t num; Primitive* prim = (Primitive*)cur.leaf(num);
+        counter.leaf(num);
 
         size_t lazy_node = 0;
         PrimitiveIntersectorK::intersect(This, pre, ray, k, context, prim, num, tray1, lazy_node);
@@ -128,6 +133,9 @@ namespace embree
                                                                                                RayHitK<K>& __restrict__ ray,
                                                                                                IntersectContext* __restrict__ context)
     {
+      /* count traversal steps for the scene statistics */
+      TraversalCounter counter(context->intersectCounters());
+
       BVH* __restrict__ bvh = (BVH*)This->ptr;
 
 #if ENABLE_FAST_COHERENT_CODEPATHS == 1
@@ -271,6 +279,7 @@ namespace embree
             /* process nodes */
             const vbool<K> valid_node = tray.tfar > curDist;
             STAT3(normal.trav_nodes, 1, popcnt(valid_node), K);
+            counter.node();
             const NodeRef nodeRef = cur;
             const BaseNode* __restrict__ const node = nodeRef.baseNode(types);
 
@@ -372,6 +381,7 @@ namespace embree
           STAT3(normal.trav_leaves, 1, popcnt(valid_leaf), K);
           if (unlikely(none(valid_leaf))) continue;
           size_t items; const Primitive* prim = (Primitive*)cur.leaf(items);
+          counter.leaf(items);
 
           size_t lazy_node = 0;
           PrimitiveIntersectorK::intersect(valid_leaf, This, pre, ray, context, prim, items, tray, lazy_node);
@@ -392,6 +402,9 @@ namespace embree
                                                                                                        RayHitK<K>& __restrict__ ray,
                                                                                                        IntersectContext* context)
     {
+      /* count traversal steps for the scene statistics */
+      TraversalCounter counter(context->intersectCounters());
+
       BVH* __restrict__ bvh = (BVH*)This->ptr;
       
       /* filter out invalid rays */
@@ -470,6 +483,7 @@ namespace embree
               vfloat<K> lnearP;
               vbool<K> lhit = false; // motion blur is not supported, so the initial value will be ignored
               STAT3(normal.trav_nodes, 1, 1, 1);
+              counter.node();
               BVHNNodeIntersectorK<N, K, types, robust>::intersect(nodeRef, i, tray, ray.time(), lnearP, lhit);
 
               if (likely(any(lhit)))
@@ -522,6 +536,7 @@ namespace embree
           STAT3(normal.trav_leaves, 1, popcnt(valid_leaf), K);
           if (unlikely(none(valid_leaf))) continue;
           size_t items; const Primitive* prim = (Primitive*)cur.leaf(items);
+          counter.leaf(items);
 
           size_t lazy_node = 0;
           PrimitiveIntersectorK::intersect(valid_leaf, This, pre, ray, context, prim, items, tray, lazy_node);
@@ -557,6 +572,9 @@ namespace embree
                                                                                                const TravRayK<K, robust>& tray,
                                                                                                IntersectContext* context)
       {
+        /* count traversal steps for the scene statistics */
+        TraversalCounter counter(context->occludedCounters());
+
         /* stack state */
         NodeRef stack[stackSizeSingle];  // stack of nodes that still need to get traversed
         NodeRef* stackPtr = stack+1;     // current stack pointer
@@ -580,6 +598,7 @@ namespace embree
             /* stop if we found a leaf node */
             if (unlikely(cur.isLeaf())) break;
             STAT3(shadow.trav_nodes, 1, 1, 1);
+            counter.node();
 
             /* intersect node */
             size_t mask = 0;
@@ -598,6 +617,7 @@ namespace embree
           assert(cur != BVH::emptyNode);
           STAT3(shadow.trav_leaves, 1, 1, 1);
           size_t num; Primitive* prim = (Primitive*)cur.leaf(num);
+          counter.leaf(num);
 
           size_t lazy_node = 0;
           if (PrimitiveIntersectorK::occluded(This, pre, ray, k, context, prim, num, tray1, lazy_node)) {
@@ -619,6 +639,9 @@ namespace embree
                                                                                               RayK<K>& __restrict__ ray,
                                                                                               IntersectContext* context)
     {
+      /* count traversal steps for the scene statistics */
+      TraversalCounter counter(context->occludedCounters());
+
       BVH* __restrict__ bvh = (BVH*)This->ptr;
 #if ENABLE_FAST_COHERENT_CODEPATHS == 1
       assert(context);
@@ -716,6 +739,7 @@ namespace embree
           /* process nodes */
           const vbool<K> valid_node = tray.tfar > curDist;
           STAT3(shadow.trav_nodes, 1, popcnt(valid_node), K);
+          counter.node();
           const NodeRef nodeRef = cur;
           const BaseNode* __restrict__ const node = nodeRef.baseNode(types);
 
@@ -777,6 +801,7 @@ namespace embree
         STAT3(shadow.trav_leaves, 1, popcnt(valid_leaf), K);
         if (unlikely(none(valid_leaf))) continue;
         size_t items; const Primitive* prim = (Primitive*) cur.leaf(items);
+        counter.leaf(items);
 
         size_t lazy_node = 0;
         terminated |= PrimitiveIntersectorK::occluded(!terminated, This, pre, ray, context, prim, items, tray, lazy_node);
@@ -799,6 +824,9 @@ namespace embree
                                                                                                       RayK<K>& __restrict__ ray,
                                                                                                       IntersectContext* context)
     {
+      /* count traversal steps for the scene statistics */
+      TraversalCounter counter(context->occludedCounters());
+
       BVH* __restrict__ bvh = (BVH*)This->ptr;
       
       /* filter out invalid rays */
@@ -879,6 +907,7 @@ namespace embree
               vfloat<K> lnearP;
               vbool<K> lhit = false; // motion blur is not supported, so the initial value will be ignored
               STAT3(normal.trav_nodes, 1, 1, 1);
+              counter.node();
               BVHNNodeIntersectorK<N, K, types, robust>::intersect(nodeRef, i, tray, ray.time(), lnearP, lhit);
 
               if (likely(any(lhit)))
@@ -908,6 +937,7 @@ namespace embree
 #endif
           if (unlikely(!m_active)) continue;
           size_t items; const Primitive* prim = (Primitive*)cur.leaf(items);
+          counter.leaf(items);
 
           size_t lazy_node = 0;
           terminated |= PrimitiveIntersectorK::occluded(!terminated, This, pre, ray, context, prim, items, tray, lazy_node);
@@ -60,6 +60,9 @@ namespace embree
                                                                                                             size_t numOctantRays,
                                                                                                             IntersectContext* context)
     {
+      /* count traversal steps for the scene statistics */
+      TraversalCounter counter(context->intersectCounters());
+
       assert(context->isCoherent());
 
       BVH* __restrict__ bvh = (BVH*) This->ptr;
@@ -108,6 +111,7 @@ namespace embree
         {
           if (unlikely(cur.isLeaf())) break;
           const AlignedNode* __restrict__ const node = cur.alignedNode();
+          counter.node();
           parent = cur;
 
           __aligned(64) size_t maskK[N];
@@ -137,6 +141,7 @@ namespace embree
         assert(cur != BVH::emptyNode);
         STAT3(normal.trav_leaves, 1, 1, 1);
         size_t num; PrimitiveK<K>* prim = (PrimitiveK<K>*)cur.leaf(num);
+        counter.leaf(num);
 
         size_t bits = m_trav_active;
 
@@ -180,6 +185,9 @@ namespace embree
                                                                                                         size_t numOctantRays,
                                                                                                         IntersectContext* context)
     {
+      /* count traversal steps for the scene statistics */
+      TraversalCounter counter(context->occludedCounters());
+
       assert(context->isCoherent());
 
       BVH* __restrict__ bvh = (BVH*)This->ptr;
@@ -232,6 +240,7 @@ namespace embree
         {
           if (unlikely(cur.isLeaf())) break;
           const AlignedNode* __restrict__ const node = cur.alignedNode();
+          counter.node();
           parent = cur;
 
           __aligned(64) size_t maskK[N];
@@ -262,6 +271,7 @@ namespace embree
         assert(cur != BVH::emptyNode);
         STAT3(normal.trav_leaves, 1, 1, 1);
         size_t num; PrimitiveK<K>* prim = (PrimitiveK<K>*)cur.leaf(num);
+        counter.leaf(num);
 
         size_t bits = m_trav_active & m_active;
         /*! intersect stream of rays with all primitives */
@@ -293,6 +303,9 @@ namespace embree
                                                                                                              size_t numOctantRays,
                                                                                                              IntersectContext* context)
     {
+      /* count traversal steps for the scene statistics */
+      TraversalCounter counter(context->occludedCounters());
+
       assert(!context->isCoherent());
       assert(types & BVH_FLAG_ALIGNED_NODE);
 
@@ -340,6 +353,7 @@ namespace embree
           /*! stop if we found a leaf node */
           if (unlikely(cur.isLeaf())) break;
           const AlignedNode* __restrict__ const node = cur.alignedNode();
+          counter.node();
 
           const vint<Nx> vmask = traverseIncoherentStream(cur_mask, packet, node, nf, shiftTable);
 
@@ -383,6 +397,7 @@ namespace embree
         assert(cur != BVH::emptyNode);
         STAT3(shadow.trav_leaves,1,1,1);
         size_t num; PrimitiveK<K>* prim = (PrimitiveK<K>*)cur.leaf(num);
+        counter.leaf(num);
 
         size_t bits = cur_mask;
         size_t lazy_node = 0;
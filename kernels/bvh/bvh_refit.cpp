@@ -16,6 +16,7 @@
 
 #include "bvh_refit.h"
 #include "bvh_statistics.h"
+#include "bvh_rotate.h"
 
 #include "../geometry/linei.h"
 #include "../geometry/triangle.h"
@@ -45,28 +46,46 @@ namespace embree
     }
 
     template<int N>
-    void BVHNRefitter<N>::refit()
+    float BVHNRefitter<N>::refit(bool rotate)
     {
+      BBox3fa bounds;
+      float area = 0.0f;
+      
       if (bvh->numPrimitives <= SINGLE_THREAD_THRESHOLD) {
-        bvh->bounds = LBBox3fa(recurse_bottom(bvh->root));
+        bounds = recurse_bottom(bvh->root,area);
+        if (rotate) BVHNRotate<N>::rotate(bvh->root);
       }
       else
       {
         BBox3fa subTreeBounds[MAX_NUM_SUB_TREES];
+        float subTreeArea[MAX_NUM_SUB_TREES];
         numSubTrees = 0;
         gather_subtree_refs(bvh->root,numSubTrees,0);
         if (numSubTrees)
           parallel_for(size_t(0), numSubTrees, size_t(1), [&](const range<size_t>& r) {
               for (size_t i=r.begin(); i<r.end(); i++) {
                 NodeRef& ref = subTrees[i];
-                subTreeBounds[i] = recurse_bottom(ref);
+                subTreeArea[i] = 0.0f;
+                subTreeBounds[i] = recurse_bottom(ref,subTreeArea[i]);
+
+                /* rotations keep the bounds of the subtree root intact,
+                 * thus all subtrees can get optimized independently */
+                if (rotate) BVHNRotate<N>::rotate(ref,MAX_SUB_TREE_EXTRACTION_DEPTH+1);
               }
             });
 
+        for (size_t i=0; i<numSubTrees; i++)
+          area += subTreeArea[i];
+
         numSubTrees = 0;        
-        bvh->bounds = LBBox3fa(refit_toplevel(bvh->root,numSubTrees,subTreeBounds,0));
-      }    
-  }
+        bounds = refit_toplevel(bvh->root,numSubTrees,subTreeBounds,area,0);
+      }
+      bvh->bounds = LBBox3fa(bounds);
+
+      /* SAH cost with unit traversal and intersection cost */
+      const float rootArea = halfArea(bounds);
+      return rootArea > 0.0f ? area/rootArea : 0.0f;
+    }
 
     template<int N>
     void BVHNRefitter<N>::gather_subtree_refs(NodeRef& ref,
@@ -95,6 +114,7 @@ namespace embree
     BBox3fa BVHNRefitter<N>::refit_toplevel(NodeRef& ref,
                                             size_t &subtrees,
 											const BBox3fa *const subTreeBounds,
+                                            float& area,
                                             const size_t depth)
     {
       if (depth >= MAX_SUB_TREE_EXTRACTION_DEPTH) 
@@ -115,8 +135,10 @@ namespace embree
 
           if (unlikely(child == BVH::emptyNode)) 
             bounds[i] = BBox3fa(empty);
-          else
-            bounds[i] = refit_toplevel(child,subtrees,subTreeBounds,depth+1); 
+          else {
+            bounds[i] = refit_toplevel(child,subtrees,subTreeBounds,area,depth+1); 
+            area += halfArea(bounds[i]);
+          }
         }
         
         BBox3vf<N> boundsT = transpose<N>(bounds);
@@ -141,7 +163,7 @@ namespace embree
 
     
     template<int N>
-    BBox3fa BVHNRefitter<N>::recurse_bottom(NodeRef& ref)
+    BBox3fa BVHNRefitter<N>::recurse_bottom(NodeRef& ref, float& area)
     {
       /* this is a leaf node */
       if (unlikely(ref.isLeaf()))
@@ -161,8 +183,10 @@ namespace embree
         {
           bounds[i] = BBox3fa(empty);          
         }
-      else
-        bounds[i] = recurse_bottom(node->child(i));
+      else {
+        bounds[i] = recurse_bottom(node->child(i),area);
+        area += halfArea(bounds[i]);
+      }
       
       /* AOS to SOA transform */
       BBox3vf<N> boundsT = transpose<N>(bounds);
@@ -180,7 +204,7 @@ namespace embree
 
     template<int N, typename Mesh, typename Primitive>
     BVHNRefitT<N,Mesh,Primitive>::BVHNRefitT (BVH* bvh, Builder* builder, Mesh* mesh, size_t mode)
-      : bvh(bvh), builder(builder), refitter(new BVHNRefitter<N>(bvh,*(typename BVHNRefitter<N>::LeafBoundsInterface*)this)), mesh(mesh) {}
+      : bvh(bvh), builder(builder), refitter(new BVHNRefitter<N>(bvh,*(typename BVHNRefitter<N>::LeafBoundsInterface*)this)), mesh(mesh), buildSAH(0.0f), refitSAH(0.0f) {}
 
     template<int N, typename Mesh, typename Primitive>
     void BVHNRefitT<N,Mesh,Primitive>::clear()
@@ -192,11 +216,22 @@ namespace embree
     template<int N, typename Mesh, typename Primitive>
     void BVHNRefitT<N,Mesh,Primitive>::build()
     {
-      if (mesh->topologyChanged()) {
+      /* rebuild if the topology changed or refitting degraded the tree too much */
+      const float threshold = mesh->device->refit_rebuild_threshold;
+      const bool degraded = threshold > 0.0f && sahDegradation() > threshold;
+
+      if (mesh->topologyChanged() || degraded) {
         builder->build();
+        buildSAH = refitSAH = 0.0f;
       }
       else
-        refitter->refit();
+      {
+        refitSAH = refitter->refit(mesh->device->refit_rotations);
+        if (buildSAH == 0.0f) buildSAH = refitSAH;
+        
+        if (mesh->device->verbosity(2))
+          std::cout << "refit: sah = " << refitSAH << ", degradation = " << sahDegradation() << std::endl;
+      }
     }
 
     template class BVHNRefitter<4>;
@@ -41,8 +41,9 @@ namespace embree
       /*! Constructor. */
       BVHNRefitter (BVH* bvh, const LeafBoundsInterface& leafBounds);
 
-      /*! refits the BVH */
-      void refit();
+      /*! refits the BVH, optionally followed by tree rotations, and
+       *  returns the SAH cost of the refitted tree */
+      float refit(bool rotate = false);
 
     private:
       /* single-threaded subtree extraction based on BVH depth */
@@ -54,10 +55,11 @@ namespace embree
       BBox3fa refit_toplevel(NodeRef& ref,
                              size_t &subtrees,
 							 const BBox3fa *const subTreeBounds,
+                             float& area,
                              const size_t depth = 0);
 
-      /* single-threaded subtree refit */
-      BBox3fa recurse_bottom(NodeRef& ref);
+      /* single-threaded subtree refit, accumulates the area of all child bounds */
+      BBox3fa recurse_bottom(NodeRef& ref, float& area);
       
     public:
       BVH* bvh;                              //!< BVH to refit
@@ -82,6 +84,11 @@ namespace embree
     public:
       BVHNRefitT (BVH* bvh, Builder* builder, Mesh* mesh, size_t mode);
 
+      /*! returns the SAH cost of the last refit relative to the tree after the last rebuild */
+      float sahDegradation() const {
+        return buildSAH > 0.0f ? refitSAH/buildSAH : 1.0f;
+      }
+
       virtual void build();
       
       virtual void clear();
@@ -102,6 +109,8 @@ namespace embree
       std::unique_ptr<Builder> builder;
       std::unique_ptr<BVHNRefitter<N>> refitter;
       Mesh* mesh;
+      float buildSAH;  //!< SAH cost measured by the first refit after a rebuild
+      float refitSAH;  //!< SAH cost measured by the last refit
     };
   }
 }
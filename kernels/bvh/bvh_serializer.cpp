@@ -0,0 +1,156 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "bvh_serializer.h"
+#include "../../common/algorithms/parallel_for.h"
+
+namespace embree
+{
+  static __forceinline void storeBounds(float* dst, const BBox3fa& b)
+  {
+    dst[0] = b.lower.x; dst[1] = b.lower.y; dst[2] = b.lower.z;
+    dst[3] = b.upper.x; dst[4] = b.upper.y; dst[5] = b.upper.z;
+  }
+
+  static __forceinline BBox3fa loadBounds(const float* src) {
+    return BBox3fa(Vec3fa(src[0],src[1],src[2]),Vec3fa(src[3],src[4],src[5]));
+  }
+
+  template<int N>
+  size_t BVHNSerializer<N>::nodeBytes(NodeRef node)
+  {
+    switch (node.type())
+    {
+    case BVH::tyAlignedNode      : return sizeof(typename BVH::AlignedNode);
+    case BVH::tyAlignedNodeMB    : return sizeof(typename BVH::AlignedNodeMB);
+    case BVH::tyAlignedNodeMB4D  : return sizeof(typename BVH::AlignedNodeMB4D);
+    case BVH::tyUnalignedNode    : return sizeof(typename BVH::UnalignedNode);
+    case BVH::tyUnalignedNodeMB  : return sizeof(typename BVH::UnalignedNodeMB);
+    case BVH::tyQuantizedNode    : return sizeof(typename BVH::QuantizedNode);
+    default                      : return 0;
+    }
+  }
+
+  template<int N>
+  typename BVHNSerializer<N>::NodeRef BVHNSerializer<N>::saveSubtree(const BVH* bvh, NodeRef node, std::ostream& stream, size_t begin)
+  {
+    assert(!node.isBarrier());
+
+    /* copy all primitive blocks of a leaf */
+    if (node.isLeaf())
+    {
+      size_t num; const char* prim = node.leaf(num);
+      if (num == 0) return BVH::emptyNode;
+      size_t bytes = 0;
+      for (size_t i=0; i<num; i++)
+        bytes += bvh->primTy->getBytes(prim+bytes);
+
+      SceneImage::align(stream,BVH::byteAlignment);
+      const size_t offset = (size_t)stream.tellp() - begin;
+      stream.write(prim,bytes);
+      return NodeRef(offset | node.type());
+    }
+
+    const size_t bytes = nodeBytes(node);
+    if (bytes == 0)
+      throw_RTCError(RTC_ERROR_UNKNOWN,"unsupported node type");
+
+    /* write children first, such that their relative references are known */
+    const BaseNode* n = node.baseNode(BVH_FLAG_ALIGNED_NODE);
+    NodeRef children[N];
+    for (size_t i=0; i<N; i++)
+      children[i] = n->child(i) == BVH::emptyNode ? NodeRef(BVH::emptyNode) : saveSubtree(bvh,n->child(i),stream,begin);
+
+    /* the child references are stored at the beginning of all node types */
+    SceneImage::align(stream,BVH::byteNodeAlignment);
+    const size_t offset = (size_t)stream.tellp() - begin;
+    stream.write((const char*)children,sizeof(children));
+    stream.write((const char*)n+sizeof(children),bytes-sizeof(children));
+    return NodeRef(offset | node.type());
+  }
+
+  template<int N>
+  bool BVHNSerializer<N>::save(const BVH* bvh, std::ostream& stream, AccelImageHeader& header)
+  {
+    if (bvh->root != BVH::emptyNode && !bvh->primTy->isRelocatable())
+      return false;
+
+    const size_t begin = (size_t) stream.tellp();
+    const NodeRef root = bvh->root == BVH::emptyNode ? NodeRef(BVH::emptyNode) : saveSubtree(bvh,bvh->root,stream,begin);
+
+    memset(&header,0,sizeof(header));
+    header.type = bvh->type;
+    header.N = N;
+    strncpy(header.primTy,bvh->primTy->name(),sizeof(header.primTy)-1);
+    header.offset = begin;
+    header.bytes = (size_t)stream.tellp() - begin;
+    header.root = root;
+    header.numPrimitives = bvh->numPrimitives;
+    header.numVertices = bvh->numVertices;
+    storeBounds(header.bounds[0],bvh->bounds.bounds0);
+    storeBounds(header.bounds[1],bvh->bounds.bounds1);
+    return true;
+  }
+
+  template<int N>
+  void BVHNSerializer<N>::relocateSubtree(NodeRef& node, char* base, size_t bytes, size_t depth)
+  {
+    /* validate the relative reference, such that corrupt files cannot cause out of bounds accesses */
+    const size_t offset = node & ~BVH::items_mask;
+    const size_t size = node.isLeaf() ? 1 : nodeBytes(node);
+    if (depth > BVH::maxDepth || size == 0 || offset >= bytes || size > bytes-offset)
+      throw_RTCError(RTC_ERROR_INVALID_ARGUMENT,"corrupt BVH file");
+
+    node = NodeRef((size_t)base + (size_t)node);
+    if (node.isLeaf()) return;
+
+    BaseNode* n = node.baseNode(BVH_FLAG_ALIGNED_NODE);
+    auto relocateChild = [&] (size_t i) {
+      if (n->child(i) != BVH::emptyNode)
+        relocateSubtree(n->child(i),base,bytes,depth+1);
+    };
+
+    if (depth < parallelDepth)
+      parallel_for(size_t(N),relocateChild);
+    else
+      for (size_t i=0; i<N; i++) relocateChild(i);
+  }
+
+  template<int N>
+  bool BVHNSerializer<N>::load(BVH* bvh, SceneImage* image, const AccelImageHeader& header)
+  {
+    if (header.type != bvh->type || header.N != N || strncmp(header.primTy,bvh->primTy->name(),sizeof(header.primTy)-1) != 0)
+      return false;
+
+    NodeRef root = header.root;
+    if (root != BVH::emptyNode)
+      relocateSubtree(root,image->data()+header.offset,header.bytes,0);
+
+    bvh->clear();
+    bvh->set(root,LBBox3fa(loadBounds(header.bounds[0]),loadBounds(header.bounds[1])),header.numPrimitives);
+    bvh->numVertices = header.numVertices;
+    bvh->image = image;
+    return true;
+  }
+
+#if defined(__AVX__)
+  template class BVHNSerializer<8>;
+#endif
+
+#if !defined(__AVX__) || !defined(EMBREE_TARGET_SSE2) && !defined(EMBREE_TARGET_SSE42)
+  template class BVHNSerializer<4>;
+#endif
+}
@@ -0,0 +1,57 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "bvh.h"
+#include "../common/scene_image.h"
+
+namespace embree
+{
+  /*! Writes BVHs as relocatable images and maps them back from BVH
+   *  files. Nodes and leaves are written in post order and store node
+   *  references relative to the start of the image, thus mapping a BVH
+   *  only requires adding the address the file got mapped to. */
+  template<int N>
+  class BVHNSerializer
+  {
+    typedef BVHN<N> BVH;
+    typedef typename BVH::NodeRef NodeRef;
+    typedef typename BVH::BaseNode BaseNode;
+
+    /*! depth up to which subtrees get relocated in parallel */
+    static const size_t parallelDepth = 4;
+
+  public:
+
+    /*! writes the BVH as relocatable image to the stream, returns false if the leaves are not relocatable */
+    static bool save(const BVH* bvh, std::ostream& stream, AccelImageHeader& header);
+
+    /*! maps the BVH from a BVH file, returns false if the stored BVH has a different layout */
+    static bool load(BVH* bvh, SceneImage* image, const AccelImageHeader& header);
+
+  private:
+
+    /*! returns the number of bytes of an inner node, or zero for unknown node types */
+    static size_t nodeBytes(NodeRef node);
+
+    /*! writes a subtree, returns the relative reference of its root */
+    static NodeRef saveSubtree(const BVH* bvh, NodeRef node, std::ostream& stream, size_t begin);
+
+    /*! converts the relative node references of a subtree into pointers */
+    static void relocateSubtree(NodeRef& node, char* base, size_t bytes, size_t depth);
+  };
+}
@@ -46,6 +46,16 @@ namespace embree
     if (stat.statQuantizedNodes.numNodes  ) stream << "  quantizedNodes   : "  << stat.statQuantizedNodes.toString(bvh,totalSAH,totalBytes) << std::endl;
     if (true)                               stream << "  leaves           : "  << stat.statLeaf.toString(bvh,totalSAH,totalBytes) << std::endl;
     if (true)                               stream << "    histogram      : "  << stat.statLeaf.histToString() << std::endl;
+
+    /* compare against the same tree stored with uncompressed nodes as in the compact layout */
+    if (stat.statQuantizedNodes.numNodes)
+    {
+      const size_t compactBytes = totalBytes - stat.statQuantizedNodes.bytes() + stat.statQuantizedNodes.numNodes*sizeof(AlignedNode);
+      stream << "  compression      : ";
+      stream << "#bytes compact = " << std::setw(7) << std::setprecision(2) << compactBytes/1E6 << " MB, ";
+      stream << "saved = " << std::setw(7) << std::setprecision(2) << (compactBytes-totalBytes)/1E6 << " MB ";
+      stream << "(" << std::setw(6) << std::setprecision(2) << 100.0*double(compactBytes-totalBytes)/double(compactBytes) << "%)" << std::endl;
+    }
     return stream.str();
   }
   
@@ -23,13 +23,17 @@
 namespace embree
 {
   class Scene;
+  struct PointQueryContext;
+  struct CollideContext;
+  struct AccelImageHeader;
+  class SceneImage;
 
   /*! Base class for the acceleration structure data. */
   class AccelData : public RefCount 
   {
     ALIGNED_CLASS_(16);
   public:
-    enum Type { TY_UNKNOWN = 0, TY_ACCELN = 1, TY_ACCEL_INSTANCE = 2, TY_BVH4 = 3, TY_BVH8 = 4 };
+    enum Type { TY_UNKNOWN = 0, TY_ACCELN = 1, TY_ACCEL_INSTANCE = 2, TY_BVH4 = 3, TY_BVH8 = 4, TY_ACCEL_REPLICAS = 5 };
 
   public:
     AccelData (const Type type) 
@@ -41,6 +45,18 @@ namespace embree
     /*! clears the acceleration structure data */
     virtual void clear() = 0;
 
+    /*! processes all primitives within the point query radius, returns true if the radius got reduced */
+    virtual bool pointQuery(PointQueryContext* context) { return false; }
+
+    /*! reports all pairs of primitives of this and some other acceleration structure with overlapping bounds */
+    virtual void collide(AccelData* other, const CollideContext* context) {}
+
+    /*! writes the acceleration structure as relocatable image to a stream, returns false if not supported */
+    virtual bool save(std::ostream& stream, AccelImageHeader& header) const { return false; }
+
+    /*! maps the acceleration structure from a BVH file, returns false if the stored acceleration structure does not match */
+    virtual bool load(SceneImage* image, const AccelImageHeader& header) { return false; }
+
     /*! returns normal bounds */
     __forceinline BBox3fa getBounds() const {
       return bounds.bounds();
@@ -47,6 +47,25 @@ namespace embree
       if (builder) builder->clear();
     }
 
+    bool pointQuery(PointQueryContext* context) {
+      return accel->pointQuery(context);
+    }
+
+    void collide(AccelData* other, const CollideContext* context) {
+      if (other->type == TY_ACCEL_INSTANCE) other = ((AccelInstance*)other)->accel.get();
+      accel->collide(other,context);
+    }
+
+    bool save(std::ostream& stream, AccelImageHeader& header) const {
+      return accel->save(stream,header);
+    }
+
+    bool load(SceneImage* image, const AccelImageHeader& header) {
+      if (!accel->load(image,header)) return false;
+      bounds = accel->bounds;
+      return true;
+    }
+
   private:
     std::unique_ptr<AccelData> accel;
     std::unique_ptr<Builder> builder;
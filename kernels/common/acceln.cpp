@@ -17,12 +17,14 @@
 #include "acceln.h"
 #include "ray.h"
 #include "../../include/embree3/rtcore_ray.h"
+#include "scene_image.h"
+#include "device.h"
 #include "../../common/algorithms/parallel_for.h"
 
 namespace embree
 {
   AccelN::AccelN()
-    : Accel(AccelData::TY_ACCELN), accels(nullptr), validAccels(nullptr) {}
+    : Accel(AccelData::TY_ACCELN), accels(nullptr), validAccels(nullptr), validBounds(empty) {}
 
   AccelN::~AccelN() 
   {
@@ -46,34 +48,96 @@ namespace embree
     
     accels.clear();
     validAccels.clear();
+    validBounds.clear();
+  }
+
+  /*! intersects a ray with the bounds of some acceleration structure, conservative like robust BVH traversal */
+  static __forceinline bool intersectBounds(const BBox3fa& bounds, const Vec3fa& org, const Vec3fa& dir, float tnear, float tfar, float& dist)
+  {
+    const Vec3fa rdir = Vec3fa(one)/zero_fix(dir);
+    const Vec3fa t0 = (bounds.lower-org)*rdir;
+    const Vec3fa t1 = (bounds.upper-org)*rdir;
+    dist = max(tnear,reduce_max(min(t0,t1)));
+    const float texit = min(tfar,reduce_min(max(t0,t1)));
+    return dist*float(1.0f-3.0f*float(ulp)) <= texit*float(1.0f+3.0f*float(ulp));
+  }
+
+  /*! masks out all rays of a packet that miss the bounds of some acceleration structure, returns true if some ray is left */
+  template<int K, typename RayK>
+  static __forceinline bool cullBounds(const BBox3fa& bounds, const int* valid_i, int* valid_o, const RayK& ray)
+  {
+    bool active = false;
+    for (size_t k=0; k<K; k++)
+    {
+      float dist;
+      const Vec3fa org(ray.org_x[k],ray.org_y[k],ray.org_z[k]);
+      const Vec3fa dir(ray.dir_x[k],ray.dir_y[k],ray.dir_z[k]);
+      valid_o[k] = (valid_i[k] && intersectBounds(bounds,org,dir,ray.tnear[k],ray.tfar[k],dist)) ? -1 : 0;
+      active |= valid_o[k] != 0;
+    }
+    return active;
+  }
+
+  /*! sorts the acceleration structures hit by the ray by their entry distance */
+  static __forceinline size_t sortBounds(const AccelN* This, const RTCRay& ray, size_t* order, float* dist)
+  {
+    const Vec3fa org(ray.org_x,ray.org_y,ray.org_z);
+    const Vec3fa dir(ray.dir_x,ray.dir_y,ray.dir_z);
+
+    size_t num = 0;
+    for (size_t i=0; i<This->validAccels.size(); i++)
+    {
+      float d;
+      if (!intersectBounds(This->validBounds[i],org,dir,ray.tnear,ray.tfar,d))
+        continue;
+
+      size_t j = num++;
+      for (; j>0 && dist[j-1] > d; j--) {
+        order[j] = order[j-1];
+        dist[j] = dist[j-1];
+      }
+      order[j] = i;
+      dist[j] = d;
+    }
+    return num;
   }
   
   void AccelN::intersect (Accel::Intersectors* This_in, RTCRayHit& ray, IntersectContext* context) 
   {
     AccelN* This = (AccelN*)This_in->ptr;
-    for (size_t i=0; i<This->validAccels.size(); i++)
-      This->validAccels[i]->intersectors.intersect(ray,context);
+    size_t order[24]; float dist[24];
+    const size_t num = sortBounds(This,ray.ray,order,dist);
+    for (size_t i=0; i<num; i++) {
+      if (dist[i]*float(1.0f-3.0f*float(ulp)) > ray.ray.tfar) break;
+      This->validAccels[order[i]]->intersectors.intersect(ray,context);
+    }
   }
 
   void AccelN::intersect4 (const void* valid, Accel::Intersectors* This_in, RTCRayHit4& ray, IntersectContext* context) 
   {
     AccelN* This = (AccelN*)This_in->ptr;
+    __aligned(16) int mask[4];
     for (size_t i=0; i<This->validAccels.size(); i++)
-      This->validAccels[i]->intersectors.intersect4(valid,ray,context);
+      if (cullBounds<4>(This->validBounds[i],(const int*)valid,mask,ray.ray))
+        This->validAccels[i]->intersectors.intersect4(mask,ray,context);
   }
 
   void AccelN::intersect8 (const void* valid, Accel::Intersectors* This_in, RTCRayHit8& ray, IntersectContext* context) 
   {
     AccelN* This = (AccelN*)This_in->ptr;
+    __aligned(32) int mask[8];
     for (size_t i=0; i<This->validAccels.size(); i++)
-      This->validAccels[i]->intersectors.intersect8(valid,ray,context);
+      if (cullBounds<8>(This->validBounds[i],(const int*)valid,mask,ray.ray))
+        This->validAccels[i]->intersectors.intersect8(mask,ray,context);
   }
 
   void AccelN::intersect16 (const void* valid, Accel::Intersectors* This_in, RTCRayHit16& ray, IntersectContext* context) 
   {
     AccelN* This = (AccelN*)This_in->ptr;
+    __aligned(64) int mask[16];
     for (size_t i=0; i<This->validAccels.size(); i++)
-      This->validAccels[i]->intersectors.intersect16(valid,ray,context);
+      if (cullBounds<16>(This->validBounds[i],(const int*)valid,mask,ray.ray))
+        This->validAccels[i]->intersectors.intersect16(mask,ray,context);
   }
 
   void AccelN::intersectN (Accel::Intersectors* This_in, RTCRayHitN** ray, const size_t N, IntersectContext* context)
@@ -86,8 +150,10 @@ namespace embree
   void AccelN::occluded (Accel::Intersectors* This_in, RTCRay& ray, IntersectContext* context) 
   {
     AccelN* This = (AccelN*)This_in->ptr;
-    for (size_t i=0; i<This->validAccels.size(); i++) {
-      This->validAccels[i]->intersectors.occluded(ray,context); 
+    size_t order[24]; float dist[24];
+    const size_t num = sortBounds(This,ray,order,dist);
+    for (size_t i=0; i<num; i++) {
+      This->validAccels[order[i]]->intersectors.occluded(ray,context); 
       if (ray.tfar < 0.0f) break; 
     }
   }
@@ -95,8 +161,10 @@ namespace embree
   void AccelN::occluded4 (const void* valid, Accel::Intersectors* This_in, RTCRay4& ray, IntersectContext* context) 
   {
     AccelN* This = (AccelN*)This_in->ptr;
+    __aligned(16) int mask[4];
     for (size_t i=0; i<This->validAccels.size(); i++) {
-      This->validAccels[i]->intersectors.occluded4(valid,ray,context);
+      if (cullBounds<4>(This->validBounds[i],(const int*)valid,mask,ray))
+        This->validAccels[i]->intersectors.occluded4(mask,ray,context);
 #if defined(__SSE2__)
       vbool4 valid0 = asBool(((vint4*)valid)[0]);
       vbool4 hit0   = ((vfloat4*)ray.tfar)[0] >= vfloat4(zero);
@@ -108,8 +176,10 @@ namespace embree
   void AccelN::occluded8 (const void* valid, Accel::Intersectors* This_in, RTCRay8& ray, IntersectContext* context) 
   {
     AccelN* This = (AccelN*)This_in->ptr;
+    __aligned(32) int mask[8];
     for (size_t i=0; i<This->validAccels.size(); i++) {
-      This->validAccels[i]->intersectors.occluded8(valid,ray,context);
+      if (cullBounds<8>(This->validBounds[i],(const int*)valid,mask,ray))
+        This->validAccels[i]->intersectors.occluded8(mask,ray,context);
 #if defined(__SSE2__) // FIXME: use higher ISA
       vbool4 valid0 = asBool(((vint4*)valid)[0]);
       vbool4 hit0   = ((vfloat4*)ray.tfar)[0] >= vfloat4(zero);
@@ -123,8 +193,10 @@ namespace embree
   void AccelN::occluded16 (const void* valid, Accel::Intersectors* This_in, RTCRay16& ray, IntersectContext* context) 
   {
     AccelN* This = (AccelN*)This_in->ptr;
+    __aligned(64) int mask[16];
     for (size_t i=0; i<This->validAccels.size(); i++) {
-      This->validAccels[i]->intersectors.occluded16(valid,ray,context);
+      if (cullBounds<16>(This->validBounds[i],(const int*)valid,mask,ray))
+        This->validAccels[i]->intersectors.occluded16(mask,ray,context);
 #if defined(__SSE2__) // FIXME: use higher ISA
       vbool4 valid0 = asBool(((vint4*)valid)[0]);
       vbool4 hit0   = ((vfloat4*)ray.tfar)[0] >= vfloat4(zero);
@@ -170,8 +242,28 @@ namespace embree
         accels[i]->build();
       });
 
+    updateValidAccels();
+  }
+
+  void AccelN::load(SceneImage* image)
+  {
+    /* map all acceleration structures from the BVH file */
+    if (image->header().numAccels != accels.size())
+      throw_RTCError(RTC_ERROR_INVALID_OPERATION,"BVH file does not match scene acceleration structures");
+
+    for (size_t i=0; i<accels.size(); i++) {
+      if (!accels[i]->load(image,image->accels()[i]))
+        throw_RTCError(RTC_ERROR_INVALID_OPERATION,"BVH file does not match scene acceleration structures");
+    }
+
+    updateValidAccels();
+  }
+
+  void AccelN::updateValidAccels(bool direct)
+  {
     /* create list of non-empty acceleration structures */
     validAccels.clear();
+    validBounds.clear();
     bool valid1 = true;
     bool valid4 = true;
     bool valid8 = true;
@@ -179,13 +271,14 @@ namespace embree
     for (size_t i=0; i<accels.size(); i++) {
       if (accels[i]->bounds.empty()) continue;
       validAccels.push_back(accels[i]);
+      validBounds.push_back(accels[i]->bounds.bounds());
       valid1 &= (bool) accels[i]->intersectors.intersector1;
       valid4 &= (bool) accels[i]->intersectors.intersector4;
       valid8 &= (bool) accels[i]->intersectors.intersector8;
       valid16 &= (bool) accels[i]->intersectors.intersector16;
     }
 
-    if (validAccels.size() == 1) {
+    if (direct && validAccels.size() == 1) {
       intersectors = validAccels[0]->intersectors;
     }
     else 
@@ -222,5 +315,100 @@ namespace embree
       accels[i]->clear();
     }
   }
-}
 
+  bool AccelN::pointQuery(PointQueryContext* context)
+  {
+    bool changed = false;
+    for (size_t i=0; i<validAccels.size(); i++)
+      changed |= validAccels[i]->pointQuery(context);
+    return changed;
+  }
+
+  void AccelN::collide(AccelData* other, const CollideContext* context)
+  {
+    assert(other->type == TY_ACCELN);
+    AccelN* otherN = (AccelN*) other;
+    for (size_t i=0; i<validAccels.size(); i++)
+      for (size_t j=(otherN == this) ? i : 0; j<otherN->validAccels.size(); j++)
+        validAccels[i]->collide(otherN->validAccels[j],context);
+  }
+
+  AccelReplicas::AccelReplicas(Device* device)
+    : Accel(AccelData::TY_ACCEL_REPLICAS), device(device) {}
+
+  AccelReplicas::~AccelReplicas()
+  {
+    for (size_t i=0; i<replicas.size(); i++)
+      delete replicas[i];
+  }
+
+  void AccelReplicas::add(AccelN* replica)
+  {
+    assert(replica);
+    replicas.push_back(replica);
+  }
+
+  void AccelReplicas::updateIntersectors()
+  {
+    /* all copies use the same intersectors, thus the first one tells which ray types are supported */
+    assert(replicas.size());
+    const Accel::Intersectors& first = replicas[0]->intersectors;
+    intersectors.ptr = this;
+    intersectors.intersector1  = Intersector1(&intersect,&occluded,first.intersector1 ? "AccelReplicas::intersector1": nullptr);
+    intersectors.intersector4  = Intersector4(&intersect4,&occluded4,first.intersector4 ? "AccelReplicas::intersector4" : nullptr);
+    intersectors.intersector8  = Intersector8(&intersect8,&occluded8,first.intersector8 ? "AccelReplicas::intersector8" : nullptr);
+    intersectors.intersector16 = Intersector16(&intersect16,&occluded16,first.intersector16 ? "AccelReplicas::intersector16": nullptr);
+    intersectors.intersectorN  = IntersectorN(&intersectN,&occludedN,first.intersectorN ? "AccelReplicas::intersectorN" : nullptr);
+    bounds = replicas[0]->bounds;
+  }
+
+  Accel::Intersectors& AccelReplicas::local() {
+    return replicas[min(device->numaNode(),replicas.size()-1)]->intersectors;
+  }
+
+  void AccelReplicas::intersect (Accel::Intersectors* This_in, RTCRayHit& ray, IntersectContext* context) {
+    ((AccelReplicas*)This_in->ptr)->local().intersect(ray,context);
+  }
+
+  void AccelReplicas::intersect4 (const void* valid, Accel::Intersectors* This_in, RTCRayHit4& ray, IntersectContext* context) {
+    ((AccelReplicas*)This_in->ptr)->local().intersect4(valid,ray,context);
+  }
+
+  void AccelReplicas::intersect8 (const void* valid, Accel::Intersectors* This_in, RTCRayHit8& ray, IntersectContext* context) {
+    ((AccelReplicas*)This_in->ptr)->local().intersect8(valid,ray,context);
+  }
+
+  void AccelReplicas::intersect16 (const void* valid, Accel::Intersectors* This_in, RTCRayHit16& ray, IntersectContext* context) {
+    ((AccelReplicas*)This_in->ptr)->local().intersect16(valid,ray,context);
+  }
+
+  void AccelReplicas::intersectN (Accel::Intersectors* This_in, RTCRayHitN** ray, const size_t N, IntersectContext* context) {
+    ((AccelReplicas*)This_in->ptr)->local().intersectN(ray,N,context);
+  }
+
+  void AccelReplicas::occluded (Accel::Intersectors* This_in, RTCRay& ray, IntersectContext* context) {
+    ((AccelReplicas*)This_in->ptr)->local().occluded(ray,context);
+  }
+
+  void AccelReplicas::occluded4 (const void* valid, Accel::Intersectors* This_in, RTCRay4& ray, IntersectContext* context) {
+    ((AccelReplicas*)This_in->ptr)->local().occluded4(valid,ray,context);
+  }
+
+  void AccelReplicas::occluded8 (const void* valid, Accel::Intersectors* This_in, RTCRay8& ray, IntersectContext* context) {
+    ((AccelReplicas*)This_in->ptr)->local().occluded8(valid,ray,context);
+  }
+
+  void AccelReplicas::occluded16 (const void* valid, Accel::Intersectors* This_in, RTCRay16& ray, IntersectContext* context) {
+    ((AccelReplicas*)This_in->ptr)->local().occluded16(valid,ray,context);
+  }
+
+  void AccelReplicas::occludedN (Accel::Intersectors* This_in, RTCRayN** ray, const size_t N, IntersectContext* context) {
+    ((AccelReplicas*)This_in->ptr)->local().occludedN(ray,N,context);
+  }
+
+  void AccelReplicas::clear()
+  {
+    for (size_t i=0; i<replicas.size(); i++)
+      replicas[i]->clear();
+  }
+}
@@ -20,7 +20,10 @@
 
 namespace embree
 {
-  /*! merges N acceleration structures together, by processing them in order */
+  class Device;
+
+  /*! merges N acceleration structures together, single rays process
+   *  them front to back and all rays skip the ones whose bounds they miss */
   class AccelN : public Accel
   {
   public:
@@ -49,12 +52,56 @@ namespace embree
     void print(size_t ident);
     void immutable();
     void build ();
+    void load(SceneImage* image);
+    void updateValidAccels(bool direct = true); //!< direct: traverse a single valid acceleration structure without dispatch
     void select(bool filter);
     void deleteGeometry(size_t geomID);
     void clear ();
+    bool pointQuery(PointQueryContext* context);
+    void collide(AccelData* other, const CollideContext* context);
 
   public:
     darray_t<Accel*,24> accels;
     darray_t<Accel*,24> validAccels;
+    darray_t<BBox3fa,24> validBounds;   //!< bounds of the valid acceleration structures over all time steps
+  };
+
+  /*! copies of the same acceleration structures placed on each NUMA
+   *  node, rays traverse the copy of the node they get traced on */
+  class AccelReplicas : public Accel
+  {
+  public:
+    AccelReplicas (Device* device);
+    ~AccelReplicas();
+
+  public:
+    void add(AccelN* replica);
+    void updateIntersectors();
+
+  public:
+    static void intersect (Accel::Intersectors* This, RTCRayHit& ray, IntersectContext* context);
+    static void intersect4 (const void* valid, Accel::Intersectors* This, RTCRayHit4& ray, IntersectContext* context);
+    static void intersect8 (const void* valid, Accel::Intersectors* This, RTCRayHit8& ray, IntersectContext* context);
+    static void intersect16 (const void* valid, Accel::Intersectors* This, RTCRayHit16& ray, IntersectContext* context);
+    static void intersectN (Accel::Intersectors* This, RTCRayHitN** ray, const size_t N, IntersectContext* context);
+
+  public:
+    static void occluded (Accel::Intersectors* This, RTCRay& ray, IntersectContext* context);
+    static void occluded4 (const void* valid, Accel::Intersectors* This, RTCRay4& ray, IntersectContext* context);
+    static void occluded8 (const void* valid, Accel::Intersectors* This, RTCRay8& ray, IntersectContext* context);
+    static void occluded16 (const void* valid, Accel::Intersectors* This, RTCRay16& ray, IntersectContext* context);
+    static void occludedN (Accel::Intersectors* This, RTCRayN** ray, const size_t N, IntersectContext* context);
+
+  public:
+    void build () {} // the copies get mapped from the serialized original
+    void clear ();
+
+  private:
+    /*! returns the copy of the NUMA node of the calling thread */
+    Accel::Intersectors& local();
+
+  public:
+    Device* device;
+    std::vector<AccelN*> replicas;      //!< one copy per NUMA node
   };
 }
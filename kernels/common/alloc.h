@@ -39,7 +39,7 @@ namespace embree
   public:
 
     struct ThreadLocal2;
-    enum AllocationType { ALIGNED_MALLOC, OS_MALLOC, SHARED, ANY_TYPE };
+    enum AllocationType { ALIGNED_MALLOC, OS_MALLOC, SHARED, FILE_MAPPED, ANY_TYPE };
 
     /*! Per thread structure holding the current memory block. */
     struct __aligned(64) ThreadLocal
@@ -180,8 +180,8 @@ namespace embree
       ThreadLocal alloc1;
     };
 
-    FastAllocator (Device* device, bool osAllocation) 
-      : device(device), slotMask(0), usedBlocks(nullptr), freeBlocks(nullptr), use_single_mode(false), defaultBlockSize(PAGE_SIZE), estimatedSize(0),
+    FastAllocator (Device* device, bool osAllocation, MemoryMonitorInterface* monitor = nullptr) 
+      : device(device), monitor(monitor ? monitor : device), pool(device ? device->blockPool.get() : nullptr), numNumaNodes(device ? device->numNumaNodes : 1), slotMask(0), usedBlocks(nullptr), freeBlocks(nullptr), use_single_mode(false), defaultBlockSize(PAGE_SIZE), estimatedSize(0),
         growSize(PAGE_SIZE), maxGrowSize(maxAllocationSize), log2_grow_size_scale(0), bytesUsed(0), bytesFree(0), bytesWasted(0), atype(osAllocation ? OS_MALLOC : ALIGNED_MALLOC),
         primrefarray(device,0)
     {
@@ -220,6 +220,13 @@ namespace embree
       atype = flag ? OS_MALLOC : ALIGNED_MALLOC;
     }
 
+    /*! allocates large blocks from temporary files in the specified directory, which lets the OS page out built parts of the BVH */
+    void setSpillDirectory(const std::string& dir)
+    {
+      spillDirectory = dir;
+      if (!dir.empty()) atype = FILE_MAPPED;
+    }
+
   private:
 
     /*! returns both fast thread local allocators */
@@ -403,7 +410,7 @@ namespace embree
       slotMask = MAX_THREAD_USED_BLOCK_SLOTS-1; // FIXME: remove
       if (usedBlocks.load() || freeBlocks.load()) { reset(); return; }
       if (bytesReserve == 0) bytesReserve = bytesAllocate;
-      freeBlocks = Block::create(device,bytesAllocate,bytesReserve,nullptr,atype);
+      freeBlocks = Block::create(monitor,pool,bytesAllocate,bytesReserve,nullptr,atype,spillDirectory);
       estimatedSize = bytesEstimate;
       initGrowSizeAndNumSlots(bytesEstimate,true);
     }
@@ -469,8 +476,8 @@ namespace embree
       bytesUsed.store(0);
       bytesFree.store(0);
       bytesWasted.store(0);
-      if (usedBlocks.load() != nullptr) usedBlocks.load()->clear_list(device); usedBlocks = nullptr;
-      if (freeBlocks.load() != nullptr) freeBlocks.load()->clear_list(device); freeBlocks = nullptr;
+      if (usedBlocks.load() != nullptr) usedBlocks.load()->clear_list(monitor,pool); usedBlocks = nullptr;
+      if (freeBlocks.load() != nullptr) freeBlocks.load()->clear_list(monitor,pool); freeBlocks = nullptr;
       for (size_t i=0; i<MAX_THREAD_USED_BLOCK_SLOTS; i++) {
         threadUsedBlocks[i] = nullptr;
         threadBlocks[i] = nullptr;
@@ -484,6 +491,38 @@ namespace embree
       return size_t(1) << min(size_t(16),scale);
     }
 
+    /*! selects the block slot of the calling thread, with multiple NUMA nodes each node gets its own slots */
+    __forceinline size_t getSlot(size_t threadID, ssize_t& numaNode) const
+    {
+      numaNode = -1;
+      if (likely(numNumaNodes <= 1))
+        return threadID & slotMask;
+
+      numaNode = device->numaNode();
+      const size_t slotsPerNode = max(size_t(1),MAX_THREAD_USED_BLOCK_SLOTS/numNumaNodes);
+      return (numaNode*slotsPerNode + threadID%slotsPerNode) % MAX_THREAD_USED_BLOCK_SLOTS;
+    }
+
+  private:
+    struct Block;
+
+    /*! removes the first free block usable on the specified NUMA node from the free list */
+    Block* takeFreeBlock(ssize_t numaNode)
+    {
+      Block* prev = nullptr;
+      for (Block* block = freeBlocks.load(); block; prev = block, block = block->next)
+      {
+        if (block->numaNode >= 0 && block->numaNode != numaNode)
+          continue;
+        if (prev) prev->next = block->next;
+        else freeBlocks = block->next;
+        return block;
+      }
+      return nullptr;
+    }
+
+  public:
+
     /*! thread safe allocation of memory */
     void* malloc(size_t& bytes, size_t align, bool partial)
     {
@@ -493,10 +532,11 @@ namespace embree
       {
         /* allocate using current block */
         size_t threadID = TaskScheduler::threadID();
-        size_t slot = threadID & slotMask;
+        ssize_t numaNode;
+        size_t slot = getSlot(threadID,numaNode);
 	Block* myUsedBlocks = threadUsedBlocks[slot];
         if (myUsedBlocks) {
-          void* ptr = myUsedBlocks->malloc(device,bytes,align,partial);
+          void* ptr = myUsedBlocks->malloc(monitor,bytes,align,partial);
           if (ptr) return ptr;
         }
 
@@ -512,7 +552,7 @@ namespace embree
             const size_t alignedBytes = (bytes+(align-1)) & ~(align-1);
             const size_t allocSize = max(min(growSize,maxGrowSize),alignedBytes);
             assert(allocSize >= bytes);
-            threadBlocks[slot] = threadUsedBlocks[slot] = Block::create(device,allocSize,allocSize,threadBlocks[slot],atype); // FIXME: a large allocation might throw away a block here!
+            threadBlocks[slot] = threadUsedBlocks[slot] = Block::create(monitor,pool,allocSize,allocSize,threadBlocks[slot],atype,spillDirectory,numaNode); // FIXME: a large allocation might throw away a block here!
             // FIXME: a direct allocation should allocate inside the block here, and not in the next loop! a different thread could do some allocation and make the large allocation fail.
           }
           continue;
@@ -523,16 +563,20 @@ namespace embree
           Lock<SpinLock> lock(mutex);
 	  if (myUsedBlocks == threadUsedBlocks[slot])
 	  {
-            if (freeBlocks.load() != nullptr) {
+            if (numaNode < 0 && freeBlocks.load() != nullptr) {
 	      Block* nextFreeBlock = freeBlocks.load()->next;
 	      freeBlocks.load()->next = usedBlocks;
 	      __memory_barrier();
 	      usedBlocks = freeBlocks.load();
               threadUsedBlocks[slot] = freeBlocks.load();
 	      freeBlocks = nextFreeBlock;
-	    } else {
+	    } else if (Block* freeBlock = numaNode >= 0 ? takeFreeBlock(numaNode) : nullptr) {
+              freeBlock->next = usedBlocks;
+              __memory_barrier();
+              usedBlocks = threadUsedBlocks[slot] = freeBlock;
+            } else {
               const size_t allocSize = min(growSize*incGrowSizeScale(),maxGrowSize);
-	      usedBlocks = threadUsedBlocks[slot] = Block::create(device,allocSize,allocSize,usedBlocks,atype); // FIXME: a large allocation should get delivered directly, like above!
+	      usedBlocks = threadUsedBlocks[slot] = Block::create(monitor,pool,allocSize,allocSize,usedBlocks,atype,spillDirectory,numaNode); // FIXME: a large allocation should get delivered directly, like above!
 	    }
           }
         }
@@ -717,12 +761,13 @@ namespace embree
 
     struct Block
     {
-      static Block* create(MemoryMonitorInterface* device, size_t bytesAllocate, size_t bytesReserve, Block* next, AllocationType atype)
+      static Block* create(MemoryMonitorInterface* device, BlockPool* pool, size_t bytesAllocate, size_t bytesReserve, Block* next, AllocationType atype, const std::string& spillDirectory, ssize_t numaNode = -1)
       {
-        /* We avoid using os_malloc for small blocks as this could
-         * cause a risk of fragmenting the virtual address space and
-         * reach the limit of vm.max_map_count = 65k under Linux. */
-        if (atype == OS_MALLOC && bytesAllocate < maxAllocationSize)
+        /* We avoid using os_malloc or file mappings for small blocks
+         * as this could cause a risk of fragmenting the virtual address
+         * space and reach the limit of vm.max_map_count = 65k under
+         * Linux. */
+        if ((atype == OS_MALLOC || atype == FILE_MAPPED) && bytesAllocate < maxAllocationSize)
           atype = ALIGNED_MALLOC;
 
         /* we need to additionally allocate some header */
@@ -730,8 +775,8 @@ namespace embree
         bytesAllocate = sizeof_Header+bytesAllocate;
         bytesReserve  = sizeof_Header+bytesReserve;
 
-        /* consume full 4k pages with using os_malloc */
-        if (atype == OS_MALLOC) {
+        /* consume full 4k pages with using os_malloc or file mappings */
+        if (atype == OS_MALLOC || atype == FILE_MAPPED) {
           bytesAllocate = ((bytesAllocate+PAGE_SIZE-1) & ~(PAGE_SIZE-1));
           bytesReserve  = ((bytesReserve +PAGE_SIZE-1) & ~(PAGE_SIZE-1));
         }
@@ -745,6 +790,12 @@ namespace embree
           {
             const size_t alignment = maxAlignment;
             if (device) device->memoryMonitor(bytesAllocate+alignment,false);
+
+            /* recycle a released block */
+            size_t bytesPooled = bytesAllocate; bool huge_pages = false;
+            if (pool && (ptr = pool->take(bytesPooled,false,huge_pages,numaNode)))
+              return new (ptr) Block(ALIGNED_MALLOC,bytesAllocate-sizeof_Header,bytesPooled-sizeof_Header,next,alignment,false,numaNode);
+
             ptr = alignedMalloc(bytesAllocate,alignment);
 
             /* give hint to transparently convert these pages to 2MB pages */
@@ -752,22 +803,43 @@ namespace embree
             os_advise((void*)(ptr_aligned_begin +              0),PAGE_SIZE_2M); // may fail if no memory mapped before block
             os_advise((void*)(ptr_aligned_begin + 1*PAGE_SIZE_2M),PAGE_SIZE_2M);
             os_advise((void*)(ptr_aligned_begin + 2*PAGE_SIZE_2M),PAGE_SIZE_2M); // may fail if no memory mapped after block
+            if (numaNode >= 0) os_bind_node(ptr,bytesAllocate,numaNode);
 
-            return new (ptr) Block(ALIGNED_MALLOC,bytesAllocate-sizeof_Header,bytesAllocate-sizeof_Header,next,alignment);
+            return new (ptr) Block(ALIGNED_MALLOC,bytesAllocate-sizeof_Header,bytesAllocate-sizeof_Header,next,alignment,false,numaNode);
           }
           else
           {
             const size_t alignment = maxAlignment;
             if (device) device->memoryMonitor(bytesAllocate+alignment,false);
+
+            /* recycle a released block */
+            size_t bytesPooled = bytesAllocate; bool huge_pages = false;
+            if (pool && (ptr = pool->take(bytesPooled,false,huge_pages,numaNode)))
+              return new (ptr) Block(ALIGNED_MALLOC,bytesAllocate-sizeof_Header,bytesPooled-sizeof_Header,next,alignment,false,numaNode);
+
             ptr = alignedMalloc(bytesAllocate,alignment);
-            return new (ptr) Block(ALIGNED_MALLOC,bytesAllocate-sizeof_Header,bytesAllocate-sizeof_Header,next,alignment);
+            if (numaNode >= 0) os_bind_node(ptr,bytesAllocate,numaNode);
+            return new (ptr) Block(ALIGNED_MALLOC,bytesAllocate-sizeof_Header,bytesAllocate-sizeof_Header,next,alignment,false,numaNode);
           }
         }
         else if (atype == OS_MALLOC)
         {
           if (device) device->memoryMonitor(bytesAllocate,false);
-          bool huge_pages; ptr = os_malloc(bytesReserve,huge_pages);
-          return new (ptr) Block(OS_MALLOC,bytesAllocate-sizeof_Header,bytesReserve-sizeof_Header,next,0,huge_pages);
+
+          /* recycle a released block */
+          size_t bytesPooled = bytesReserve; bool huge_pages = false;
+          if (pool && (ptr = pool->take(bytesPooled,true,huge_pages,numaNode)))
+            return new (ptr) Block(OS_MALLOC,bytesAllocate-sizeof_Header,bytesPooled-sizeof_Header,next,0,huge_pages,numaNode);
+
+          ptr = os_malloc(bytesReserve,huge_pages);
+          if (numaNode >= 0) os_bind_node(ptr,bytesReserve,numaNode);
+          return new (ptr) Block(OS_MALLOC,bytesAllocate-sizeof_Header,bytesReserve-sizeof_Header,next,0,huge_pages,numaNode);
+        }
+        else if (atype == FILE_MAPPED)
+        {
+          if (device) device->memoryMonitor(bytesAllocate,false);
+          ptr = os_map_temp_file(spillDirectory.c_str(),bytesReserve);
+          return new (ptr) Block(FILE_MAPPED,bytesAllocate-sizeof_Header,bytesReserve-sizeof_Header,next,0);
         }
         else
           assert(false);
@@ -775,8 +847,8 @@ namespace embree
         return NULL;
       }
 
-      Block (AllocationType atype, size_t bytesAllocate, size_t bytesReserve, Block* next, size_t wasted, bool huge_pages = false)
-      : cur(0), allocEnd(bytesAllocate), reserveEnd(bytesReserve), next(next), wasted(wasted), atype(atype), huge_pages(huge_pages)
+      Block (AllocationType atype, size_t bytesAllocate, size_t bytesReserve, Block* next, size_t wasted, bool huge_pages = false, ssize_t numaNode = -1)
+      : cur(0), allocEnd(bytesAllocate), reserveEnd(bytesReserve), next(next), wasted(wasted), atype(atype), numaNode(int(numaNode)), huge_pages(huge_pages)
       {
         assert((((size_t)&data[0]) & (maxAlignment-1)) == 0);
       }
@@ -791,21 +863,29 @@ namespace embree
         return head;
       }
 
-      void clear_list(MemoryMonitorInterface* device)
+      void clear_list(MemoryMonitorInterface* device, BlockPool* pool = nullptr)
       {
         Block* block = this;
         while (block) {
           Block* next = block->next;
-          block->clear_block(device);
+          block->clear_block(device,pool);
           block = next;
         }
       }
 
-      void clear_block (MemoryMonitorInterface* device)
+      void clear_block (MemoryMonitorInterface* device, BlockPool* pool = nullptr)
       {
         const size_t sizeof_Header = offsetof(Block,data[0]);
         const ssize_t sizeof_Alloced = wasted+sizeof_Header+getBlockAllocatedBytes();
 
+        /* hand large blocks to the pool of the device, the block must not get accessed afterwards */
+        if (pool && (atype == ALIGNED_MALLOC || atype == OS_MALLOC)) {
+          if (pool->give(this,sizeof_Header+reserveEnd,atype == OS_MALLOC,huge_pages,numaNode)) {
+            if (device) device->memoryMonitor(-sizeof_Alloced,true);
+            return;
+          }
+        }
+
         if (atype == ALIGNED_MALLOC) {
           alignedFree(this);
           if (device) device->memoryMonitor(-sizeof_Alloced,true);
@@ -817,6 +897,12 @@ namespace embree
          if (device) device->memoryMonitor(-sizeof_Alloced,true);
         }
 
+        else if (atype == FILE_MAPPED) {
+          size_t sizeof_This = sizeof_Header+reserveEnd;
+          os_unmap_file(this,sizeof_This);
+          if (device) device->memoryMonitor(-sizeof_Alloced,true);
+        }
+
         else /* if (atype == SHARED) */ {
         }
       }
@@ -923,6 +1009,7 @@ namespace embree
         if (atype == ALIGNED_MALLOC) std::cout << "A";
         else if (atype == OS_MALLOC) std::cout << "O";
         else if (atype == SHARED) std::cout << "S";
+        else if (atype == FILE_MAPPED) std::cout << "F";
         if (huge_pages) std::cout << "H";
         size_t bytesUsed = getBlockUsedBytes();
         size_t bytesFree = getBlockFreeBytes();
@@ -937,13 +1024,17 @@ namespace embree
       Block* next;               //!< pointer to next block in list
       size_t wasted;             //!< amount of memory wasted through block alignment
       AllocationType atype;      //!< allocation mode of the block
+      int numaNode;              //!< NUMA node the block got placed on, -1 if not placed
       bool huge_pages;           //!< whether the block uses huge pages
-      char align[maxAlignment-5*sizeof(size_t)-sizeof(AllocationType)-sizeof(bool)]; //!< align data to maxAlignment
+      char align[maxAlignment-5*sizeof(size_t)-sizeof(AllocationType)-sizeof(int)-sizeof(bool)]; //!< align data to maxAlignment
       char data[1];              //!< here starts memory to use for allocations
     };
 
   private:
     Device* device;
+    MemoryMonitorInterface* monitor;   //!< gets notified about all block allocations
+    BlockPool* pool;                   //!< pool of the device released blocks get recycled through
+    size_t numNumaNodes;               //!< number of NUMA nodes blocks get placed on
     SpinLock mutex;
     size_t slotMask;
     std::atomic<Block*> threadUsedBlocks[MAX_THREAD_USED_BLOCK_SLOTS];
@@ -968,6 +1059,7 @@ namespace embree
     SpinLock thread_local_allocators_lock;
     std::vector<ThreadLocal2*> thread_local_allocators;
     AllocationType atype;
+    std::string spillDirectory;        //!< directory of temporary files for FILE_MAPPED blocks
     mvector<PrimRef> primrefarray;     //!< primrefarray used to allocate nodes
   };
 }
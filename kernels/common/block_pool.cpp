@@ -0,0 +1,133 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "block_pool.h"
+
+namespace embree
+{
+  BlockPool::BlockPool (MemoryMonitorInterface* device, size_t maxBytes)
+    : device(device), maxBytes(maxBytes), bytes(0), hits(0), misses(0) {}
+
+  BlockPool::~BlockPool () {
+    trim(0);
+  }
+
+  void* BlockPool::take(size_t& bytes_inout, bool os_malloc, bool& huge_pages, ssize_t numaNode)
+  {
+    if (maxBytes == 0 || bytes_inout < minBlockBytes)
+      return nullptr;
+
+    Item item(nullptr,0,false,false,-1);
+    {
+      Lock<SpinLock> lock(mutex);
+
+      /* find the smallest block that wastes at most half of its memory */
+      ssize_t best = -1;
+      for (size_t i=0; i<items.size(); i++)
+      {
+        const Item& cand = items[i];
+        if (cand.os_malloc != os_malloc) continue;
+        if (cand.bytes < bytes_inout || cand.bytes > 2*bytes_inout) continue;
+        if (numaNode >= 0 && cand.numaNode != numaNode) continue;
+        if (best == -1 || cand.bytes < items[best].bytes) best = i;
+      }
+      if (best == -1) {
+        misses++;
+        return nullptr;
+      }
+
+      item = items[best];
+      items.erase(items.begin()+best);
+      bytes -= item.bytes;
+      hits++;
+    }
+
+    if (device) device->memoryMonitor(-ssize_t(item.bytes),true);
+    bytes_inout = item.bytes;
+    huge_pages = item.huge_pages;
+    return item.ptr;
+  }
+
+  bool BlockPool::give(void* ptr, size_t bytes_in, bool os_malloc, bool huge_pages, ssize_t numaNode)
+  {
+    if (bytes_in < minBlockBytes || bytes_in > maxBytes)
+      return false;
+
+    /* the block stays with the caller if the memory monitor rejects it */
+    try {
+      if (device) device->memoryMonitor(bytes_in,true);
+    } catch (...) {
+      return false;
+    }
+
+    {
+      Lock<SpinLock> lock(mutex);
+      items.push_back(Item(ptr,bytes_in,os_malloc,huge_pages,numaNode));
+      bytes += bytes_in;
+    }
+
+    /* release the oldest blocks above the high-water mark */
+    trim(maxBytes);
+    return true;
+  }
+
+  void BlockPool::setMaxBytes(size_t bytes)
+  {
+    maxBytes = bytes;
+    trim(bytes);
+  }
+
+  void BlockPool::trim(size_t maxBytes_in)
+  {
+    std::vector<Item> released;
+    {
+      Lock<SpinLock> lock(mutex);
+      size_t num = 0;
+      while (num < items.size() && bytes > maxBytes_in)
+        bytes -= items[num++].bytes;
+      released.assign(items.begin(),items.begin()+num);
+      items.erase(items.begin(),items.begin()+num);
+    }
+
+    /* free the blocks outside the lock */
+    for (const Item& item : released)
+      free(item);
+  }
+
+  void BlockPool::free(const Item& item)
+  {
+    if (item.os_malloc) os_free(item.ptr,item.bytes,item.huge_pages);
+    else                alignedFree(item.ptr);
+    if (device) device->memoryMonitor(-ssize_t(item.bytes),true);
+  }
+
+  BlockPool::Statistics BlockPool::getStatistics() const
+  {
+    Lock<SpinLock> lock(mutex);
+    Statistics stat;
+    stat.hits = hits;
+    stat.misses = misses;
+    stat.bytes = bytes;
+    return stat;
+  }
+
+  void BlockPool::resetStatistics()
+  {
+    Lock<SpinLock> lock(mutex);
+    hits = 0;
+    misses = 0;
+  }
+}
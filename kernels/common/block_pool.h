@@ -0,0 +1,103 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "default.h"
+
+namespace embree
+{
+  /*! Device wide pool of large memory blocks released by the
+   *  FastAllocators of all scenes. Later builds take the blocks from
+   *  the pool instead of allocating fresh memory, which avoids the
+   *  system calls and first touch page faults of the allocation. The
+   *  pool holds at most maxBytes and releases its oldest blocks first
+   *  to stay below that limit. Pooled memory is reported to the memory
+   *  monitor of the device. */
+  class BlockPool
+  {
+  public:
+
+    /*! statistics of the pool */
+    struct Statistics
+    {
+      Statistics ()
+      : hits(0), misses(0), bytes(0) {}
+
+    public:
+      size_t hits;    //!< number of blocks taken from the pool
+      size_t misses;  //!< number of blocks that had to get allocated
+      size_t bytes;   //!< number of bytes currently held by the pool
+    };
+
+  private:
+
+    /*! a block held by the pool */
+    struct Item
+    {
+      Item (void* ptr, size_t bytes, bool os_malloc, bool huge_pages, ssize_t numaNode)
+      : ptr(ptr), bytes(bytes), os_malloc(os_malloc), huge_pages(huge_pages), numaNode(numaNode) {}
+
+    public:
+      void* ptr;         //!< start of the block
+      size_t bytes;      //!< size of the block
+      bool os_malloc;    //!< true if allocated with os_malloc, false if allocated with alignedMalloc
+      bool huge_pages;   //!< whether the block uses huge pages
+      ssize_t numaNode;  //!< NUMA node the block got placed on, -1 if not placed
+    };
+
+  public:
+
+    /*! blocks smaller than this size get not pooled */
+    static const size_t minBlockBytes = 64*1024;
+
+    BlockPool (MemoryMonitorInterface* device, size_t maxBytes);
+    ~BlockPool ();
+
+    /*! takes a block of at least bytes size from the pool, returns nullptr if no block fits */
+    void* take(size_t& bytes, bool os_malloc, bool& huge_pages, ssize_t numaNode);
+
+    /*! gives a block to the pool, returns false if the caller has to free the block */
+    bool give(void* ptr, size_t bytes, bool os_malloc, bool huge_pages, ssize_t numaNode);
+
+    /*! sets the maximal number of bytes the pool holds, and frees blocks until the pool fits */
+    void setMaxBytes(size_t bytes);
+
+    /*! returns the maximal number of bytes the pool holds */
+    size_t getMaxBytes() const { return maxBytes; }
+
+    /*! frees blocks until the pool holds at most the specified number of bytes */
+    void trim(size_t bytes);
+
+    /*! returns the statistics of the pool */
+    Statistics getStatistics() const;
+
+    /*! resets the hit and miss counters */
+    void resetStatistics();
+
+  private:
+    void free(const Item& item);
+
+  private:
+    MemoryMonitorInterface* device;
+    mutable SpinLock mutex;
+    std::vector<Item> items;      //!< pooled blocks, oldest first
+    std::atomic<size_t> maxBytes; //!< high-water mark of the pool
+    size_t bytes;                 //!< number of bytes held by the pool
+    size_t hits;
+    size_t misses;
+  };
+}
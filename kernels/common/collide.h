@@ -0,0 +1,53 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "default.h"
+#include "rtcore.h"
+
+namespace embree
+{
+  /*! State of a collision query between two acceleration structures. */
+  struct CollideContext
+  {
+    CollideContext (RTCCollideFunc callback, void* userPtr, bool swapped = false)
+      : callback(callback), userPtr(userPtr), swapped(swapped) {}
+
+    /*! returns the context to use when the order of the acceleration structures gets swapped */
+    __forceinline CollideContext swap() const {
+      return CollideContext(callback,userPtr,!swapped);
+    }
+
+    /*! reports a set of overlapping primitive pairs */
+    __forceinline void report(RTCCollision* collisions, size_t num) const
+    {
+      if (num == 0) return;
+      if (swapped) {
+        for (size_t i=0; i<num; i++) {
+          std::swap(collisions[i].geomID0,collisions[i].geomID1);
+          std::swap(collisions[i].primID0,collisions[i].primID1);
+        }
+      }
+      callback(userPtr,collisions,(unsigned int)num);
+    }
+
+  public:
+    RTCCollideFunc callback;   //!< user callback receiving overlapping primitive pairs
+    void* userPtr;             //!< user pointer passed to the callback
+    bool swapped;              //!< true if the acceleration structures got traversed in swapped order
+  };
+}
@@ -18,6 +18,7 @@
 
 #include "default.h"
 #include "rtcore.h"
+#include "traversal_stats.h"
 
 namespace embree
 {
@@ -26,8 +27,8 @@ namespace embree
   struct IntersectContext
   {
   public:
-    __forceinline IntersectContext(Scene* scene, RTCIntersectContext* user_context)
-      : scene(scene), user(user_context), instID(user_context->instID[0]) {}
+    __forceinline IntersectContext(Scene* scene, RTCIntersectContext* user_context, ThreadTraversalCounters* stats = nullptr)
+      : scene(scene), user(user_context), stats(stats) {}
 
     __forceinline bool hasContextFilter() const {
       return user->filter != nullptr;
@@ -40,10 +41,14 @@ namespace embree
     __forceinline bool isIncoherent() const {
       return embree::isIncoherent(user->flags);
     }
+
+    /* returns the statistics counters of intersection and occlusion rays, nullptr if disabled */
+    __forceinline TraversalCounters* intersectCounters() const { return stats ? &stats->intersect : nullptr; }
+    __forceinline TraversalCounters* occludedCounters () const { return stats ? &stats->occluded  : nullptr; }
     
   public:
     Scene* scene;
     RTCIntersectContext* user;
-    unsigned int instID;
+    ThreadTraversalCounters* stats; //!< traversal statistics of the calling thread, nullptr if disabled
   };
 }
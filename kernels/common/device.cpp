@@ -46,7 +46,6 @@ namespace embree
   DECLARE_SYMBOL2(RayStreamFilterFuncs,rayStreamFilterFuncs);
 
   static MutexSys g_mutex;
-  static std::map<Device*,size_t> g_cache_size_map;
   static std::map<Device*,size_t> g_num_threads_map;
 
   Device::Device (const char* cfg)
@@ -73,9 +72,23 @@ namespace embree
 #endif
     State::hugepages_success &= os_init(State::hugepages,State::verbosity(3));
     
-    /*! set tessellation cache size */
+    /*! create tessellation cache */
+    tessellationCache = make_unique(new SharedLazyTessellationCache);
     setCacheSize( State::tessellation_cache_size );
 
+    /*! create pool of recycled allocator blocks */
+    blockPool = make_unique(new BlockPool(this,State::alloc_pool_size));
+
+    /*! reset build phase timings */
+    for (size_t i=0; i<BUILD_PHASES; i++)
+      buildPhaseTime[i] = 0;
+    buildTopLevelNodes = 0;
+
+    /*! configure NUMA nodes */
+    numNumaNodes = 1;
+    if (State::numa)
+      numNumaNodes = State::numa_nodes ? State::numa_nodes : getNumberOfNumaNodes();
+
     /*! enable some floating point exceptions to catch bugs */
     if (State::float_exceptions)
     {
@@ -116,6 +129,7 @@ namespace embree
   Device::~Device ()
   {
     setCacheSize(0);
+    blockPool.reset();
     exitTaskingSystem();
   }
 
@@ -304,26 +318,22 @@ namespace embree
     return maxNumThreads;
   }
 
-  size_t getMaxCacheSize()
-  {
-    size_t maxCacheSize = 0;
-    for (std::map<Device*,size_t>::iterator i=g_cache_size_map.begin(); i!= g_cache_size_map.end(); i++)
-      maxCacheSize = max(maxCacheSize, (*i).second);
-    return maxCacheSize;
-  }
- 
   void Device::setCacheSize(size_t bytes) 
   {
 #if defined(EMBREE_GEOMETRY_SUBDIVISION)
-    Lock<MutexSys> lock(g_mutex);
-    if (bytes == 0) g_cache_size_map.erase(this);
-    else            g_cache_size_map[this] = bytes;
-    
-    size_t maxCacheSize = getMaxCacheSize();
-    resizeTessellationCache(maxCacheSize);
+    tessellationCache->resize(bytes);
 #endif
   }
 
+  size_t Device::numaNode() const
+  {
+    if (numNumaNodes <= 1) return 0;
+    const ssize_t thread = getCurrentLogicalThread();
+    if (thread < 0) return 0;
+    if (State::numa_nodes) return size_t(thread) % numNumaNodes;
+    return min(getNumaNodeOfLogicalThread(thread),numNumaNodes-1);
+  }
+
   void Device::initTaskingSystem(size_t numThreads) 
   {
     Lock<MutexSys> lock(g_mutex);
@@ -334,7 +344,7 @@ namespace embree
 
     /* create task scheduler */
     size_t maxNumThreads = getMaxNumThreads();
-    TaskScheduler::create(maxNumThreads,State::set_affinity,State::start_threads);
+    TaskScheduler::create(maxNumThreads,State::set_affinity || State::numa,State::start_threads);
 #if USE_TASK_ARENA
     arena = make_unique(new tbb::task_arena((int)min(maxNumThreads,TaskScheduler::threadCount())));
 #endif
@@ -352,7 +362,7 @@ namespace embree
     /* or configure new number of threads */
     else {
       size_t maxNumThreads = getMaxNumThreads();
-      TaskScheduler::create(maxNumThreads,State::set_affinity,State::start_threads);
+      TaskScheduler::create(maxNumThreads,State::set_affinity || State::numa,State::start_threads);
     }
 #if USE_TASK_ARENA
     arena.reset();
@@ -370,6 +380,30 @@ namespace embree
     case 1000003: debug_int3 = val; return;
     }
 
+    switch (prop)
+    {
+    case RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_SIZE: 
+      if (val < 0) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "invalid tessellation cache size");
+      setCacheSize(val); return;
+    case RTC_DEVICE_PROPERTY_BUILD_PRIMITIVES_TIME:
+    case RTC_DEVICE_PROPERTY_BUILD_SORT_TIME:
+    case RTC_DEVICE_PROPERTY_BUILD_HIERARCHY_TIME:
+    case RTC_DEVICE_PROPERTY_BUILD_TOPLEVEL_TIME:
+      if (val != 0) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "build phase time can only get reset to 0");
+      buildPhaseTime[prop-RTC_DEVICE_PROPERTY_BUILD_PRIMITIVES_TIME] = 0; return;
+    case RTC_DEVICE_PROPERTY_BUILD_TOPLEVEL_NODES:
+      if (val != 0) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "top level node count can only get reset to 0");
+      buildTopLevelNodes = 0; return;
+    case RTC_DEVICE_PROPERTY_BLOCK_POOL_SIZE:
+      if (val < 0) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "invalid block pool size");
+      blockPool->setMaxBytes(val); return;
+    case RTC_DEVICE_PROPERTY_BLOCK_POOL_HITS:
+    case RTC_DEVICE_PROPERTY_BLOCK_POOL_MISSES:
+      if (val != 0) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "block pool counters can only get reset to 0");
+      blockPool->resetStatistics(); return;
+    default: break;
+    }
+
     throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "unknown writable property");
   }
 
@@ -449,6 +483,22 @@ namespace embree
     case RTC_DEVICE_PROPERTY_IGNORE_INVALID_RAYS_ENABLED: return 0;
 #endif
 
+    case RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_SIZE     : return tessellationCache->getSize();
+    case RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_HITS     : return tessellationCache->getStatistics().hits;
+    case RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_MISSES   : return tessellationCache->getStatistics().misses;
+    case RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_EVICTIONS: return tessellationCache->getStatistics().evictions;
+
+    case RTC_DEVICE_PROPERTY_BUILD_PRIMITIVES_TIME: return buildPhaseTime[BUILD_PHASE_PRIMITIVES];
+    case RTC_DEVICE_PROPERTY_BUILD_SORT_TIME      : return buildPhaseTime[BUILD_PHASE_SORT];
+    case RTC_DEVICE_PROPERTY_BUILD_HIERARCHY_TIME : return buildPhaseTime[BUILD_PHASE_HIERARCHY];
+    case RTC_DEVICE_PROPERTY_BUILD_TOPLEVEL_TIME  : return buildPhaseTime[BUILD_PHASE_TOPLEVEL];
+    case RTC_DEVICE_PROPERTY_BUILD_TOPLEVEL_NODES : return buildTopLevelNodes;
+
+    case RTC_DEVICE_PROPERTY_BLOCK_POOL_SIZE  : return blockPool->getMaxBytes();
+    case RTC_DEVICE_PROPERTY_BLOCK_POOL_BYTES : return blockPool->getStatistics().bytes;
+    case RTC_DEVICE_PROPERTY_BLOCK_POOL_HITS  : return blockPool->getStatistics().hits;
+    case RTC_DEVICE_PROPERTY_BLOCK_POOL_MISSES: return blockPool->getStatistics().misses;
+
 #if defined(TASKING_INTERNAL)
     case RTC_DEVICE_PROPERTY_TASKING_SYSTEM: return 0;
 #endif
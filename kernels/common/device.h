@@ -19,11 +19,13 @@
 #include "default.h"
 #include "state.h"
 #include "accel.h"
+#include "block_pool.h"
 
 namespace embree
 {
   class BVH4Factory;
   class BVH8Factory;
+  class SharedLazyTessellationCache;
 
   class Device : public State, public MemoryMonitorInterface
   {
@@ -31,6 +33,16 @@ namespace embree
 
   public:
 
+    /*! phases of a BVH build that get timed */
+    enum BuildPhase
+    {
+      BUILD_PHASE_PRIMITIVES = 0,   //!< creation of primitive references or morton codes
+      BUILD_PHASE_SORT       = 1,   //!< sorting of morton codes
+      BUILD_PHASE_HIERARCHY  = 2,   //!< creation of the BVH hierarchy
+      BUILD_PHASE_TOPLEVEL   = 3,   //!< creation of the top level BVH of two-level builders
+      BUILD_PHASES           = 4
+    };
+
     /*! Device construction */
     Device (const char* cfg);
 
@@ -58,7 +70,7 @@ namespace embree
     /*! invokes the memory monitor callback */
     void memoryMonitor(ssize_t bytes, bool post);
 
-    /*! sets the size of the software cache. */
+    /*! sets the size of the tessellation cache. */
     void setCacheSize(size_t bytes);
 
     /*! sets a property */
@@ -67,6 +79,19 @@ namespace embree
     /*! gets a property */
     ssize_t getProperty(const RTCDeviceProperty prop);
 
+    /*! accumulates the time spent in some build phase */
+    __forceinline void addBuildPhaseTime(BuildPhase phase, double dt) {
+      buildPhaseTime[phase] += size_t(1E6*dt);
+    }
+
+    /*! accumulates the number of top level nodes created by two-level builders */
+    __forceinline void addBuildTopLevelNodes(size_t n) {
+      buildTopLevelNodes += n;
+    }
+
+    /*! returns the NUMA node the calling thread runs on */
+    size_t numaNode() const;
+
   private:
 
     /*! initializes the tasking system */
@@ -87,6 +112,21 @@ namespace embree
 #if defined(EMBREE_TARGET_SIMD8)
     std::unique_ptr<BVH8Factory> bvh8_factory;
 #endif
+
+    /* cache for subdivision patches used during interpolation */
+    std::unique_ptr<SharedLazyTessellationCache> tessellationCache;
+
+    /* released allocator blocks recycled by the builds of all scenes */
+    std::unique_ptr<BlockPool> blockPool;
+
+    /* accumulated time in microseconds spent in each build phase */
+    std::atomic<size_t> buildPhaseTime[BUILD_PHASES];
+
+    /* accumulated number of top level nodes created by two-level builders */
+    std::atomic<size_t> buildTopLevelNodes;
+
+    /* number of NUMA nodes used for thread placement and memory allocation, 1 when NUMA support is disabled */
+    size_t numNumaNodes;
     
 #if USE_TASK_ARENA
     std::unique_ptr<tbb::task_arena> arena;
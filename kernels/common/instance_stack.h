@@ -0,0 +1,115 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "default.h"
+#include "rtcore.h"
+
+namespace embree
+{
+  /*
+   * The instance ID stack of the intersection context holds the geometry IDs
+   * of all instances that are currently entered by a ray. Entry 0 is the
+   * top-level instance, the deepest instance is stored last. All entries
+   * above the stack size are kept at RTC_INVALID_GEOMETRY_ID, thus hits can
+   * simply copy the complete stack.
+   */
+  namespace instance_id_stack
+  {
+    static_assert(RTC_MAX_INSTANCE_LEVEL_COUNT > 0,
+                  "RTC_MAX_INSTANCE_LEVEL_COUNT must be greater than 0.");
+
+#if RTC_MAX_INSTANCE_LEVEL_COUNT > 1
+
+    /* Returns the number of instances currently on the stack. */
+    __forceinline unsigned int size(const RTCIntersectContext* context) {
+      return context->instStackSize;
+    }
+
+    /* Pushes an instance to the stack. Returns false if the maximal
+     * instance level is reached and the instance cannot be entered. */
+    __forceinline bool push(RTCIntersectContext* context, unsigned int instanceId)
+    {
+      const bool spaceAvailable = context->instStackSize < RTC_MAX_INSTANCE_LEVEL_COUNT;
+      if (likely(spaceAvailable))
+        context->instID[context->instStackSize++] = instanceId;
+      return spaceAvailable;
+    }
+
+    /* Pops the last instance pushed to the stack. Do not call on an empty stack. */
+    __forceinline void pop(RTCIntersectContext* context)
+    {
+      assert(context->instStackSize > 0);
+      context->instID[--context->instStackSize] = RTC_INVALID_GEOMETRY_ID;
+    }
+
+#else
+
+    /* Specialization for a single instance level, the stack size is implicitly
+     * given by the only stack entry and not stored in the context. */
+    __forceinline unsigned int size(const RTCIntersectContext* context) {
+      return context->instID[0] != RTC_INVALID_GEOMETRY_ID;
+    }
+
+    __forceinline bool push(RTCIntersectContext* context, unsigned int instanceId)
+    {
+      const bool spaceAvailable = context->instID[0] == RTC_INVALID_GEOMETRY_ID;
+      if (likely(spaceAvailable))
+        context->instID[0] = instanceId;
+      return spaceAvailable;
+    }
+
+    __forceinline void pop(RTCIntersectContext* context)
+    {
+      assert(context->instID[0] != RTC_INVALID_GEOMETRY_ID);
+      context->instID[0] = RTC_INVALID_GEOMETRY_ID;
+    }
+
+#endif
+
+    /* Copies the full instance ID stack into a single hit. */
+    __forceinline void copy(const unsigned int* src, unsigned int* tgt)
+    {
+      for (unsigned l = 0; l < RTC_MAX_INSTANCE_LEVEL_COUNT; ++l)
+        tgt[l] = src[l];
+    }
+
+    /* Copies the full instance ID stack into a hit packet. */
+    template<typename vuintK>
+    __forceinline void copy(const unsigned int* src, vuintK* tgt)
+    {
+      for (unsigned l = 0; l < RTC_MAX_INSTANCE_LEVEL_COUNT; ++l)
+        tgt[l] = vuintK(src[l]);
+    }
+
+    /* Copies the full instance ID stack into the active lanes of a hit packet. */
+    template<typename vboolK, typename vuintK>
+    __forceinline void copy(const vboolK& valid, const unsigned int* src, vuintK* tgt)
+    {
+      for (unsigned l = 0; l < RTC_MAX_INSTANCE_LEVEL_COUNT; ++l)
+        vuintK::store(valid, &tgt[l], vuintK(src[l]));
+    }
+
+    /* Copies the full instance ID stack into lane k of a hit packet. */
+    template<typename vuintK>
+    __forceinline void copy(const unsigned int* src, vuintK* tgt, size_t k)
+    {
+      for (unsigned l = 0; l < RTC_MAX_INSTANCE_LEVEL_COUNT; ++l)
+        tgt[l][k] = src[l];
+    }
+  }
+}
@@ -0,0 +1,154 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "point_query.h"
+#include "scene.h"
+#include "scene_instance.h"
+#include "scene_triangle_mesh.h"
+#include "scene_quad_mesh.h"
+#include "../geometry/closest_point.h"
+
+namespace embree
+{
+  PointQueryContext::PointQueryContext (Scene* scene, RTCPointQuery* query, RTCPointQueryFunction func, void* userPtr, RTCClosestPoint* closest)
+    : scene(scene), query(query), func(func), userPtr(userPtr), closest(closest),
+      p(query->x,query->y,query->z), scale(1.0f), inst2world(one), instStackSize(0)
+  {
+    for (unsigned l = 0; l < RTC_MAX_INSTANCE_LEVEL_COUNT; l++)
+      instID[l] = RTC_INVALID_GEOMETRY_ID;
+  }
+
+  bool PointQueryContext::primitive(unsigned int geomID, unsigned int primID)
+  {
+    Geometry* geometry = scene->get(geomID);
+    if (geometry->getType() == Geometry::GTY_INSTANCE)
+      return instance((Instance*)geometry);
+
+    if (func) return callQueryFunction(geomID,primID);
+    else      return closestPoint(geometry,geomID,primID);
+  }
+
+  bool PointQueryContext::instance(const Instance* instance)
+  {
+    /* deeper instance levels than supported are ignored like for rays */
+    if (instStackSize >= RTC_MAX_INSTANCE_LEVEL_COUNT)
+      return false;
+
+    AffineSpace3fa local2world = instance->local2world[0];
+    if (instance->numTimeSteps > 1) {
+      float ftime; const int itime = getTimeSegment(time(), instance->fnumTimeSegments, ftime);
+      local2world = lerp(instance->local2world[itime+0],instance->local2world[itime+1],ftime);
+    }
+
+    /* enter instance */
+    Scene* scene0 = scene; const Vec3fa p0 = p; const float scale0 = scale; const AffineSpace3fa inst2world0 = inst2world;
+    inst2world = inst2world0*local2world;
+    const AffineSpace3fa world2inst = rcp(inst2world);
+    scene = (Scene*) instance->object;
+    p = xfmPoint(world2inst,Vec3fa(query->x,query->y,query->z));
+    scale = sqrt(dot(world2inst.l.vx,world2inst.l.vx) + dot(world2inst.l.vy,world2inst.l.vy) + dot(world2inst.l.vz,world2inst.l.vz));
+    instID[instStackSize++] = instance->geomID;
+
+    const bool changed = instance->object->pointQuery(this);
+
+    /* leave instance */
+    instID[--instStackSize] = RTC_INVALID_GEOMETRY_ID;
+    scene = scene0; p = p0; scale = scale0; inst2world = inst2world0;
+    return changed;
+  }
+
+  bool PointQueryContext::callQueryFunction(unsigned int geomID, unsigned int primID)
+  {
+    RTCPointQueryFunctionArguments args;
+    args.query = query;
+    args.userPtr = userPtr;
+    args.primID = primID;
+    args.geomID = geomID;
+    for (unsigned l = 0; l < RTC_MAX_INSTANCE_LEVEL_COUNT; l++)
+      args.instID[l] = instID[l];
+
+    const Vec3fa* cols[4] = { &inst2world.l.vx, &inst2world.l.vy, &inst2world.l.vz, &inst2world.p };
+    for (size_t c = 0; c < 4; c++) {
+      args.inst2world[4*c+0] = cols[c]->x;
+      args.inst2world[4*c+1] = cols[c]->y;
+      args.inst2world[4*c+2] = cols[c]->z;
+      args.inst2world[4*c+3] = (c == 3) ? 1.0f : 0.0f;
+    }
+    return func(&args);
+  }
+
+  bool PointQueryContext::closestPoint(const Geometry* geometry, unsigned int geomID, unsigned int primID)
+  {
+    /* gather the vertices of the primitive at the query time */
+    Vec3fa vtx[4];
+    size_t numVertices = 0;
+    float ftime = 0.0f; size_t itime0 = 0, itime1 = 0;
+    if (geometry->numTimeSteps > 1) {
+      itime0 = getTimeSegment(time(), geometry->fnumTimeSegments, ftime);
+      itime1 = itime0+1;
+    }
+
+    if (geometry->getType() == Geometry::GTY_TRIANGLE_MESH)
+    {
+      const TriangleMesh* mesh = (const TriangleMesh*) geometry;
+      const TriangleMesh::Triangle& tri = mesh->triangle(primID);
+      for (size_t i = 0; i < 3; i++)
+        vtx[i] = lerp(mesh->vertex(tri.v[i],itime0),mesh->vertex(tri.v[i],itime1),ftime);
+      numVertices = 3;
+    }
+    else if (geometry->getType() == Geometry::GTY_QUAD_MESH)
+    {
+      const QuadMesh* mesh = (const QuadMesh*) geometry;
+      const QuadMesh::Quad& quad = mesh->quad(primID);
+      for (size_t i = 0; i < 4; i++)
+        vtx[i] = lerp(mesh->vertex(quad.v[i],itime0),mesh->vertex(quad.v[i],itime1),ftime);
+      numVertices = 4;
+    }
+    else
+      return false;
+
+    /* the distance is measured in world space */
+    for (size_t i = 0; i < numVertices; i++)
+      vtx[i] = xfmPoint(inst2world,vtx[i]);
+
+    const Vec3fa q(query->x,query->y,query->z);
+    float u,v;
+    Vec3fa c = closestPointTriangle(q,vtx[0],vtx[1],vtx[numVertices-1],u,v);
+
+    /* quads are split into the triangles (v0,v1,v3) and (v2,v3,v1) */
+    if (numVertices == 4)
+    {
+      float u1,v1;
+      const Vec3fa c1 = closestPointTriangle(q,vtx[2],vtx[3],vtx[1],u1,v1);
+      if (dot(c1-q,c1-q) < dot(c-q,c-q)) {
+        c = c1; u = 1.0f-u1; v = 1.0f-v1;
+      }
+    }
+
+    const float dist = length(c-q);
+    if (dist >= query->radius)
+      return false;
+
+    query->radius = dist;
+    closest->x = c.x; closest->y = c.y; closest->z = c.z;
+    closest->u = u; closest->v = v;
+    closest->primID = primID;
+    closest->geomID = geomID;
+    for (unsigned l = 0; l < RTC_MAX_INSTANCE_LEVEL_COUNT; l++)
+      closest->instID[l] = instID[l];
+    return true;
+  }
+}
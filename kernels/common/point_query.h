@@ -0,0 +1,72 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "default.h"
+#include "rtcore.h"
+
+namespace embree
+{
+  class Scene;
+  class Geometry;
+  struct Instance;
+
+  /*! Traversal state of a point query. The query itself is always kept in
+   *  world space, the context tracks the query point and a conservative
+   *  scaling of the query radius for the currently entered instance. */
+  struct PointQueryContext
+  {
+    PointQueryContext (Scene* scene, RTCPointQuery* query, RTCPointQueryFunction func, void* userPtr, RTCClosestPoint* closest);
+
+    /*! query point in the space of the current instance */
+    __forceinline const Vec3fa& point() const { return p; }
+
+    /*! conservative query radius in the space of the current instance */
+    __forceinline float radius() const { return query->radius*scale; }
+
+    /*! time of the point query */
+    __forceinline float time() const { return query->time; }
+
+    /*! processes a primitive of the current scene, returns true if the query radius got reduced */
+    bool primitive(unsigned int geomID, unsigned int primID);
+
+    /*! processes all primitives of an instanced scene, returns true if the query radius got reduced */
+    bool instance(const Instance* instance);
+
+  private:
+
+    /*! calls the user query function for a primitive */
+    bool callQueryFunction(unsigned int geomID, unsigned int primID);
+
+    /*! built-in closest point kernel for triangles and quads */
+    bool closestPoint(const Geometry* geometry, unsigned int geomID, unsigned int primID);
+
+  public:
+    Scene* scene;                   //!< scene currently traversed
+    RTCPointQuery* query;           //!< point query in world space
+    RTCPointQueryFunction func;     //!< user query function, or nullptr for closest point queries
+    void* userPtr;                  //!< user pointer passed to the query function
+    RTCClosestPoint* closest;       //!< closest point result of closest point queries
+
+    Vec3fa p;                       //!< query point in instance space
+    float scale;                    //!< scales world space to instance space radii
+    AffineSpace3fa inst2world;      //!< transformation from instance space to world space
+
+    unsigned int instStackSize;                          //!< number of instances currently entered
+    unsigned int instID[RTC_MAX_INSTANCE_LEVEL_COUNT];   //!< geomIDs of the currently entered instances
+  };
+}
@@ -24,6 +24,8 @@
 #include "device.h"
 #include "scene.h"
 #include "context.h"
+#include "point_query.h"
+#include "collide.h"
 #include "../../include/embree3/rtcore_ray.h"
 
 namespace embree
@@ -227,6 +229,16 @@ namespace embree
     RTC_CATCH_END2(scene);
     return RTC_SCENE_FLAG_NONE;
   }
+
+  RTC_API void rtcSetSceneMemoryBudget (RTCScene hscene, size_t bytes)
+  {
+    Scene* scene = (Scene*) hscene;
+    RTC_CATCH_BEGIN;
+    RTC_TRACE(rtcSetSceneMemoryBudget);
+    RTC_VERIFY_HANDLE(hscene);
+    scene->setMemoryBudget(bytes);
+    RTC_CATCH_END2(scene);
+  }
   
   RTC_API void rtcCommitScene (RTCScene hscene) 
   {
@@ -234,6 +246,7 @@ namespace embree
     RTC_CATCH_BEGIN;
     RTC_TRACE(rtcCommitScene);
     RTC_VERIFY_HANDLE(hscene);
+    scene->waitCommitAsync();
     scene->commit(false);
     RTC_CATCH_END2(scene);
   }
@@ -244,10 +257,57 @@ namespace embree
     RTC_CATCH_BEGIN;
     RTC_TRACE(rtcJoinCommitScene);
     RTC_VERIFY_HANDLE(hscene);
+    scene->waitCommitAsync();
     scene->commit(true);
     RTC_CATCH_END2(scene);
   }
 
+  RTC_API void rtcCommitSceneAsync (RTCScene hscene, RTCCommitSceneFunction complete, void* userPtr) 
+  {
+    Scene* scene = (Scene*) hscene;
+    RTC_CATCH_BEGIN;
+    RTC_TRACE(rtcCommitSceneAsync);
+    RTC_VERIFY_HANDLE(hscene);
+    scene->commitAsync(complete,userPtr);
+    RTC_CATCH_END2(scene);
+  }
+
+  RTC_API bool rtcIsSceneCommitDone (RTCScene hscene) 
+  {
+    Scene* scene = (Scene*) hscene;
+    RTC_CATCH_BEGIN;
+    RTC_TRACE(rtcIsSceneCommitDone);
+    RTC_VERIFY_HANDLE(hscene);
+    return scene->isCommitDone();
+    RTC_CATCH_END2(scene);
+    return true;
+  }
+
+  RTC_API void rtcSaveSceneBVH (RTCScene hscene, const char* fileName)
+  {
+    Scene* scene = (Scene*) hscene;
+    RTC_CATCH_BEGIN;
+    RTC_TRACE(rtcSaveSceneBVH);
+    RTC_VERIFY_HANDLE(hscene);
+    RTC_VERIFY_HANDLE(fileName);
+    if (scene->isModified()) throw_RTCError(RTC_ERROR_INVALID_OPERATION,"scene got not committed");
+    scene->waitCommitAsync();
+    scene->saveBVH(fileName);
+    RTC_CATCH_END2(scene);
+  }
+
+  RTC_API void rtcLoadSceneBVH (RTCScene hscene, const char* fileName)
+  {
+    Scene* scene = (Scene*) hscene;
+    RTC_CATCH_BEGIN;
+    RTC_TRACE(rtcLoadSceneBVH);
+    RTC_VERIFY_HANDLE(hscene);
+    RTC_VERIFY_HANDLE(fileName);
+    scene->waitCommitAsync();
+    scene->loadBVH(fileName);
+    RTC_CATCH_END2(scene);
+  }
+
   RTC_API void rtcGetSceneBounds(RTCScene hscene, RTCBounds* bounds_o)
   {
     Scene* scene = (Scene*) hscene;
@@ -296,7 +356,86 @@ namespace embree
     bounds_o->bounds1.align1  = 0;
     RTC_CATCH_END2(scene);
   }
-  
+
+  RTC_API bool rtcPointQuery(RTCScene hscene, RTCPointQuery* query, RTCPointQueryFunction queryFunc, void* userPtr)
+  {
+    Scene* scene = (Scene*) hscene;
+    RTC_CATCH_BEGIN;
+    RTC_TRACE(rtcPointQuery);
+#if defined(DEBUG)
+    RTC_VERIFY_HANDLE(hscene);
+    if (scene->isModified()) throw_RTCError(RTC_ERROR_INVALID_OPERATION,"scene got not committed");
+    if (((size_t)query) & 0x0F) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "query not aligned to 16 bytes");
+#endif
+    if (queryFunc == nullptr) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "invalid query function");
+    PointQueryContext context(scene,query,queryFunc,userPtr,nullptr);
+    return scene->pointQuery(&context);
+    RTC_CATCH_END2(scene);
+    return false;
+  }
+
+  RTC_API bool rtcClosestPoint(RTCScene hscene, RTCPointQuery* query, RTCClosestPoint* result)
+  {
+    Scene* scene = (Scene*) hscene;
+    RTC_CATCH_BEGIN;
+    RTC_TRACE(rtcClosestPoint);
+#if defined(DEBUG)
+    RTC_VERIFY_HANDLE(hscene);
+    if (scene->isModified()) throw_RTCError(RTC_ERROR_INVALID_OPERATION,"scene got not committed");
+    if (((size_t)query) & 0x0F) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "query not aligned to 16 bytes");
+    if (((size_t)result) & 0x0F) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "result not aligned to 16 bytes");
+#endif
+    result->primID = RTC_INVALID_GEOMETRY_ID;
+    result->geomID = RTC_INVALID_GEOMETRY_ID;
+    for (unsigned l = 0; l < RTC_MAX_INSTANCE_LEVEL_COUNT; l++)
+      result->instID[l] = RTC_INVALID_GEOMETRY_ID;
+    PointQueryContext context(scene,query,nullptr,nullptr,result);
+    return scene->pointQuery(&context);
+    RTC_CATCH_END2(scene);
+    return false;
+  }
+
+  RTC_API void rtcCollide(RTCScene hscene0, RTCScene hscene1, RTCCollideFunc callback, void* userPtr)
+  {
+    Scene* scene0 = (Scene*) hscene0;
+    Scene* scene1 = (Scene*) hscene1;
+    RTC_CATCH_BEGIN;
+    RTC_TRACE(rtcCollide);
+#if defined(DEBUG)
+    RTC_VERIFY_HANDLE(hscene0);
+    RTC_VERIFY_HANDLE(hscene1);
+    if (scene0->isModified()) throw_RTCError(RTC_ERROR_INVALID_OPERATION,"scene got not committed");
+    if (scene1->isModified()) throw_RTCError(RTC_ERROR_INVALID_OPERATION,"scene got not committed");
+#endif
+    if (callback == nullptr) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT,"invalid collision callback");
+    if (scene0->device != scene1->device) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT,"scenes belong to different devices");
+    CollideContext context(callback,userPtr);
+    scene0->collide(scene1,&context);
+    RTC_CATCH_END2(scene0);
+  }
+
+  RTC_API void rtcGetSceneStatistics(RTCScene hscene, RTCSceneStatistics* statistics)
+  {
+    Scene* scene = (Scene*) hscene;
+    RTC_CATCH_BEGIN;
+    RTC_TRACE(rtcGetSceneStatistics);
+    RTC_VERIFY_HANDLE(hscene);
+    if (statistics == nullptr)
+      throw_RTCError(RTC_ERROR_INVALID_ARGUMENT,"invalid destination pointer");
+    scene->statistics.get(*statistics);
+    RTC_CATCH_END2(scene);
+  }
+
+  RTC_API void rtcResetSceneStatistics(RTCScene hscene)
+  {
+    Scene* scene = (Scene*) hscene;
+    RTC_CATCH_BEGIN;
+    RTC_TRACE(rtcResetSceneStatistics);
+    RTC_VERIFY_HANDLE(hscene);
+    scene->statistics.clear();
+    RTC_CATCH_END2(scene);
+  }
+
   RTC_API void rtcIntersect1 (RTCScene hscene, RTCIntersectContext* user_context, RTCRayHit* rayhit) 
   {
     Scene* scene = (Scene*) hscene;
@@ -308,7 +447,8 @@ namespace embree
     if (((size_t)rayhit) & 0x0F) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "ray not aligned to 16 bytes");   
 #endif
     STAT3(normal.travs,1,1,1);
-    IntersectContext context(scene,user_context);
+    IntersectContext context(scene,user_context,scene->traversalCounters());
+    if (unlikely(context.stats)) context.stats->intersect.addRays(1);
     scene->intersectors.intersect(*rayhit,&context);
 #if defined(DEBUG)
     ((RayHit*)rayhit)->verifyHit();
@@ -331,7 +471,8 @@ namespace embree
     STAT(size_t cnt=0; for (size_t i=0; i<4; i++) cnt += ((int*)valid)[i] == -1;);
     STAT3(normal.travs,cnt,cnt,cnt);
 
-    IntersectContext context(scene,user_context);
+    IntersectContext context(scene,user_context,scene->traversalCounters());
+    if (unlikely(context.stats)) context.stats->intersect.addRays(valid,4);
 #if !defined(EMBREE_RAY_PACKETS)
     Ray4* ray4 = (Ray4*) rayhit;
     for (size_t i=0; i<4; i++) {
@@ -362,7 +503,8 @@ namespace embree
     STAT(size_t cnt=0; for (size_t i=0; i<8; i++) cnt += ((int*)valid)[i] == -1;);
     STAT3(normal.travs,cnt,cnt,cnt);
 
-    IntersectContext context(scene,user_context);
+    IntersectContext context(scene,user_context,scene->traversalCounters());
+    if (unlikely(context.stats)) context.stats->intersect.addRays(valid,8);
 #if !defined(EMBREE_RAY_PACKETS)
     Ray8* ray8 = (Ray8*) rayhit;
     for (size_t i=0; i<8; i++) {
@@ -395,7 +537,8 @@ namespace embree
     STAT(size_t cnt=0; for (size_t i=0; i<16; i++) cnt += ((int*)valid)[i] == -1;);
     STAT3(normal.travs,cnt,cnt,cnt);
 
-    IntersectContext context(scene,user_context);
+    IntersectContext context(scene,user_context,scene->traversalCounters());
+    if (unlikely(context.stats)) context.stats->intersect.addRays(valid,16);
 #if !defined(EMBREE_RAY_PACKETS)
     Ray16* ray16 = (Ray16*) rayhit;
     for (size_t i=0; i<16; i++) {
@@ -426,7 +569,8 @@ namespace embree
     if (((size_t)rayhit ) & 0x03) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "ray not aligned to 4 bytes");   
 #endif
     STAT3(normal.travs,M,M,M);
-    IntersectContext context(scene,user_context);
+    IntersectContext context(scene,user_context,scene->traversalCounters());
+    if (unlikely(context.stats)) context.stats->intersect.addRays(M);
 
     /* fast codepath for single rays */
     if (likely(M == 1)) {
@@ -457,7 +601,8 @@ namespace embree
     if (((size_t)rn) & 0x03) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "ray not aligned to 4 bytes");   
 #endif
     STAT3(normal.travs,M,M,M);
-    IntersectContext context(scene,user_context);
+    IntersectContext context(scene,user_context,scene->traversalCounters());
+    if (unlikely(context.stats)) context.stats->intersect.addRays(M);
 
     /* fast codepath for single rays */
     if (likely(M == 1)) {
@@ -488,7 +633,8 @@ namespace embree
     if (((size_t)rayhit) & 0x03) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "ray not aligned to 4 bytes");   
 #endif
     STAT3(normal.travs,N*M,N*M,N*M);
-    IntersectContext context(scene,user_context);
+    IntersectContext context(scene,user_context,scene->traversalCounters());
+    if (unlikely(context.stats)) context.stats->intersect.addRays(N*M);
 
     /* code path for single ray streams */
     if (likely(N == 1))
@@ -540,10 +686,12 @@ namespace embree
     if (((size_t)rayhit->hit.v     ) & 0x03 ) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "rayhit->hit.v not aligned to 4 bytes");   
     if (((size_t)rayhit->hit.geomID) & 0x03 ) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "rayhit->hit.geomID not aligned to 4 bytes");   
     if (((size_t)rayhit->hit.primID) & 0x03 ) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "rayhit->hit.primID not aligned to 4 bytes");   
-    if (((size_t)rayhit->hit.instID) & 0x03 ) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "rayhit->hit.instID not aligned to 4 bytes");   
+    for (unsigned l = 0; l < RTC_MAX_INSTANCE_LEVEL_COUNT; ++l)
+      if (((size_t)rayhit->hit.instID[l]) & 0x03 ) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "rayhit->hit.instID not aligned to 4 bytes");   
 #endif
     STAT3(normal.travs,N,N,N);
-    IntersectContext context(scene,user_context);
+    IntersectContext context(scene,user_context,scene->traversalCounters());
+    if (unlikely(context.stats)) context.stats->intersect.addRays(N);
     scene->device->rayStreamFilters.intersectSOP(scene,rayhit,N,&context);
 #else
     throw_RTCError(RTC_ERROR_INVALID_OPERATION,"rtcIntersectNp not supported");
@@ -562,7 +710,8 @@ namespace embree
     if (scene->isModified()) throw_RTCError(RTC_ERROR_INVALID_OPERATION,"scene got not committed");
     if (((size_t)ray) & 0x0F) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "ray not aligned to 16 bytes");   
 #endif
-    IntersectContext context(scene,user_context);
+    IntersectContext context(scene,user_context,scene->traversalCounters());
+    if (unlikely(context.stats)) context.stats->occluded.addRays(1);
     scene->intersectors.occluded(*ray,&context);
     RTC_CATCH_END2(scene);
   }
@@ -582,7 +731,8 @@ namespace embree
     STAT(size_t cnt=0; for (size_t i=0; i<4; i++) cnt += ((int*)valid)[i] == -1;);
     STAT3(shadow.travs,cnt,cnt,cnt);
 
-    IntersectContext context(scene,user_context);
+    IntersectContext context(scene,user_context,scene->traversalCounters());
+    if (unlikely(context.stats)) context.stats->occluded.addRays(valid,4);
 #if !defined(EMBREE_RAY_PACKETS)
     RayHit4* ray4 = (RayHit4*) ray;
     for (size_t i=0; i<4; i++) {
@@ -613,7 +763,8 @@ namespace embree
     STAT(size_t cnt=0; for (size_t i=0; i<8; i++) cnt += ((int*)valid)[i] == -1;);
     STAT3(shadow.travs,cnt,cnt,cnt);
 
-    IntersectContext context(scene,user_context);
+    IntersectContext context(scene,user_context,scene->traversalCounters());
+    if (unlikely(context.stats)) context.stats->occluded.addRays(valid,8);
 #if !defined(EMBREE_RAY_PACKETS)
     RayHit8* ray8 = (RayHit8*) ray;
     for (size_t i=0; i<8; i++) {
@@ -647,7 +798,8 @@ namespace embree
     STAT(size_t cnt=0; for (size_t i=0; i<16; i++) cnt += ((int*)valid)[i] == -1;);
     STAT3(shadow.travs,cnt,cnt,cnt);
 
-    IntersectContext context(scene,user_context);
+    IntersectContext context(scene,user_context,scene->traversalCounters());
+    if (unlikely(context.stats)) context.stats->occluded.addRays(valid,16);
 #if !defined(EMBREE_RAY_PACKETS)
     RayHit16* ray16 = (RayHit16*) ray;
     for (size_t i=0; i<16; i++) {
@@ -679,7 +831,8 @@ namespace embree
     if (((size_t)ray) & 0x03) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "ray not aligned to 4 bytes");   
 #endif
     STAT3(shadow.travs,M,M,M);
-    IntersectContext context(scene,user_context);
+    IntersectContext context(scene,user_context,scene->traversalCounters());
+    if (unlikely(context.stats)) context.stats->occluded.addRays(M);
     /* fast codepath for streams of size 1 */
     if (likely(M == 1)) {
       if (likely(ray->tnear <= ray->tfar)) 
@@ -708,7 +861,8 @@ namespace embree
     if (((size_t)ray) & 0x03) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "ray not aligned to 4 bytes");   
 #endif
     STAT3(shadow.travs,M,M,M);
-    IntersectContext context(scene,user_context);
+    IntersectContext context(scene,user_context,scene->traversalCounters());
+    if (unlikely(context.stats)) context.stats->occluded.addRays(M);
 
     /* fast codepath for streams of size 1 */
     if (likely(M == 1)) {
@@ -739,7 +893,8 @@ namespace embree
     if (((size_t)ray) & 0x03) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "ray not aligned to 4 bytes");   
 #endif
     STAT3(shadow.travs,N*M,N*N,N*N);
-    IntersectContext context(scene,user_context);
+    IntersectContext context(scene,user_context,scene->traversalCounters());
+    if (unlikely(context.stats)) context.stats->occluded.addRays(N*M);
 
     /* codepath for single rays */
     if (likely(N == 1))
@@ -786,7 +941,8 @@ namespace embree
     if (((size_t)ray->mask  ) & 0x03 ) throw_RTCError(RTC_ERROR_INVALID_ARGUMENT, "mask not aligned to 4 bytes");   
 #endif
     STAT3(shadow.travs,N,N,N);
-    IntersectContext context(scene,user_context);
+    IntersectContext context(scene,user_context,scene->traversalCounters());
+    if (unlikely(context.stats)) context.stats->occluded.addRays(N);
     scene->device->rayStreamFilters.occludedSOP(scene,ray,N,&context);
 #else
     throw_RTCError(RTC_ERROR_INVALID_OPERATION,"rtcOccludedNp not supported");
@@ -18,6 +18,9 @@
 
 #include "../bvh/bvh4_factory.h"
 #include "../bvh/bvh8_factory.h"
+
+#include "../geometry/triangle.h"
+#include "../geometry/quadv.h"
  
 namespace embree
 {
@@ -35,7 +38,10 @@ namespace embree
       flags_modified(true),
       scene_flags(RTC_SCENE_FLAG_NONE),
       quality_flags(RTC_BUILD_QUALITY_MEDIUM),
-      is_build(false), modified(true),
+      is_build(false), modified(true), commitCounter(0),
+      memory_budget(0), memory_used(0), budget_compact(false),
+      async_front(0), async_active(false), async_commit(false), async_done(true), async_thread(nullptr),
+      async_function(nullptr), async_function_ptr(nullptr), numa_replica_bytes(0),
       progressInterface(this), progress_monitor_function(nullptr), progress_monitor_ptr(nullptr), progress_monitor_counter(0), 
       numIntersectionFiltersN(0)
   {
@@ -60,6 +66,9 @@ namespace embree
 
   Scene::~Scene () 
   {
+    waitCommitAsync();
+    clearReplicas();
+
 #if defined(TASKING_TBB) || defined(TASKING_PPL)
     delete group; group = nullptr;
 #endif
@@ -118,12 +127,32 @@ namespace embree
     }
   }
 
+  void Scene::createAccels()
+  {
+    createTriangleAccel();
+    createTriangleMBAccel();
+    createQuadAccel();
+    createQuadMBAccel();
+    createGridAccel();
+    createGridMBAccel();
+    createSubdivAccel();
+    createSubdivMBAccel();
+    createHairAccel();
+    createHairMBAccel();
+    createUserGeometryAccel();
+    createUserGeometryMBAccel();
+    createInstanceAccel();
+    createInstanceMBAccel();
+  }
+
   void Scene::createTriangleAccel()
   {
 #if defined(EMBREE_GEOMETRY_TRIANGLE)
     if (device->tri_accel == "default") 
     {
-      if (quality_flags != RTC_BUILD_QUALITY_LOW)
+      if (isCompressedAccel())
+        accels.add(device->bvh4_factory->BVH4QuantizedTriangle4i(this));
+      else if (quality_flags != RTC_BUILD_QUALITY_LOW)
       {
         int mode =  2*(int)isCompactAccel() + 1*(int)isRobustAccel(); 
         switch (mode) {
@@ -244,7 +273,9 @@ namespace embree
 #if defined(EMBREE_GEOMETRY_QUAD)
     if (device->quad_accel == "default") 
     {
-      if (quality_flags != RTC_BUILD_QUALITY_LOW)
+      if (isCompressedAccel())
+        accels.add(device->bvh4_factory->BVH4QuantizedQuad4i(this));
+      else if (quality_flags != RTC_BUILD_QUALITY_LOW)
       {
         /* static */
         int mode =  2*(int)isCompactAccel() + 1*(int)isRobustAccel(); 
@@ -496,12 +527,17 @@ namespace embree
 #if defined(EMBREE_GEOMETRY_INSTANCE)
     //if (device->object_accel == "default") 
     {
+      /* dynamic scenes keep their accels and update the instance level incrementally */
+      BVHFactory::BuildVariant bvariant = isDynamicAccel() ? BVHFactory::BuildVariant::DYNAMIC : BVHFactory::BuildVariant::STATIC;
+      if (isCompressedAccel())
+        accels.add(device->bvh4_factory->BVH4QuantizedInstance(this));
+      else
 #if defined (EMBREE_TARGET_SIMD8)
       if (device->hasISA(AVX) && !isCompactAccel())
-        accels.add(device->bvh8_factory->BVH8Instance(this,BVHFactory::BuildVariant::STATIC));
+        accels.add(device->bvh8_factory->BVH8Instance(this,bvariant));
       else
 #endif
-        accels.add(device->bvh4_factory->BVH4Instance(this,BVHFactory::BuildVariant::STATIC));
+        accels.add(device->bvh4_factory->BVH4Instance(this,bvariant));
     }
     //else throw_RTCError(RTC_ERROR_INVALID_ARGUMENT,"unknown instance accel "+device->instance_accel);
 #endif
@@ -620,38 +656,41 @@ namespace embree
 
     progress_monitor_counter = 0;
 
+    /* rays do not traverse the copies of the last commit anymore, asynchronous commits keep them alive as rays may still traverse them */
+    if (!async_commit)
+      clearReplicas();
+
     /* call preCommit function of each geometry */
     parallel_for(geometries.size(), [&] ( const size_t i ) {
         if (geometries[i] && geometries[i]->isEnabled())
           geometries[i]->preCommit();
       });
 
+    /* select compact primitive layouts if the fast ones would not fit into the memory budget */
+    const bool compact = memory_budget && estimatedFastAccelBytes() > memory_budget;
+    if (compact != budget_compact) {
+      budget_compact = compact;
+      flags_modified = true;
+    }
+
+    /* asynchronous commits build new acceleration structures as rays still traverse the ones of the last commit */
+    if (async_commit || async_active)
+      flags_modified = true;
+
     /* select acceleration structures to build */
     if (flags_modified)
     {    
       accels.init();
-      createTriangleAccel();
-      createTriangleMBAccel();
-      createQuadAccel();
-      createQuadMBAccel();
-      createGridAccel();
-      createGridMBAccel();
-      createSubdivAccel();
-      createSubdivMBAccel();
-      createHairAccel();
-      createHairMBAccel();
-      createUserGeometryAccel();
-      createUserGeometryMBAccel();
-      createInstanceAccel();
-      createInstanceMBAccel();
+      createAccels();
       flags_modified = false;
     }
     
     /* select fast code path if no filter function is present */
     accels.select(hasFilterFunction());
   
-    /* build all hierarchies of this scene */
-    accels.build();
+    /* build all hierarchies of this scene, or map them from a BVH file */
+    if (image) accels.load(image.ptr);
+    else       accels.build();
 
     /* make static geometry immutable */
     if (!isDynamicAccel()) {
@@ -664,8 +703,20 @@ namespace embree
         if (geometries[i] && geometries[i]->isEnabled())
           geometries[i]->postCommit();
       });
-      
-    updateInterface();
+
+    if (async_commit)
+      publishAsync();
+    else {
+      updateInterface();
+      replicateAccels();
+    }
+
+    /* rays traverse accels again, release the acceleration structures of asynchronous commits */
+    if (!async_commit && async_active) {
+      async_accels[0].init();
+      async_accels[1].init();
+      async_active = false;
+    }
 
     if (device->verbosity(2)) {
       std::cout << "created scene intersector" << std::endl;
@@ -674,9 +725,147 @@ namespace embree
       intersectors.print(2);
     }
     
+    commitCounter++;
     setModified(false);
   }
 
+  static GeometryImageHeader geometryImageHeader(const Geometry* geometry)
+  {
+    GeometryImageHeader header;
+    header.type          = geometry ? geometry->getType() : Geometry::GTY_END;
+    header.enabled       = geometry ? geometry->isEnabled() : 0;
+    header.numPrimitives = geometry ? geometry->numPrimitives : 0;
+    header.numTimeSteps  = geometry ? geometry->numTimeSteps : 0;
+    return header;
+  }
+
+  void Scene::saveBVH(const std::string& fileName)
+  {
+    std::ofstream stream(fileName,std::ios::out | std::ios::binary);
+    if (!stream.is_open())
+      throw_RTCError(RTC_ERROR_INVALID_ARGUMENT,"cannot open BVH file " + fileName);
+
+    if (!saveBVH(stream,tracedAccels()))
+      throw_RTCError(RTC_ERROR_INVALID_OPERATION,"scene contains acceleration structures that cannot get saved");
+
+    stream.close();
+    if (stream.fail())
+      throw_RTCError(RTC_ERROR_UNKNOWN,"error writing BVH file " + fileName);
+  }
+
+  bool Scene::saveBVH(std::ostream& stream, AccelN& traced)
+  {
+    /* write headers, the acceleration structure headers get completed after writing the data */
+    const SceneImageHeader header = SceneImage::createHeader(geometries.size(),traced.accels.size());
+    stream.write((const char*)&header,sizeof(header));
+    for (size_t i=0; i<geometries.size(); i++) {
+      const GeometryImageHeader geometry = geometryImageHeader(geometries[i].ptr);
+      stream.write((const char*)&geometry,sizeof(geometry));
+    }
+    const size_t accelHeaderOffset = (size_t) stream.tellp();
+    std::vector<AccelImageHeader> accelHeaders(traced.accels.size());
+    memset(accelHeaders.data(),0,accelHeaders.size()*sizeof(AccelImageHeader));
+    stream.write((const char*)accelHeaders.data(),accelHeaders.size()*sizeof(AccelImageHeader));
+
+    /* write the node and leaf data of all acceleration structures */
+    for (size_t i=0; i<traced.accels.size(); i++) {
+      SceneImage::align(stream,SceneImage::dataAlignment);
+      if (!traced.accels[i]->save(stream,accelHeaders[i]))
+        return false;
+    }
+
+    stream.seekp(accelHeaderOffset);
+    stream.write((const char*)accelHeaders.data(),accelHeaders.size()*sizeof(AccelImageHeader));
+    return true;
+  }
+
+  void Scene::loadBVH(const std::string& fileName)
+  {
+    Ref<SceneImage> image = new SceneImage(fileName);
+
+    /* the BVHs have to be built over the same geometries */
+    bool valid = image->header().numGeometries == geometries.size();
+    for (size_t i=0; valid && i<geometries.size(); i++) {
+      const GeometryImageHeader geometry = geometryImageHeader(geometries[i].ptr);
+      valid = memcmp(&geometry,&image->geometries()[i],sizeof(GeometryImageHeader)) == 0;
+    }
+    if (!valid)
+      throw_RTCError(RTC_ERROR_INVALID_OPERATION,"BVH file does not match scene geometries");
+
+    /* commit maps the acceleration structures instead of building them */
+    this->image = image;
+    setModified();
+    try {
+      commit(false);
+    } catch (...) {
+      this->image = nullptr;
+      throw;
+    }
+    this->image = nullptr;
+  }
+
+  void Scene::replicateAccels()
+  {
+    /* only the read-only acceleration structures of large static scenes get copied */
+    const size_t numNodes = device->numNumaNodes;
+    if (numNodes <= 1 || isDynamicAccel()) return;
+    if (size_t(max(memory_used.load(),ssize_t(0))) < device->numa_replication_threshold) return;
+
+    /* serialize all acceleration structures once, either all of them get copied or none */
+    std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+    if (!saveBVH(stream,accels) || stream.fail()) return;
+    const std::string data = stream.str();
+
+    const ssize_t bytes = ssize_t(numNodes*data.size());
+    try {
+      memoryMonitor(bytes,false);
+    } catch (...) {
+      return; // no copies if they do not fit into the memory budget
+    }
+
+    /* map the serialized acceleration structures from a copy on each node,
+     * the acceleration structures get created the same way as for the
+     * original to match the stored ones */
+    std::unique_ptr<AccelReplicas> replicas(new AccelReplicas(device));
+    darray_t<Accel*,24> original = accels.accels;
+    try {
+      for (size_t node=0; node<numNodes; node++)
+      {
+        accels.accels.clear();
+        Ref<SceneImage> image = new SceneImage(data.data(),data.size(),node);
+        createAccels();
+
+        AccelN* replica = new AccelN;
+        replica->accels = accels.accels;
+        accels.accels.clear();
+        replicas->add(replica);
+        replica->select(hasFilterFunction());
+        replica->load(image.ptr);
+      }
+    } catch (...) {
+      accels.init();
+      accels.accels = original;
+      accels.updateValidAccels();
+      memoryMonitor(-bytes,true);
+      return;
+    }
+    accels.accels = original;
+    accels.updateValidAccels();
+    replicas->updateIntersectors();
+
+    numa_replicas = std::move(replicas);
+    numa_replica_bytes = bytes;
+    intersectors = numa_replicas->intersectors;
+  }
+
+  void Scene::clearReplicas()
+  {
+    if (!numa_replicas) return;
+    numa_replicas.reset();
+    memoryMonitor(-ssize_t(numa_replica_bytes),true);
+    numa_replica_bytes = 0;
+  }
+
   void Scene::setBuildQuality(RTCBuildQuality quality_flags_i)
   {
     if (quality_flags == quality_flags_i) return;
@@ -691,13 +880,48 @@ namespace embree
   void Scene::setSceneFlags(RTCSceneFlags scene_flags_i)
   {
     if (scene_flags == scene_flags_i) return;
+
+    /* toggling the statistics does not require a rebuild */
+    if ((scene_flags ^ scene_flags_i) & ~RTC_SCENE_FLAG_STATISTICS)
+      flags_modified = true;
     scene_flags = scene_flags_i;
-    flags_modified = true;
   }
 
   RTCSceneFlags Scene::getSceneFlags() const {
     return scene_flags;
   }
+
+  void Scene::setMemoryBudget(size_t bytes) {
+    memory_budget = bytes;
+  }
+
+  void Scene::memoryMonitor(ssize_t bytes, bool post)
+  {
+    device->memoryMonitor(bytes,post);
+
+    /* only throw when we allocate memory to never throw inside a destructor */
+    const ssize_t used = memory_used.fetch_add(bytes)+bytes;
+    if (memory_budget && bytes > 0 && used > ssize_t(memory_budget)) {
+      memory_used -= bytes;
+      device->memoryMonitor(-bytes,true);
+      throw_RTCError(RTC_ERROR_OUT_OF_MEMORY,"scene memory budget exceeded");
+    }
+  }
+
+  size_t Scene::availableMemory() const
+  {
+    if (memory_budget == 0) return std::numeric_limits<size_t>::max();
+    return size_t(max(ssize_t(memory_budget)-memory_used.load(),ssize_t(0)));
+  }
+
+  size_t Scene::estimatedFastAccelBytes() const
+  {
+    /* primitive references and leaves of the triangle and quad BVHs, the nodes add about one 4-wide node per 4 primitives */
+    const size_t nodeBytes = 4*sizeof(BBox3fa)+4*sizeof(size_t);
+    const size_t numTriangles = getNumPrimitives<TriangleMesh,false>();
+    const size_t numQuads = getNumPrimitives<QuadMesh,false>();
+    return numTriangles*(sizeof(PrimRef)+sizeof(Triangle4)/4+nodeBytes/4) + numQuads*(sizeof(PrimRef)+sizeof(Quad4v)/4+nodeBytes/4);
+  }
                    
 #if defined(TASKING_INTERNAL)
 
@@ -738,7 +962,7 @@ namespace embree
     }
     catch (...) {
       accels.clear();
-      updateInterface();
+      if (!async_commit) updateInterface();
       Lock<MutexSys> lock(schedulerMutex);
       this->scheduler = nullptr;
       throw;
@@ -832,12 +1056,96 @@ namespace embree
       _mm_setcsr(mxcsr);
       
       accels.clear();
-      updateInterface();
+      if (!async_commit) updateInterface();
       throw;
     }
   }
 #endif
 
+  void Scene::commitAsync(RTCCommitSceneFunction func, void* ptr)
+  {
+    /* the build of the last asynchronous commit has to finish before its acceleration structures get reused */
+    waitCommitAsync();
+
+    /* rays traverse the acceleration structures of the last commit
+     * through an AccelN during the build, thus swapping in the new ones
+     * later on only changes the AccelN pointer of the intersectors */
+    if (!async_active)
+    {
+      AccelN& front = async_accels[async_front];
+      std::swap(accels.accels,front.accels);
+      accels.validAccels.clear();
+      accels.validBounds.clear();
+      front.updateValidAccels(false);
+      bounds = front.bounds;
+      intersectors = front.intersectors;
+      async_active = true;
+    }
+
+    async_function = func;
+    async_function_ptr = ptr;
+    async_commit = true;
+    async_done = false;
+    async_thread = createThread(commitAsyncThread,this);
+  }
+
+  void Scene::commitAsyncThread(void* ptr)
+  {
+    Scene* scene = (Scene*) ptr;
+    RTCError error = RTC_ERROR_NONE;
+    try {
+      scene->commit(false);
+    } catch (std::bad_alloc&) {
+      error = RTC_ERROR_OUT_OF_MEMORY;
+      Device::process_error(scene->device,error,"out of memory");
+    } catch (rtcore_error& e) {
+      error = e.error;
+      Device::process_error(scene->device,error,e.what());
+    } catch (std::exception& e) {
+      error = RTC_ERROR_UNKNOWN;
+      Device::process_error(scene->device,error,e.what());
+    } catch (...) {
+      error = RTC_ERROR_UNKNOWN;
+      Device::process_error(scene->device,error,"unknown exception caught");
+    }
+    scene->async_commit = false;
+    scene->async_done = true;
+
+    if (scene->async_function)
+      scene->async_function(scene->async_function_ptr,(RTCScene)scene,error);
+  }
+
+  void Scene::waitCommitAsync()
+  {
+    Lock<MutexSys> lock(async_mutex);
+    if (async_thread == nullptr) return;
+    join(async_thread);
+    async_thread = nullptr;
+  }
+
+  void Scene::publishAsync()
+  {
+    /* move the new acceleration structures into the AccelN rays do not traverse */
+    const size_t back = 1-async_front;
+    AccelN& next = async_accels[back];
+    std::swap(accels.accels,next.accels);
+    accels.validAccels.clear();
+    accels.validBounds.clear();
+    next.updateValidAccels(false);
+
+    /* both AccelNs use the same dispatch functions, rays pick up the
+     * new acceleration structures with the atomic pointer store */
+    Accel::Intersectors nextIntersectors = next.intersectors;
+    nextIntersectors.ptr = intersectors.ptr;
+    intersectors = nextIntersectors;
+    std::atomic_thread_fence(std::memory_order_release);
+    *(AccelData* volatile*)&intersectors.ptr = &next;
+
+    bounds = next.bounds;
+    async_front = back;
+    is_build = true;
+  }
+
   void Scene::setProgressMonitorFunction(RTCProgressMonitorFunction func, void* ptr) 
   {
     progress_monitor_function = func;
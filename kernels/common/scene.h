@@ -30,12 +30,14 @@
 #include "../subdiv/tessellation_cache.h"
 
 #include "acceln.h"
+#include "scene_image.h"
+#include "traversal_stats.h"
 #include "geometry.h"
 
 namespace embree
 {
   /*! Base class all scenes are derived from */
-  class Scene : public Accel
+  class Scene : public Accel, public MemoryMonitorInterface
   {
     ALIGNED_CLASS_(16);
 
@@ -145,6 +147,7 @@ namespace embree
     Scene& operator= (const Scene& other) DELETED; // do not implement
 
   public:
+    void createAccels();
     void createTriangleAccel();
     void createTriangleMBAccel();
     void createQuadAccel();
@@ -166,6 +169,16 @@ namespace embree
     /*! clears the scene */
     void clear();
 
+    /*! processes all primitives within the point query radius */
+    bool pointQuery(PointQueryContext* context) {
+      return tracedAccels().pointQuery(context);
+    }
+
+    /*! reports all pairs of primitives of this and some other scene with overlapping bounds */
+    void collide(Scene* other, const CollideContext* context) {
+      tracedAccels().collide(&other->tracedAccels(),context);
+    }
+
     /*! detaches some geometry */
     void detachGeometry(size_t geomID);
 
@@ -174,11 +187,58 @@ namespace embree
     
     void setSceneFlags(RTCSceneFlags scene_flags);
     RTCSceneFlags getSceneFlags() const;
+
+    /*! sets the memory budget of the scene, 0 disables the budget */
+    void setMemoryBudget(size_t bytes);
+
+    /*! accounts memory allocated by the acceleration structures of the scene and enforces the memory budget */
+    void memoryMonitor(ssize_t bytes, bool post);
+
+    /*! returns the number of bytes that can still get allocated within the memory budget */
+    size_t availableMemory() const;
+
+    /*! estimates the number of bytes required to build the triangle and quad BVHs with the fast primitive layouts */
+    size_t estimatedFastAccelBytes() const;
     
     void commit (bool join);
     void commit_task ();
     void build () {}
 
+    /*! commits the scene in a background thread, rays keep traversing the acceleration structures of the last commit until the new ones get swapped in */
+    void commitAsync(RTCCommitSceneFunction func, void* ptr);
+
+    /*! waits for a running asynchronous commit to finish */
+    void waitCommitAsync();
+
+    /*! returns true if no asynchronous commit is running */
+    __forceinline bool isCommitDone() const { return async_done; }
+
+    /*! returns the acceleration structures rays currently traverse */
+    __forceinline AccelN& tracedAccels() { return async_active ? async_accels[async_front] : accels; }
+
+  private:
+    static void commitAsyncThread(void* ptr);
+
+    /*! swaps the acceleration structures built by an asynchronous commit in */
+    void publishAsync();
+
+    /*! places a copy of the acceleration structures of large static scenes on each NUMA node */
+    void replicateAccels();
+
+    /*! releases the copies of the acceleration structures on each NUMA node */
+    void clearReplicas();
+
+    /*! writes the acceleration structures to a stream, returns false if some acceleration structure cannot get saved */
+    bool saveBVH(std::ostream& stream, AccelN& accels);
+
+  public:
+
+    /*! writes the acceleration structures of the committed scene to a BVH file */
+    void saveBVH(const std::string& fileName);
+
+    /*! commits the scene by mapping its acceleration structures from a BVH file instead of building them */
+    void loadBVH(const std::string& fileName);
+
     void updateInterface();
 
     /* return number of geometries */
@@ -228,7 +288,8 @@ namespace embree
 
     /* flag decoding */
     __forceinline bool isFastAccel() const { return !isCompactAccel() && !isRobustAccel(); }
-    __forceinline bool isCompactAccel() const { return scene_flags & RTC_SCENE_FLAG_COMPACT; }
+    __forceinline bool isCompactAccel() const { return (scene_flags & (RTC_SCENE_FLAG_COMPACT | RTC_SCENE_FLAG_COMPRESSED)) || budget_compact; }
+    __forceinline bool isCompressedAccel() const { return scene_flags & RTC_SCENE_FLAG_COMPRESSED; }
     __forceinline bool isRobustAccel()  const { return scene_flags & RTC_SCENE_FLAG_ROBUST; }
     __forceinline bool isStaticAccel()  const { return !(scene_flags & RTC_SCENE_FLAG_DYNAMIC); }
     __forceinline bool isDynamicAccel() const { return scene_flags & RTC_SCENE_FLAG_DYNAMIC; }
@@ -242,6 +303,12 @@ namespace embree
     __forceinline bool hasFilterFunction() {
       return hasContextFilterFunction() || hasGeometryFilterFunction();
     }
+
+    /* returns the traversal statistics counters of the calling thread, nullptr if statistics are disabled */
+    __forceinline ThreadTraversalCounters* traversalCounters() {
+      if (likely(!(scene_flags & RTC_SCENE_FLAG_STATISTICS))) return nullptr;
+      return statistics.threadCounters();
+    }
     
     /* test if scene got already build */
     __forceinline bool isBuild() const { return is_build; }
@@ -261,6 +328,23 @@ namespace embree
     SpinLock geometriesMutex;
     bool is_build;
     bool modified;                   //!< true if scene got modified
+    size_t commitCounter;            //!< number of times the scene got committed
+    Ref<SceneImage> image;           //!< BVH file to map the acceleration structures from during commit
+    TraversalStatistics statistics;  //!< traversal statistics gathered with RTC_SCENE_FLAG_STATISTICS
+    size_t memory_budget;            //!< maximal number of bytes the acceleration structures may allocate, 0 for no limit
+    std::atomic<ssize_t> memory_used; //!< number of bytes currently allocated by the acceleration structures
+    bool budget_compact;             //!< true if compact primitive layouts got selected to meet the memory budget
+    AccelN async_accels[2];          //!< double buffered acceleration structures traversed while asynchronous commits build into accels
+    size_t async_front;              //!< index of the async_accels rays traverse
+    bool async_active;               //!< true if rays traverse async_accels instead of accels
+    bool async_commit;               //!< true while an asynchronous commit builds
+    std::atomic<bool> async_done;    //!< false while an asynchronous commit is running
+    thread_t async_thread;           //!< background thread of the last asynchronous commit
+    MutexSys async_mutex;            //!< protects joining the background thread
+    RTCCommitSceneFunction async_function; //!< completion callback of the running asynchronous commit
+    void* async_function_ptr;        //!< user pointer passed to the completion callback
+    std::unique_ptr<AccelReplicas> numa_replicas; //!< copies of the acceleration structures on each NUMA node rays traverse instead of accels
+    size_t numa_replica_bytes;       //!< number of bytes of all copies
     
     /*! global lock step task scheduler */
 #if defined(TASKING_INTERNAL) 
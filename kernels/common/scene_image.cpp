@@ -0,0 +1,91 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "scene_image.h"
+
+namespace embree
+{
+  static const char sceneImageMagic[8] = { 'E','M','B','R','E','E','B','V' };
+
+  SceneImage::SceneImage (const std::string& fileName)
+    : ptr(nullptr), bytes(0), mapped(true), huge_pages(false)
+  {
+    ptr = (char*) os_map_file(fileName.c_str(),bytes);
+    if (ptr == nullptr)
+      throw_RTCError(RTC_ERROR_INVALID_ARGUMENT,"cannot open BVH file " + fileName);
+
+    if (!valid()) {
+      os_unmap_file(ptr,bytes);
+      throw_RTCError(RTC_ERROR_INVALID_ARGUMENT,"invalid BVH file " + fileName);
+    }
+  }
+
+  SceneImage::SceneImage (const char* data, size_t bytes, ssize_t numaNode)
+    : ptr(nullptr), bytes(bytes), mapped(false), huge_pages(false)
+  {
+    /* place the pages before the copy touches them */
+    ptr = (char*) os_malloc(bytes,huge_pages);
+    if (numaNode >= 0) os_bind_node(ptr,bytes,numaNode);
+    memcpy(ptr,data,bytes);
+
+    if (!valid()) {
+      os_free(ptr,bytes,huge_pages);
+      throw_RTCError(RTC_ERROR_INVALID_ARGUMENT,"invalid BVH image");
+    }
+  }
+
+  SceneImage::~SceneImage ()
+  {
+    if (mapped) os_unmap_file(ptr,bytes);
+    else        os_free(ptr,bytes,huge_pages);
+  }
+
+  bool SceneImage::valid() const
+  {
+    bool valid = bytes >= sizeof(SceneImageHeader);
+    valid = valid && memcmp(header().magic,sceneImageMagic,sizeof(sceneImageMagic)) == 0;
+    valid = valid && header().version == version;
+    valid = valid && header().pointerBytes == sizeof(void*);
+    valid = valid && bytes >= sizeof(SceneImageHeader) + header().numGeometries*sizeof(GeometryImageHeader) + header().numAccels*sizeof(AccelImageHeader);
+    for (size_t i=0; valid && i<header().numAccels; i++) {
+      const AccelImageHeader& accel = accels()[i];
+      valid = accel.offset % dataAlignment == 0 && accel.offset <= bytes && accel.bytes <= bytes-accel.offset;
+    }
+    return valid;
+  }
+
+  SceneImageHeader SceneImage::createHeader(size_t numGeometries, size_t numAccels)
+  {
+    SceneImageHeader header;
+    memcpy(header.magic,sceneImageMagic,sizeof(sceneImageMagic));
+    header.version = version;
+    header.pointerBytes = sizeof(void*);
+    header.numGeometries = numGeometries;
+    header.numAccels = numAccels;
+    return header;
+  }
+
+  void SceneImage::align(std::ostream& stream, size_t alignment)
+  {
+    static const char zeros[64] = { 0 };
+    size_t pos = (size_t) stream.tellp();
+    while (pos % alignment) {
+      const size_t num = min(alignment - pos % alignment,sizeof(zeros));
+      stream.write(zeros,num);
+      pos += num;
+    }
+  }
+}
@@ -0,0 +1,111 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "default.h"
+
+namespace embree
+{
+  /*! Header of a BVH file. The header is followed by one geometry
+   *  header per geometry ID and one acceleration structure header per
+   *  acceleration structure of the scene. The node and leaf data of
+   *  each acceleration structure is stored page aligned behind the
+   *  headers. */
+  struct SceneImageHeader
+  {
+    char magic[8];                  //!< file identifier
+    unsigned int version;           //!< version of the file format
+    unsigned int pointerBytes;      //!< size of pointers of the platform that wrote the file
+    uint64_t numGeometries;         //!< number of geometry headers
+    uint64_t numAccels;             //!< number of acceleration structure headers
+  };
+
+  /*! Geometry the acceleration structures got built over, used to validate the scene a file gets loaded into. */
+  struct GeometryImageHeader
+  {
+    unsigned int type;              //!< geometry type, or GTY_END for unused geometry IDs
+    unsigned int enabled;           //!< 1 if the geometry was enabled
+    unsigned int numPrimitives;     //!< number of primitives
+    unsigned int numTimeSteps;      //!< number of time steps
+  };
+
+  /*! Acceleration structure stored in a BVH file. Node references
+   *  are stored relative to the start of the node and leaf data. */
+  struct AccelImageHeader
+  {
+    unsigned int type;              //!< type of the acceleration structure
+    unsigned int N;                 //!< branching factor
+    char primTy[32];                //!< name of the primitive type stored in the leaves
+    uint64_t offset;                //!< file offset of the node and leaf data
+    uint64_t bytes;                 //!< number of bytes of node and leaf data
+    uint64_t root;                  //!< relative root node reference
+    uint64_t numPrimitives;         //!< number of primitives
+    uint64_t numVertices;           //!< number of vertices
+    float bounds[2][6];             //!< lower and upper bounds at time 0 and 1
+  };
+
+  /*! Memory mapped BVH file. The file is mapped copy-on-write, thus
+   *  node references can get relocated in place without modifying the
+   *  file. */
+  class SceneImage : public RefCount
+  {
+  public:
+
+    /*! maps and validates a BVH file */
+    SceneImage (const std::string& fileName);
+
+    /*! copies a serialized BVH into memory placed on some NUMA node, -1 for no placement */
+    SceneImage (const char* data, size_t bytes, ssize_t numaNode);
+
+    ~SceneImage ();
+
+    __forceinline const SceneImageHeader& header() const {
+      return *(const SceneImageHeader*) ptr;
+    }
+
+    __forceinline const GeometryImageHeader* geometries() const {
+      return (const GeometryImageHeader*) (ptr+sizeof(SceneImageHeader));
+    }
+
+    __forceinline const AccelImageHeader* accels() const {
+      return (const AccelImageHeader*) (ptr+sizeof(SceneImageHeader)+header().numGeometries*sizeof(GeometryImageHeader));
+    }
+
+    __forceinline char* data() const { return ptr; }
+    __forceinline size_t size() const { return bytes; }
+
+    /*! initializes the header of a new BVH file */
+    static SceneImageHeader createHeader(size_t numGeometries, size_t numAccels);
+
+    /*! writes zeros until the stream position is a multiple of the alignment */
+    static void align(std::ostream& stream, size_t alignment);
+
+  public:
+    static const unsigned int version = 1;
+    static const size_t dataAlignment = 4096; //!< alignment of the node and leaf data within the file
+
+  private:
+    /*! validates the headers */
+    bool valid() const;
+
+  private:
+    char* ptr;
+    size_t bytes;
+    bool mapped;       //!< true if the image is a mapped file, false if it got copied into memory
+    bool huge_pages;   //!< whether the copied image uses huge pages
+  };
+}
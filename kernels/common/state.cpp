@@ -97,6 +97,15 @@ namespace embree
 
     tessellation_cache_size = 128*1024*1024;
 
+    refit_rotations = true;
+    refit_rebuild_threshold = 1.5f;
+    ploc_search_radius = 16;
+    build_chunk_size = 4*1024*1024;
+    build_spill_dir = "";
+    twolevel_cluster_threshold = 256*1024;
+    twolevel_rebuild_threshold = 0.0f;
+    stream_reorder = false;
+
     subdiv_accel = "default";
     subdiv_accel_mb = "default";
 
@@ -128,6 +137,9 @@ namespace embree
     if (hasISA(AVX512KNL)) set_affinity = true;
 
     start_threads = false;
+    numa = false;
+    numa_nodes = 0;
+    numa_replication_threshold = 64*1024*1024;
     enable_selockmemoryprivilege = false;
 #if defined(__LINUX__)
     hugepages = true;
@@ -140,6 +152,7 @@ namespace embree
     alloc_num_main_slots = 0;
     alloc_thread_block_size = 0;
     alloc_single_thread_alloc = -1;
+    alloc_pool_size = 0;
 
     error_function = nullptr;
     error_function_userptr = nullptr;
@@ -254,6 +267,13 @@ namespace embree
       
       else if (tok == Token::Id("start_threads")&& cin->trySymbol("=")) 
         start_threads = cin->get().Int();
+
+      else if (tok == Token::Id("numa") && cin->trySymbol("="))
+        numa = cin->get().Int();
+      else if (tok == Token::Id("numa_nodes") && cin->trySymbol("="))
+        numa_nodes = cin->get().Int();
+      else if (tok == Token::Id("numa_replication_threshold") && cin->trySymbol("="))
+        numa_replication_threshold = cin->get().Int();
       
       else if (tok == Token::Id("isa") && cin->trySymbol("=")) {
         std::string isa = toLowerCase(cin->get().Identifier());
@@ -404,6 +424,7 @@ namespace embree
             Token flag = cin->get();
             if (flag == Token::Id("dynamic") ) scene_flags |= RTC_SCENE_FLAG_DYNAMIC;
             else if (flag == Token::Id("compact")) scene_flags |= RTC_SCENE_FLAG_COMPACT;
+            else if (flag == Token::Id("compressed")) scene_flags |= RTC_SCENE_FLAG_COMPRESSED;
             else if (flag == Token::Id("robust")) scene_flags |= RTC_SCENE_FLAG_ROBUST;
           } while (cin->trySymbol("|"));
         }
@@ -417,12 +438,31 @@ namespace embree
       else if (tok == Token::Id("cache_size") && cin->trySymbol("="))
         tessellation_cache_size = size_t(cin->get().Float()*1024.0f*1024.0f);
 
+      else if (tok == Token::Id("refit_rotations") && cin->trySymbol("="))
+        refit_rotations = cin->get().Int();
+      else if (tok == Token::Id("refit_rebuild_threshold") && cin->trySymbol("="))
+        refit_rebuild_threshold = cin->get().Float();
+      else if (tok == Token::Id("ploc_search_radius") && cin->trySymbol("="))
+        ploc_search_radius = max(cin->get().Int(),1);
+      else if (tok == Token::Id("build_chunk_size") && cin->trySymbol("="))
+        build_chunk_size = max(cin->get().Int(),1);
+      else if (tok == Token::Id("build_spill_dir") && cin->trySymbol("="))
+        build_spill_dir = cin->get().String();
+      else if (tok == Token::Id("twolevel_cluster_threshold") && cin->trySymbol("="))
+        twolevel_cluster_threshold = max(cin->get().Int(),2);
+      else if (tok == Token::Id("twolevel_rebuild_threshold") && cin->trySymbol("="))
+        twolevel_rebuild_threshold = cin->get().Float();
+      else if (tok == Token::Id("stream_reorder") && cin->trySymbol("="))
+        stream_reorder = cin->get().Int();
+
       else if (tok == Token::Id("alloc_main_block_size") && cin->trySymbol("="))
         alloc_main_block_size = cin->get().Int();
        else if (tok == Token::Id("alloc_num_main_slots") && cin->trySymbol("="))
         alloc_num_main_slots = cin->get().Int();
        else if (tok == Token::Id("alloc_thread_block_size") && cin->trySymbol("="))
          alloc_thread_block_size = cin->get().Int();
+      else if (tok == Token::Id("alloc_pool_size") && cin->trySymbol("="))
+        alloc_pool_size = size_t(cin->get().Float()*1024.0f*1024.0f);
        else if (tok == Token::Id("alloc_single_thread_alloc") && cin->trySymbol("="))
          alloc_single_thread_alloc = cin->get().Int();
 
@@ -440,6 +480,9 @@ namespace embree
     std::cout << "  build threads = " << numThreads   << std::endl;
     std::cout << "  start_threads = " << start_threads << std::endl;
     std::cout << "  affinity      = " << set_affinity << std::endl;
+    std::cout << "  numa          = " << numa << std::endl;
+    std::cout << "  numa_nodes    = " << numa_nodes << std::endl;
+    std::cout << "  numa_replication_threshold = " << numa_replication_threshold << std::endl;
     
     std::cout << "  hugepages     = ";
     if (!hugepages) std::cout << "disabled" << std::endl;
@@ -449,6 +492,14 @@ namespace embree
     std::cout << "  verbosity     = " << verbose << std::endl;
     std::cout << "  cache_size    = " << float(tessellation_cache_size)*1E-6 << " MB" << std::endl;
     std::cout << "  max_spatial_split_replications = " << max_spatial_split_replications << std::endl;
+    std::cout << "  refit_rotations = " << refit_rotations << std::endl;
+    std::cout << "  refit_rebuild_threshold = " << refit_rebuild_threshold << std::endl;
+    std::cout << "  ploc_search_radius = " << ploc_search_radius << std::endl;
+    std::cout << "  build_chunk_size = " << build_chunk_size << std::endl;
+    std::cout << "  build_spill_dir = " << build_spill_dir << std::endl;
+    std::cout << "  twolevel_cluster_threshold = " << twolevel_cluster_threshold << std::endl;
+    std::cout << "  twolevel_rebuild_threshold = " << twolevel_rebuild_threshold << std::endl;
+    std::cout << "  stream_reorder = " << stream_reorder << std::endl;
     
     std::cout << "triangles:" << std::endl;
     std::cout << "  accel         = " << tri_accel << std::endl;
@@ -118,6 +118,14 @@ namespace embree
   public:
     float max_spatial_split_replications;  //!< maximally replications*N many primitives in accel for spatial splits
     size_t tessellation_cache_size;        //!< size of the shared tessellation cache 
+    bool refit_rotations;                  //!< performs tree rotations after refitting geometries with refit build quality
+    float refit_rebuild_threshold;         //!< rebuilds refitted geometries once their SAH cost grew by this factor, 0 disables rebuilds
+    size_t ploc_search_radius;             //!< number of clusters the PLOC builder searches to each side for nearest neighbors
+    size_t build_chunk_size;               //!< maximal number of primitives the chunked builder processes at once
+    std::string build_spill_dir;           //!< directory the chunked builder spills BVH nodes to, empty to keep nodes in memory
+    size_t twolevel_cluster_threshold;     //!< number of geometries from which on two-level builders build the top level BVH in clusters
+    float twolevel_rebuild_threshold;      //!< two-level builders refit the top level BVH and rebuild subtrees whose SAH cost grew by this factor, 0 disables refitting
+    bool stream_reorder;                   //!< sorts incoherent ray streams by origin and direction into coherent packets before traversal
 
   public:
     size_t instancing_open_min;            //!< instancing opens tree to minimally that number of subtrees
@@ -138,6 +146,9 @@ namespace embree
     size_t numThreads;                     //!< number of threads to use in builders
     bool set_affinity;                     //!< sets affinity for worker threads
     bool start_threads;                    //!< true when threads should be started at device creation time
+    bool numa;                             //!< pins worker threads node by node and allocates BVH memory on the NUMA node of the building thread
+    size_t numa_nodes;                     //!< number of NUMA nodes to use, 0 detects the nodes of the machine
+    size_t numa_replication_threshold;     //!< BVH size in bytes from which on static scenes get replicated to each NUMA node
     int enabled_cpu_features;              //!< CPU ISA features to use
     int enabled_builder_cpu_features;      //!< CPU ISA features to use for builders only
     bool enable_selockmemoryprivilege;     //!< configures the SeLockMemoryPrivilege under Windows to enable huge pages
@@ -149,6 +160,7 @@ namespace embree
     int alloc_num_main_slots;              //!< number of such shared blocks to be used to allocate
     size_t alloc_thread_block_size;        //!< size of thread local allocator block size
     int alloc_single_thread_alloc;         //!< in single mode nodes and leaves use same thread local allocator
+    size_t alloc_pool_size;                //!< maximal number of bytes of released allocator blocks the device keeps for reuse
 
   public:
     struct ErrorHandler
@@ -0,0 +1,86 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "traversal_stats.h"
+
+namespace embree
+{
+  __thread TraversalStatistics::ThreadSlot TraversalStatistics::thread_slots[NUM_THREAD_SLOTS];
+
+  static std::atomic<size_t> g_statistics_id_counter(1);
+
+  TraversalStatistics::TraversalStatistics ()
+    : id(g_statistics_id_counter++), threads(nullptr) {}
+
+  TraversalStatistics::~TraversalStatistics ()
+  {
+    for (ThreadTraversalCounters* t=threads; t!=nullptr; ) 
+    {
+      ThreadTraversalCounters* next = t->next;
+      delete t;
+      t = next;
+    }
+  }
+
+  void TraversalStatistics::registerThread(ThreadSlot& slot)
+  {
+    /* the thread local slots identify the thread, a thread may get
+     * here multiple times when other scenes use the same slot */
+    void* owner = &thread_slots[0];
+    ThreadTraversalCounters* counters = nullptr;
+    {
+      Lock<SpinLock> lock(mutex);
+      for (ThreadTraversalCounters* t=threads; t!=nullptr; t=t->next) {
+        if (t->owner == owner) { counters = t; break; }
+      }
+      if (counters == nullptr) {
+        counters = new ThreadTraversalCounters(owner);
+        counters->next = threads;
+        threads = counters;
+      }
+    }
+    slot.id = id;
+    slot.counters = counters;
+  }
+
+  static void add(RTCTraversalStatistics& dst, const TraversalCounters& src)
+  {
+    dst.rays       += src.rays.load(std::memory_order_relaxed);
+    dst.nodes      += src.nodes.load(std::memory_order_relaxed);
+    dst.leaves     += src.leaves.load(std::memory_order_relaxed);
+    dst.primitives += src.prims.load(std::memory_order_relaxed);
+    dst.filters    += src.filters.load(std::memory_order_relaxed);
+  }
+
+  void TraversalStatistics::get(RTCSceneStatistics& stats)
+  {
+    memset(&stats,0,sizeof(stats));
+    Lock<SpinLock> lock(mutex);
+    for (ThreadTraversalCounters* t=threads; t!=nullptr; t=t->next) {
+      add(stats.intersect,t->intersect);
+      add(stats.occluded,t->occluded);
+    }
+  }
+
+  void TraversalStatistics::clear()
+  {
+    Lock<SpinLock> lock(mutex);
+    for (ThreadTraversalCounters* t=threads; t!=nullptr; t=t->next) {
+      t->intersect.clear();
+      t->occluded.clear();
+    }
+  }
+}
@@ -0,0 +1,142 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "default.h"
+#include "rtcore.h"
+
+namespace embree
+{
+  /*! Traversal counters of one ray query type. Only the owning thread
+   *  writes, thus relaxed load/store pairs are sufficient. */
+  struct TraversalCounters
+  {
+    TraversalCounters () { clear(); }
+
+    void clear() 
+    {
+      rays.store(0);
+      nodes.store(0);
+      leaves.store(0);
+      prims.store(0);
+      filters.store(0);
+    }
+
+    static __forceinline void add(std::atomic<size_t>& counter, size_t n) {
+      counter.store(counter.load(std::memory_order_relaxed)+n,std::memory_order_relaxed);
+    }
+
+    __forceinline void addRays(size_t n) { add(rays,n); }
+    
+    __forceinline void addRays(const int* valid, size_t K) 
+    {
+      size_t n = 0;
+      for (size_t i=0; i<K; i++) n += valid[i] != 0;
+      add(rays,n);
+    }
+
+    __forceinline void addFilter() { add(filters,1); }
+    
+  public:
+    std::atomic<size_t> rays;
+    std::atomic<size_t> nodes;
+    std::atomic<size_t> leaves;
+    std::atomic<size_t> prims;
+    std::atomic<size_t> filters;
+  };
+
+  /*! Counters of one thread for one scene. */
+  struct __aligned(64) ThreadTraversalCounters
+  {
+    ALIGNED_STRUCT_(64);
+
+    ThreadTraversalCounters (void* owner) : owner(owner), next(nullptr) {}
+
+    TraversalCounters intersect;
+    TraversalCounters occluded;
+    void* owner;                    //!< identifies the thread owning these counters
+    ThreadTraversalCounters* next;
+  };
+
+  /*! Runtime traversal statistics of a scene. Every thread counts into
+   *  its own counters, which get merged when the statistics are queried. */
+  class TraversalStatistics
+  {
+    static const size_t NUM_THREAD_SLOTS = 8;
+
+    /*! counters of one thread, direct mapped by statistics ID */
+    struct ThreadSlot
+    {
+      size_t id;
+      ThreadTraversalCounters* counters;
+    };
+
+  public:
+    TraversalStatistics ();
+    ~TraversalStatistics ();
+
+    /*! returns the counters of the calling thread */
+    __forceinline ThreadTraversalCounters* threadCounters()
+    {
+      ThreadSlot& slot = thread_slots[id % NUM_THREAD_SLOTS];
+      if (unlikely(slot.id != id)) 
+        registerThread(slot);
+      return slot.counters;
+    }
+
+    /*! merges the counters of all threads */
+    void get(RTCSceneStatistics& stats);
+
+    /*! resets the counters of all threads */
+    void clear();
+
+  private:
+    void registerThread(ThreadSlot& slot);
+
+  private:
+    size_t id;
+    SpinLock mutex;
+    ThreadTraversalCounters* threads;
+    static __thread ThreadSlot thread_slots[NUM_THREAD_SLOTS];
+  };
+
+  /*! Counts the traversal steps of a single ray or packet in registers
+   *  and adds them to the counters when the traversal finishes. */
+  struct TraversalCounter
+  {
+    __forceinline TraversalCounter (TraversalCounters* counters)
+      : counters(counters), nodes(0), leaves(0), prims(0) {}
+
+    __forceinline ~TraversalCounter () 
+    {
+      if (unlikely(counters != nullptr)) {
+        TraversalCounters::add(counters->nodes,nodes);
+        TraversalCounters::add(counters->leaves,leaves);
+        TraversalCounters::add(counters->prims,prims);
+      }
+    }
+
+    __forceinline void node() { nodes++; }
+    __forceinline void leaf(size_t num) { leaves++; prims += num; }
+
+  private:
+    TraversalCounters* counters;
+    size_t nodes;
+    size_t leaves;
+    size_t prims;
+  };
+}
@@ -0,0 +1,77 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+#include "../common/default.h"
+
+namespace embree
+{
+  /*! Returns the closest point to p on the triangle (a,b,c) and its
+   *  barycentric coordinates, such that the closest point equals
+   *  (1-u-v)*a + u*b + v*c. Follows the Voronoi region classification
+   *  of Ericson, Real-Time Collision Detection, 5.1.5. */
+  __forceinline Vec3fa closestPointTriangle(const Vec3fa& p, const Vec3fa& a, const Vec3fa& b, const Vec3fa& c, float& u, float& v)
+  {
+    const Vec3fa ab = b-a;
+    const Vec3fa ac = c-a;
+    const Vec3fa ap = p-a;
+
+    /* vertex region of a */
+    const float d1 = dot(ab,ap);
+    const float d2 = dot(ac,ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) { u = 0.0f; v = 0.0f; return a; }
+
+    /* vertex region of b */
+    const Vec3fa bp = p-b;
+    const float d3 = dot(ab,bp);
+    const float d4 = dot(ac,bp);
+    if (d3 >= 0.0f && d4 <= d3) { u = 1.0f; v = 0.0f; return b; }
+
+    /* vertex region of c */
+    const Vec3fa cp = p-c;
+    const float d5 = dot(ab,cp);
+    const float d6 = dot(ac,cp);
+    if (d6 >= 0.0f && d5 <= d6) { u = 0.0f; v = 1.0f; return c; }
+
+    /* edge region of ab */
+    const float vc = d1*d4 - d3*d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+      u = d1/(d1-d3); v = 0.0f;
+      return a + u*ab;
+    }
+
+    /* edge region of ac */
+    const float vb = d5*d2 - d1*d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+      u = 0.0f; v = d2/(d2-d6);
+      return a + v*ac;
+    }
+
+    /* edge region of bc */
+    const float va = d3*d6 - d5*d4;
+    if (va <= 0.0f && (d4-d3) >= 0.0f && (d5-d6) >= 0.0f) {
+      const float w = (d4-d3)/((d4-d3)+(d5-d6));
+      u = 1.0f-w; v = w;
+      return b + w*(c-b);
+    }
+
+    /* face region */
+    const float denom = 1.0f/(va+vb+vc);
+    u = vb*denom; v = vc*denom;
+    return a + u*ab + v*ac;
+  }
+}
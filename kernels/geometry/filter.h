@@ -27,6 +27,8 @@ namespace embree
   {
     __forceinline bool runIntersectionFilter1Helper(RTCFilterFunctionNArguments* args, const Geometry* const geometry, IntersectContext* context)
     {
+      if (unlikely(context->stats)) context->stats->intersect.addFilter();
+
       if (geometry->intersectionFilterN)
       {
         assert(context->scene->hasGeometryFilterFunction());
@@ -66,6 +68,7 @@ namespace embree
 #if defined(EMBREE_FILTER_FUNCTION)
       IntersectContext* MAYBE_UNUSED context = args->internal_context;
       const Geometry* const geometry = args->geometry;
+      if (unlikely(context->stats)) context->stats->intersect.addFilter();
       if (geometry->intersectionFilterN) {
         assert(context->scene->hasGeometryFilterFunction());
         geometry->intersectionFilterN(filter_args);
@@ -83,6 +86,8 @@ namespace embree
     
     __forceinline bool runOcclusionFilter1Helper(RTCFilterFunctionNArguments* args, const Geometry* const geometry, IntersectContext* context)
     {
+      if (unlikely(context->stats)) context->stats->occluded.addFilter();
+
       if (geometry->occlusionFilterN)
       {
         assert(context->scene->hasGeometryFilterFunction());
@@ -120,6 +125,7 @@ namespace embree
 #if defined(EMBREE_FILTER_FUNCTION)
       IntersectContext* MAYBE_UNUSED context = args->internal_context;
       const Geometry* const geometry = args->geometry;
+      if (unlikely(context->stats)) context->stats->occluded.addFilter();
       if (geometry->occlusionFilterN) {
         assert(context->scene->hasGeometryFilterFunction());
         geometry->occlusionFilterN(filter_args);
@@ -138,6 +144,7 @@ namespace embree
     template<int K>
       __forceinline vbool<K> runIntersectionFilterHelper(RTCFilterFunctionNArguments* args, const Geometry* const geometry, IntersectContext* context)
     {
+      if (unlikely(context->stats)) context->stats->intersect.addFilter();
       vint<K>* mask = (vint<K>*) args->valid;
       if (geometry->intersectionFilterN)
       {
@@ -177,6 +184,7 @@ namespace embree
     template<int K>
       __forceinline vbool<K> runOcclusionFilterHelper(RTCFilterFunctionNArguments* args, const Geometry* const geometry, IntersectContext* context)
     {
+      if (unlikely(context->stats)) context->stats->occluded.addFilter();
       vint<K>* mask = (vint<K>*) args->valid;
       if (geometry->occlusionFilterN)
       {
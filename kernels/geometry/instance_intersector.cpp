@@ -16,6 +16,7 @@
 
 #include "instance_intersector.h"
 #include "../common/scene.h"
+#include "../common/instance_stack.h"
 
 namespace embree
 {
@@ -32,15 +33,17 @@ namespace embree
 #endif
 
       RTCIntersectContext* user_context = context->user;
+      if (!instance_id_stack::push(user_context, instance->geomID))
+        return;
+
       const AffineSpace3fa world2local = instance->getWorld2Local();
       const Vec3fa ray_org = ray.org;
       const Vec3fa ray_dir = ray.dir;
       ray.org = Vec3fa(xfmPoint (world2local,ray_org),ray.tnear());
       ray.dir = Vec3fa(xfmVector(world2local,ray_dir),ray.time());      
-      user_context->instID[0] = instance->geomID;
-      IntersectContext newcontext((Scene*)instance->object,user_context);
+      IntersectContext newcontext((Scene*)instance->object,user_context,context->stats);
       instance->object->intersectors.intersect((RTCRayHit&)ray,&newcontext);
-      user_context->instID[0] = -1;
+      instance_id_stack::pop(user_context);
       ray.org = ray_org;
       ray.dir = ray_dir;
     }
@@ -56,15 +59,17 @@ namespace embree
 #endif
       
       RTCIntersectContext* user_context = context->user;
+      if (!instance_id_stack::push(user_context, instance->geomID))
+        return false;
+
       const AffineSpace3fa world2local = instance->getWorld2Local();
       const Vec3fa ray_org = ray.org;
       const Vec3fa ray_dir = ray.dir;
       ray.org = Vec3fa(xfmPoint (world2local,ray_org),ray.tnear());
       ray.dir = Vec3fa(xfmVector(world2local,ray_dir),ray.time());
-      user_context->instID[0] = instance->geomID;
-      IntersectContext newcontext((Scene*)instance->object,user_context);
+      IntersectContext newcontext((Scene*)instance->object,user_context,context->stats);
       instance->object->intersectors.occluded((RTCRay&)ray,&newcontext);
-      user_context->instID[0] = -1;
+      instance_id_stack::pop(user_context);
       ray.org = ray_org;
       ray.dir = ray_dir;
       return ray.tfar < 0.0f;
@@ -81,15 +86,17 @@ namespace embree
 #endif
       
       RTCIntersectContext* user_context = context->user;
+      if (!instance_id_stack::push(user_context, instance->geomID))
+        return;
+
       const AffineSpace3fa world2local = instance->getWorld2Local(ray.time());
       const Vec3fa ray_org = ray.org;
       const Vec3fa ray_dir = ray.dir;
       ray.org = Vec3fa(xfmPoint (world2local,ray_org),ray.tnear());
       ray.dir = Vec3fa(xfmVector(world2local,ray_dir),ray.time());      
-      user_context->instID[0] = instance->geomID;
-      IntersectContext newcontext((Scene*)instance->object,user_context);
+      IntersectContext newcontext((Scene*)instance->object,user_context,context->stats);
       instance->object->intersectors.intersect((RTCRayHit&)ray,&newcontext);
-      user_context->instID[0] = -1;
+      instance_id_stack::pop(user_context);
       ray.org = ray_org;
       ray.dir = ray_dir;
     }
@@ -105,15 +112,17 @@ namespace embree
 #endif
       
       RTCIntersectContext* user_context = context->user;
+      if (!instance_id_stack::push(user_context, instance->geomID))
+        return false;
+
       const AffineSpace3fa world2local = instance->getWorld2Local(ray.time());
       const Vec3fa ray_org = ray.org;
       const Vec3fa ray_dir = ray.dir;
       ray.org = Vec3fa(xfmPoint (world2local,ray_org),ray.tnear());
       ray.dir = Vec3fa(xfmVector(world2local,ray_dir),ray.time());
-      user_context->instID[0] = instance->geomID;
-      IntersectContext newcontext((Scene*)instance->object,user_context);
+      IntersectContext newcontext((Scene*)instance->object,user_context,context->stats);
       instance->object->intersectors.occluded((RTCRay&)ray,&newcontext);
-      user_context->instID[0] = -1;
+      instance_id_stack::pop(user_context);
       ray.org = ray_org;
       ray.dir = ray_dir;
       return ray.tfar < 0.0f;
@@ -132,15 +141,17 @@ namespace embree
 #endif
         
       RTCIntersectContext* user_context = context->user;
+      if (!instance_id_stack::push(user_context, instance->geomID))
+        return;
+
       AffineSpace3vf<K> world2local = instance->getWorld2Local();
       const Vec3vf<K> ray_org = ray.org;
       const Vec3vf<K> ray_dir = ray.dir;
       ray.org = xfmPoint (world2local,ray_org);
       ray.dir = xfmVector(world2local,ray_dir);
-      user_context->instID[0] = instance->geomID;
-      IntersectContext newcontext((Scene*)instance->object,user_context);
+      IntersectContext newcontext((Scene*)instance->object,user_context,context->stats);
       instance->object->intersectors.intersect(valid,ray,&newcontext);
-      user_context->instID[0] = -1;
+      instance_id_stack::pop(user_context);
       ray.org = ray_org;
       ray.dir = ray_dir;
     }
@@ -158,15 +169,17 @@ namespace embree
 #endif
         
       RTCIntersectContext* user_context = context->user;
+      if (!instance_id_stack::push(user_context, instance->geomID))
+        return false;
+
       AffineSpace3vf<K> world2local = instance->getWorld2Local();
       const Vec3vf<K> ray_org = ray.org;
       const Vec3vf<K> ray_dir = ray.dir;
       ray.org = xfmPoint (world2local,ray_org);
       ray.dir = xfmVector(world2local,ray_dir);
-      user_context->instID[0] = instance->geomID;
-      IntersectContext newcontext((Scene*)instance->object,user_context);
+      IntersectContext newcontext((Scene*)instance->object,user_context,context->stats);
       instance->object->intersectors.occluded(valid,ray,&newcontext);
-      user_context->instID[0] = -1;
+      instance_id_stack::pop(user_context);
       ray.org = ray_org;
       ray.dir = ray_dir;
       return ray.tfar < 0.0f;
@@ -185,15 +198,17 @@ namespace embree
 #endif
         
       RTCIntersectContext* user_context = context->user;
+      if (!instance_id_stack::push(user_context, instance->geomID))
+        return;
+
       AffineSpace3vf<K> world2local = instance->getWorld2Local<K>(valid,ray.time());
       const Vec3vf<K> ray_org = ray.org;
       const Vec3vf<K> ray_dir = ray.dir;
       ray.org = xfmPoint (world2local,ray_org);
       ray.dir = xfmVector(world2local,ray_dir);
-      user_context->instID[0] = instance->geomID;
-      IntersectContext newcontext((Scene*)instance->object,user_context);
+      IntersectContext newcontext((Scene*)instance->object,user_context,context->stats);
       instance->object->intersectors.intersect(valid,ray,&newcontext);
-      user_context->instID[0] = -1;
+      instance_id_stack::pop(user_context);
       ray.org = ray_org;
       ray.dir = ray_dir;
     }
@@ -211,15 +226,17 @@ namespace embree
 #endif
         
       RTCIntersectContext* user_context = context->user;
+      if (!instance_id_stack::push(user_context, instance->geomID))
+        return false;
+
       AffineSpace3vf<K> world2local = instance->getWorld2Local<K>(valid,ray.time());
       const Vec3vf<K> ray_org = ray.org;
       const Vec3vf<K> ray_dir = ray.dir;
       ray.org = xfmPoint (world2local,ray_org);
       ray.dir = xfmVector(world2local,ray_dir);
-      user_context->instID[0] = instance->geomID;
-      IntersectContext newcontext((Scene*)instance->object,user_context);
+      IntersectContext newcontext((Scene*)instance->object,user_context,context->stats);
       instance->object->intersectors.occluded(valid,ray,&newcontext);
-      user_context->instID[0] = -1;
+      instance_id_stack::pop(user_context);
       ray.org = ray_org;
       ray.dir = ray_dir;
       return ray.tfar < 0.0f;
@@ -37,5 +37,11 @@ namespace embree
 
     /*! Returns the number of bytes of block. */
     virtual size_t getBytes(const char* This) const = 0;
+
+    /*! Returns the geometry and primitive ID of the i'th primitive of a block, or false for empty slots and unsupported types. */
+    virtual bool getIDs(const char* This, size_t i, unsigned int& geomID, unsigned int& primID) const { return false; }
+
+    /*! Returns true if blocks store no pointers, thus can get copied to a different address. */
+    virtual bool isRelocatable() const { return true; }
   };
 }
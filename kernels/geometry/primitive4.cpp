@@ -178,6 +178,16 @@ namespace embree
     return sizeof(Triangle4);
   }
 
+  template<>
+  bool Triangle4::Type::getIDs(const char* This, size_t i, unsigned int& geomID, unsigned int& primID) const
+  {
+    const Triangle4* prim = (const Triangle4*)This;
+    if (!prim->valid(i)) return false;
+    geomID = prim->geomID(i);
+    primID = prim->primID(i);
+    return true;
+  }
+
   /********************** Triangle4v **************************/
 
   template<>
@@ -200,6 +210,16 @@ namespace embree
     return sizeof(Triangle4v);
   }
 
+  template<>
+  bool Triangle4v::Type::getIDs(const char* This, size_t i, unsigned int& geomID, unsigned int& primID) const
+  {
+    const Triangle4v* prim = (const Triangle4v*)This;
+    if (!prim->valid(i)) return false;
+    geomID = prim->geomID(i);
+    primID = prim->primID(i);
+    return true;
+  }
+
   /********************** Triangle4i **************************/
 
   template<>
@@ -222,6 +242,16 @@ namespace embree
     return sizeof(Triangle4i);
   }
 
+  template<>
+  bool Triangle4i::Type::getIDs(const char* This, size_t i, unsigned int& geomID, unsigned int& primID) const
+  {
+    const Triangle4i* prim = (const Triangle4i*)This;
+    if (!prim->valid(i)) return false;
+    geomID = prim->geomID(i);
+    primID = prim->primID(i);
+    return true;
+  }
+
   /********************** Triangle4vMB **************************/
 
   template<>
@@ -244,6 +274,16 @@ namespace embree
     return sizeof(Triangle4vMB);
   }
 
+  template<>
+  bool Triangle4vMB::Type::getIDs(const char* This, size_t i, unsigned int& geomID, unsigned int& primID) const
+  {
+    const Triangle4vMB* prim = (const Triangle4vMB*)This;
+    if (!prim->valid(i)) return false;
+    geomID = prim->geomID(i);
+    primID = prim->primID(i);
+    return true;
+  }
+
   /********************** Quad4v **************************/
 
   template<>
@@ -266,6 +306,16 @@ namespace embree
     return sizeof(Quad4v);
   }
 
+  template<>
+  bool Quad4v::Type::getIDs(const char* This, size_t i, unsigned int& geomID, unsigned int& primID) const
+  {
+    const Quad4v* prim = (const Quad4v*)This;
+    if (!prim->valid(i)) return false;
+    geomID = prim->geomID(i);
+    primID = prim->primID(i);
+    return true;
+  }
+
   /********************** Quad4i **************************/
 
   template<>
@@ -288,6 +338,16 @@ namespace embree
     return sizeof(Quad4i);
   }
 
+  template<>
+  bool Quad4i::Type::getIDs(const char* This, size_t i, unsigned int& geomID, unsigned int& primID) const
+  {
+    const Quad4i* prim = (const Quad4i*)This;
+    if (!prim->valid(i)) return false;
+    geomID = prim->geomID(i);
+    primID = prim->primID(i);
+    return true;
+  }
+
   /********************** SubdivPatch1 **************************/
 
   const char* SubdivPatch1::Type::name () const {
@@ -306,6 +366,10 @@ namespace embree
     return sizeof(SubdivPatch1);
   }
 
+  bool SubdivPatch1::Type::isRelocatable() const {
+    return false;
+  }
+
   SubdivPatch1::Type SubdivPatch1::type;
 
   /********************** Virtual Object **************************/
@@ -326,6 +390,13 @@ namespace embree
     return sizeof(Object);
   }
 
+  bool Object::Type::getIDs(const char* This, size_t i, unsigned int& geomID, unsigned int& primID) const
+  {
+    geomID = ((const Object*)This)->geomID();
+    primID = ((const Object*)This)->primID();
+    return true;
+  }
+
   Object::Type Object::type;
 
   /********************** Instance **************************/
@@ -346,6 +417,17 @@ namespace embree
     return sizeof(InstancePrimitive);
   }
 
+  bool InstancePrimitive::Type::getIDs(const char* This, size_t i, unsigned int& geomID, unsigned int& primID) const
+  {
+    geomID = ((const InstancePrimitive*)This)->instance->geomID;
+    primID = 0;
+    return true;
+  }
+
+  bool InstancePrimitive::Type::isRelocatable() const {
+    return false;
+  }
+
   InstancePrimitive::Type InstancePrimitive::type;
 
   /********************** SubGrid **************************/
@@ -389,4 +471,26 @@ namespace embree
   size_t SubGridQBVH4::Type::getBytes(const char* This) const {
     return sizeof(SubGridQBVH4);
   }
+
+  /********************** SubGridMBQBVH4 **************************/
+
+  template<>
+  const char* SubGridMBQBVH4::Type::name () const {
+    return "SubGridMBQBVH4";
+  }
+
+  template<>
+  size_t SubGridMBQBVH4::Type::sizeActive(const char* This) const {
+    return 1;
+  }
+
+  template<>
+  size_t SubGridMBQBVH4::Type::sizeTotal(const char* This) const {
+    return 1;
+  }
+
+  template<>
+  size_t SubGridMBQBVH4::Type::getBytes(const char* This) const {
+    return sizeof(SubGridMBQBVH4);
+  }
 }
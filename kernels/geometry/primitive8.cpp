@@ -155,4 +155,26 @@ namespace embree
   size_t SubGridQBVH8::Type::getBytes(const char* This) const {
     return sizeof(SubGridQBVH8);
   }
+
+  /********************** SubGridMBQBVH8 **************************/
+
+  template<>
+  const char* SubGridMBQBVH8::Type::name () const {
+    return "SubGridMBQBVH8";
+  }
+
+  template<>
+  size_t SubGridMBQBVH8::Type::sizeActive(const char* This) const {
+    return 1;
+  }
+
+  template<>
+  size_t SubGridMBQBVH8::Type::sizeTotal(const char* This) const {
+    return 1;
+  }
+
+  template<>
+  size_t SubGridMBQBVH8::Type::getBytes(const char* This) const {
+    return sizeof(SubGridMBQBVH8);
+  }
 }
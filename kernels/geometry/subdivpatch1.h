@@ -30,6 +30,7 @@ namespace embree
       size_t sizeActive(const char* This) const;
       size_t sizeTotal(const char* This) const;
       size_t getBytes(const char* This) const;
+      bool isRelocatable() const;
     };
     
     static Type type;
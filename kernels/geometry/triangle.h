@@ -33,6 +33,7 @@ namespace embree
       size_t sizeActive(const char* This) const;
       size_t sizeTotal(const char* This) const;
       size_t getBytes(const char* This) const;
+      bool getIDs(const char* This, size_t i, unsigned int& geomID, unsigned int& primID) const;
     };
     static Type type;
     
@@ -18,43 +18,29 @@
 
 namespace embree
 {
-  SharedLazyTessellationCache SharedLazyTessellationCache::sharedLazyTessellationCache;
+  __thread SharedLazyTessellationCache::ThreadSlot SharedLazyTessellationCache::thread_slots[NUM_THREAD_CACHE_SLOTS];
 
-  __thread ThreadWorkState* SharedLazyTessellationCache::init_t_state = nullptr;
-  ThreadWorkState* SharedLazyTessellationCache::current_t_state = nullptr;
+  static std::atomic<size_t> g_cache_id_counter(1);
 
-  void resizeTessellationCache(size_t new_size)
-  {    
-    if (new_size >= SharedLazyTessellationCache::MAX_TESSELLATION_CACHE_SIZE)
-      new_size = SharedLazyTessellationCache::MAX_TESSELLATION_CACHE_SIZE;
-    if (SharedLazyTessellationCache::sharedLazyTessellationCache.getSize() != new_size) 
-      SharedLazyTessellationCache::sharedLazyTessellationCache.realloc(new_size);    
-  }
-
-  void resetTessellationCache()
-  {
-    //SharedLazyTessellationCache::sharedLazyTessellationCache.addCurrentIndex(SharedLazyTessellationCache::NUM_CACHE_SEGMENTS);
-    SharedLazyTessellationCache::sharedLazyTessellationCache.reset();
-  }
-  
   SharedLazyTessellationCache::SharedLazyTessellationCache()
   {
     size = 0;
     data = nullptr;
     hugepages = false;
     maxBlocks              = size/BLOCK_SIZE;
+    cacheID                = g_cache_id_counter++;
     localTime              = NUM_CACHE_SEGMENTS;
     next_block             = 0;
     numRenderThreads       = 0;
+    numEvictions           = 0;
+    numEvictedBytes        = 0;
 #if FORCE_SIMPLE_FLUSH == 1
     switch_block_threshold = maxBlocks;
 #else
     switch_block_threshold = maxBlocks/NUM_CACHE_SEGMENTS;
 #endif
     threadWorkState     = new ThreadWorkState[NUM_PREALLOC_THREAD_WORK_STATES];
-
-    //reset_state.reset();
-    //linkedlist_mtx.reset();
+    current_t_state     = nullptr;
   }
 
   SharedLazyTessellationCache::~SharedLazyTessellationCache() 
@@ -67,19 +53,25 @@ namespace embree
     }
 
     delete[] threadWorkState;
+    if (data) os_free(data,size,hugepages);
   }
 
-  void SharedLazyTessellationCache::getNextRenderThreadWorkState() 
+  void SharedLazyTessellationCache::getNextRenderThreadWorkState(ThreadSlot& slot) 
   {
+    ThreadWorkState* t_state = nullptr;
     const size_t id = numRenderThreads.fetch_add(1); 
-    if (id >= NUM_PREALLOC_THREAD_WORK_STATES) init_t_state = new ThreadWorkState(true);
-    else                                       init_t_state = &threadWorkState[id];
+    if (id >= NUM_PREALLOC_THREAD_WORK_STATES) t_state = new ThreadWorkState(true);
+    else                                       t_state = &threadWorkState[id];
     
     /* critical section for updating link list with new thread state */
     linkedlist_mtx.lock();
-    init_t_state->next = current_t_state;
-    current_t_state = init_t_state;
+    t_state->next = current_t_state;
+    current_t_state = t_state;
     linkedlist_mtx.unlock();
+
+    /* a state of some other cache in this slot stays in the list of that cache */
+    slot.cacheID = cacheID;
+    slot.state = t_state;
   }
 
   void SharedLazyTessellationCache::waitForUsersLessEqual(ThreadWorkState *const t_state,
@@ -111,7 +103,6 @@ namespace embree
         
         /* switch to the next segment */
         addCurrentIndex();
-        CACHE_STATS(PRINT("RESET TESS CACHE"));
         
 #if FORCE_SIMPLE_FLUSH == 1
         next_block = 0;
@@ -122,8 +113,10 @@ namespace embree
         switch_block_threshold = next_block + (maxBlocks/NUM_CACHE_SEGMENTS);
         assert( switch_block_threshold <= maxBlocks );
 #endif
-        
-        CACHE_STATS(SharedTessellationCacheStats::cache_flushes++);
+
+        /* the entries of the segment we switched to got evicted */
+        numEvictions++;
+        numEvictedBytes += (switch_block_threshold-next_block)*BLOCK_SIZE;
         
         /* release all blocked threads */
         
@@ -224,43 +217,53 @@ namespace embree
   }
 
 
-  ////////////////////////////////////////////////////////////////////////////////////////////////////////////
-  ////////////////////////////////////////////////////////////////////////////////////////////////////////////
-  ////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-  std::atomic<size_t> SharedTessellationCacheStats::cache_accesses(0);
-  std::atomic<size_t> SharedTessellationCacheStats::cache_hits(0);
-  std::atomic<size_t> SharedTessellationCacheStats::cache_misses(0);
-  std::atomic<size_t> SharedTessellationCacheStats::cache_flushes(0);  
-  SpinLock   SharedTessellationCacheStats::mtx;  
-  size_t SharedTessellationCacheStats::cache_num_patches(0);
+  void SharedLazyTessellationCache::resize(size_t new_size)
+  {
+    if (new_size >= MAX_TESSELLATION_CACHE_SIZE)
+      new_size = MAX_TESSELLATION_CACHE_SIZE;
+    if (getSize() != new_size) 
+      realloc(new_size);
+  }
 
-  void SharedTessellationCacheStats::printStats()
+  SharedLazyTessellationCache::Statistics SharedLazyTessellationCache::getStatistics()
   {
-    PRINT(cache_accesses);
-    PRINT(cache_misses);
-    PRINT(cache_hits);
-    PRINT(cache_flushes);
-    PRINT(100.0f * cache_hits / cache_accesses);
-    assert(cache_hits + cache_misses == cache_accesses);
-    PRINT(cache_num_patches);
+    Statistics stat;
+    linkedlist_mtx.lock();
+    for (ThreadWorkState *t=current_t_state;t!=nullptr;t=t->next) {
+      stat.hits   += t->hits.load(std::memory_order_relaxed);
+      stat.misses += t->misses.load(std::memory_order_relaxed);
+    }
+    linkedlist_mtx.unlock();
+    stat.evictions    = numEvictions;
+    stat.evictedBytes = numEvictedBytes;
+    return stat;
   }
 
-  void SharedTessellationCacheStats::clearStats()
+  void SharedLazyTessellationCache::clearStatistics()
   {
-    SharedTessellationCacheStats::cache_accesses  = 0;
-    SharedTessellationCacheStats::cache_hits      = 0;
-    SharedTessellationCacheStats::cache_misses    = 0;
-    SharedTessellationCacheStats::cache_flushes   = 0;
+    linkedlist_mtx.lock();
+    for (ThreadWorkState *t=current_t_state;t!=nullptr;t=t->next) {
+      t->hits.store(0,std::memory_order_relaxed);
+      t->misses.store(0,std::memory_order_relaxed);
+    }
+    linkedlist_mtx.unlock();
+    numEvictions = 0;
+    numEvictedBytes = 0;
   }
 
+  ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
   struct cache_regression_test : public RegressionTest
   {
     BarrierSys barrier;
     std::atomic<size_t> numFailed;
     std::atomic<int> threadIDCounter;
     static const size_t numEntries = 4*1024;
+    static const size_t numLookups = 100000;
     SharedLazyTessellationCache::CacheEntry entry[numEntries];
+    std::unique_ptr<SharedLazyTessellationCache> cache;
 
     cache_regression_test() 
       : RegressionTest("cache_regression_test"), numFailed(0), threadIDCounter(0)
@@ -271,22 +274,23 @@ namespace embree
     static void thread_alloc(cache_regression_test* This)
     {
       int threadID = This->threadIDCounter++;
-      size_t maxN = SharedLazyTessellationCache::sharedLazyTessellationCache.maxAllocSize()/4;
+      SharedLazyTessellationCache& cache = *This->cache;
+      size_t maxN = cache.maxAllocSize()/4;
       This->barrier.wait();
 
-      for (size_t j=0; j<100000; j++)
+      for (size_t j=0; j<numLookups; j++)
       {
         size_t elt = (threadID+j)%numEntries;
         size_t N = min(1+10*(elt%1000),maxN);
           
-        volatile int* data = (volatile int*) SharedLazyTessellationCache::lookup(This->entry[elt],0,[&] () {
-            int* data = (int*) SharedLazyTessellationCache::sharedLazyTessellationCache.malloc(4*N);
+        volatile int* data = (volatile int*) cache.lookup(This->entry[elt],0,[&] () {
+            int* data = (int*) cache.malloc(4*N);
             for (size_t k=0; k<N; k++) data[k] = (int)elt;
             return data;
           });
         
         if (data == nullptr) {
-          SharedLazyTessellationCache::sharedLazyTessellationCache.unlock();
+          cache.unlock();
           This->numFailed++;
           continue;
         }
@@ -299,7 +303,7 @@ namespace embree
           }
         }
         
-        SharedLazyTessellationCache::sharedLazyTessellationCache.unlock();
+        cache.unlock();
       }
       This->barrier.wait();
     }
@@ -307,6 +311,10 @@ namespace embree
     bool run ()
     {
       numFailed.store(0);
+      cache.reset(new SharedLazyTessellationCache);
+      cache->resize(16*1024*1024);
+      for (size_t i=0; i<numEntries; i++)
+        entry[i].tag.reset();
 
       size_t numThreads = getNumberOfLogicalThreads();
       barrier.init(numThreads+1);
@@ -324,16 +332,14 @@ namespace embree
       for (size_t i=0; i<numThreads; i++)
         join(threads[i]);
 
+      /* every lookup is either a hit or a miss */
+      SharedLazyTessellationCache::Statistics stat = cache->getStatistics();
+      if (stat.hits+stat.misses != numThreads*numLookups) numFailed++;
+      cache.reset();
+
       return numFailed == 0;
     }
   };
 
   cache_regression_test cache_regression;
 };
-
-extern "C" void printTessCacheStats()
-{
-  PRINT("SHARED TESSELLATION CACHE");
-  embree::SharedTessellationCacheStats::printStats();
-  embree::SharedTessellationCacheStats::clearStats();
-}
@@ -30,6 +30,34 @@ namespace embree {
   /* scene data */
   RTCScene g_scene = nullptr;
 
+  /* resets the build phase timings of the device */
+  void resetBuildPhaseTimes()
+  {
+    rtcSetDeviceProperty(g_device,RTC_DEVICE_PROPERTY_BUILD_PRIMITIVES_TIME,0);
+    rtcSetDeviceProperty(g_device,RTC_DEVICE_PROPERTY_BUILD_SORT_TIME,0);
+    rtcSetDeviceProperty(g_device,RTC_DEVICE_PROPERTY_BUILD_HIERARCHY_TIME,0);
+    rtcSetDeviceProperty(g_device,RTC_DEVICE_PROPERTY_BUILD_TOPLEVEL_TIME,0);
+    rtcSetDeviceProperty(g_device,RTC_DEVICE_PROPERTY_BUILD_TOPLEVEL_NODES,0);
+  }
+
+  /* prints the average time per iteration spent in each build phase */
+  void printBuildPhaseTimes(size_t iterations)
+  {
+    const double primitives = 1E-6*rtcGetDeviceProperty(g_device,RTC_DEVICE_PROPERTY_BUILD_PRIMITIVES_TIME);
+    const double sort       = 1E-6*rtcGetDeviceProperty(g_device,RTC_DEVICE_PROPERTY_BUILD_SORT_TIME);
+    const double hierarchy  = 1E-6*rtcGetDeviceProperty(g_device,RTC_DEVICE_PROPERTY_BUILD_HIERARCHY_TIME);
+    std::cout << "  phases: "
+              << primitives/iterations << " s primitives, "
+              << sort/iterations << " s sort, "
+              << hierarchy/iterations << " s hierarchy" << std::endl;
+
+    /* two-level builds additionally report their top level BVH */
+    const double toplevel = 1E-6*rtcGetDeviceProperty(g_device,RTC_DEVICE_PROPERTY_BUILD_TOPLEVEL_TIME);
+    const double nodes    = (double)rtcGetDeviceProperty(g_device,RTC_DEVICE_PROPERTY_BUILD_TOPLEVEL_NODES);
+    if (nodes != 0.0)
+      std::cout << "  toplevel: " << toplevel/iterations << " s, " << nodes/iterations << " nodes" << std::endl;
+  }
+
   void convertTriangleMesh(ISPCTriangleMesh* mesh, RTCScene scene_out, RTCBuildQuality quality)
   {
     RTCGeometry geom = rtcNewGeometry (g_device, RTC_GEOMETRY_TYPE_TRIANGLE);
@@ -202,6 +230,8 @@ namespace embree {
         time += t1 - t0;
         iterations++;
       }
+      if (i+1 == skip_iterations)
+        resetBuildPhaseTimes();
     }
 
     if (quality == RTC_BUILD_QUALITY_MEDIUM)
@@ -216,6 +246,7 @@ namespace embree {
     std::cout << primitives << " primitives, " << objects << " objects, "
               << time/iterations << " s, "
               << 1.0 / (time/iterations) * primitives / 1000000.0 << " Mprims/s" << std::endl;
+    printBuildPhaseTimes(iterations);
 
     rtcReleaseScene (g_scene);
     g_scene = nullptr;
@@ -242,6 +273,8 @@ namespace embree {
         time += t1 - t0;
         iterations++;
       }
+      if (i+1 == skip_iterations)
+        resetBuildPhaseTimes();
     }
 
     if (quality == RTC_BUILD_QUALITY_MEDIUM)
@@ -256,6 +289,7 @@ namespace embree {
     std::cout << primitives << " primitives, " << objects << " objects, "
               << time/iterations << " s, "
               << 1.0 / (time/iterations) * primitives / 1000000.0 << " Mprims/s" << std::endl;
+    printBuildPhaseTimes(iterations);
 
     rtcReleaseScene (g_scene);
     g_scene = nullptr;
@@ -281,6 +315,8 @@ namespace embree {
         time += t1 - t0;
         iterations++;
       }
+      if (i+1 == skip_iterations)
+        resetBuildPhaseTimes();
       rtcReleaseScene (g_scene);
     }
 
@@ -301,6 +337,7 @@ namespace embree {
     std::cout << primitives << " primitives, " << objects << " objects, "
               << time/iterations << " s, "
               << 1.0 / (time/iterations) * primitives / 1000000.0 << " Mprims/s" << std::endl;
+    printBuildPhaseTimes(iterations);
 
     g_scene = nullptr;
   }
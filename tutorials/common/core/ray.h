@@ -50,7 +50,12 @@
                       unsigned int geomID = RTC_INVALID_GEOMETRY_ID, 
                       unsigned int primID = RTC_INVALID_GEOMETRY_ID, 
                       unsigned int instID = RTC_INVALID_GEOMETRY_ID)
-      : org(org,tnear), dir(dir,time), tfar(tfar), mask(mask), primID(primID), geomID(geomID), instID(instID)  {}
+      : org(org,tnear), dir(dir,time), tfar(tfar), mask(mask), primID(primID), geomID(geomID)
+    {
+      this->instID[0] = instID;
+      for (unsigned l = 1; l < RTC_MAX_INSTANCE_LEVEL_COUNT; ++l)
+        this->instID[l] = RTC_INVALID_GEOMETRY_ID;
+    }
 
     /*! Tests if we hit something. */
     __forceinline operator bool() const { return geomID != RTC_INVALID_GEOMETRY_ID; }
@@ -71,7 +76,7 @@
     float v;                  //!< Barycentric v coordinate of hit
     unsigned int primID;           //!< primitive ID
     unsigned int geomID;           //!< geometry ID
-    unsigned int instID;           //!< instance ID
+    unsigned int instID[RTC_MAX_INSTANCE_LEVEL_COUNT]; //!< instance ID stack
 
     __forceinline float &tnear() { return org.w; };
     __forceinline float &time()  { return dir.w; };
@@ -123,7 +128,7 @@ __forceinline RTCRay* RTCRay1_(Ray& ray) {
   inline std::ostream& operator<<(std::ostream& cout, const Ray& ray) {
     return cout << "{ " << 
       "org = " << ray.org << ", dir = " << ray.dir << ", near = " << ray.tnear() << ", far = " << ray.tfar << ", time = " << ray.time() << ", " <<
-      "instID = " << ray.instID <<  ", geomID = " << ray.geomID << ", primID = " << ray.primID <<  ", " << "u = " << ray.u <<  ", v = " << ray.v << ", Ng = " << ray.Ng << " }";
+      "instID = " << ray.instID[0] <<  ", geomID = " << ray.geomID << ", primID = " << ray.primID <<  ", " << "u = " << ray.u <<  ", v = " << ray.v << ", Ng = " << ray.Ng << " }";
   }
 
 /*! intersection context passed to intersect/occluded calls */
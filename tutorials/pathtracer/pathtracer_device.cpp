@@ -1466,7 +1466,7 @@ void intersectionFilterOBJ(const RTCFilterFunctionNArguments* args)
   if (min(min(brdf.Kt.x,brdf.Kt.y),brdf.Kt.z) < 1.0f)
   {
     ray->tfar   = tfar;
-    // ray->instID = dg.instID;
+    // ray->instID[0] = dg.instID;
     // ray->geomID = dg.geomID;
     // ray->primID = dg.primID;    
     // ray->u      = dg.u;
@@ -1631,7 +1631,7 @@ Vec3fa renderPixelFunction(float x, float y, RandomSampler& sampler, const ISPCC
     Vec3fa Ns = normalize(ray.Ng);
 
     /* compute differential geometry */
-    dg.instID = ray.instID;
+    dg.instID = ray.instID[0];
     dg.geomID = ray.geomID;
     dg.primID = ray.primID;
     dg.u = ray.u;
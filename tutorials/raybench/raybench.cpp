@@ -0,0 +1,77 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "../common/tutorial/tutorial.h"
+
+namespace embree
+{
+  /* benchmark settings, shared with the device code */
+  extern size_t g_num_iterations;
+  extern FileName g_json_file;
+  extern FileName g_compare_file;
+  extern float g_tolerance;
+
+  extern int raybench_run(const std::string& sceneName, const ISPCCamera& camera, const unsigned int width, const unsigned int height);
+
+  struct Tutorial : public SceneLoadingTutorialApplication
+  {
+    Tutorial()
+      : SceneLoadingTutorialApplication("ray_bench",FEATURE_RTCORE) 
+    {
+      interactive = false;
+
+      registerOption("iterations", [] (Ref<ParseStream> cin, const FileName& path) {
+          g_num_iterations = max(1,cin->getInt());
+        }, "--iterations <int>: number of measured iterations per benchmark, the fastest one is reported");
+
+      registerOption("json", [] (Ref<ParseStream> cin, const FileName& path) {
+          g_json_file = cin->getFileName();
+        }, "--json <filename>: writes the benchmark results as JSON to this file instead of stdout");
+
+      registerOption("compare", [] (Ref<ParseStream> cin, const FileName& path) {
+          g_compare_file = cin->getFileName();
+        }, "--compare <filename>: compares against the results of an earlier --json run and fails on regressions");
+
+      registerOption("tolerance", [] (Ref<ParseStream> cin, const FileName& path) {
+          g_tolerance = cin->getFloat();
+        }, "--tolerance <float>: relative slowdown tolerated by --compare (default 0.05)");
+    }
+    
+    void postParseCommandLine() 
+    {
+      /* load default scene if none specified */
+      if (sceneFilename.ext() == "") {
+        FileName file = FileName::executableFolder() + FileName("models/cornell_box.ecs");
+        parseCommandLine(new ParseStream(new LineCommentFilter(file, "#")), file.path());
+      }
+    }
+
+    int main(int argc, char** argv)
+    {
+      /* loads the scene and builds the acceleration structure */
+      const int error = SceneLoadingTutorialApplication::main(argc,argv);
+      if (error) return error;
+
+      /* rays are generated from the camera of the scene */
+      return raybench_run(sceneFilename.base(),camera.getISPCCamera(width,height),width,height);
+    }
+  };
+
+}
+
+int main(int argc, char** argv) {
+  return embree::Tutorial().main(argc,argv);
+}
@@ -0,0 +1,488 @@
+// ======================================================================== //
+// Copyright 2009-2018 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "../common/math/random_sampler.h"
+#include "../common/math/sampling.h"
+#include "../common/tutorial/tutorial_device.h"
+#include "../common/tutorial/scene_device.h"
+#include "../../common/sys/filename.h"
+
+#include <fstream>
+#include <map>
+
+namespace embree {
+
+  /* benchmark settings */
+  size_t g_num_iterations = 5;
+  FileName g_json_file;
+  FileName g_compare_file;
+  float g_tolerance = 0.05f;
+
+  /* number of rays processed by one task */
+  static const size_t BLOCK_SIZE = 1024;
+
+  /* number of rays passed to one rtcIntersect1M/rtcIntersectNp call */
+  static const size_t STREAM_SIZE = 64;
+
+  extern "C" ISPCScene* g_ispc_scene;
+  extern "C" int g_instancing_mode;
+
+  /* scene data */
+  RTCScene g_scene = nullptr;
+
+  /* set of rays traced by the benchmarks */
+  struct RaySet
+  {
+    RaySet (const std::string& name, bool shadow, RTCIntersectContextFlags flags)
+      : name(name), shadow(shadow), flags(flags) {}
+
+    std::string name;
+    bool shadow;                     //!< traces occlusion instead of intersection rays
+    RTCIntersectContextFlags flags;  //!< coherency hint passed to the intersect context
+    avector<Ray> rays;
+  };
+
+  /* result of a single benchmark */
+  struct BenchmarkResult
+  {
+    BenchmarkResult (const std::string& name, size_t numRays, double seconds)
+      : name(name), numRays(numRays), seconds(seconds) {}
+
+    double mraysPerSecond() const {
+      return double(numRays)/(1000000.0*seconds);
+    }
+
+    std::string name;
+    size_t numRays;
+    double seconds;
+  };
+
+  /* ray packet of K rays of the packet API */
+  template<int K> struct RayPacket {};
+
+  template<> struct RayPacket<4>
+  {
+    typedef RTCRayHit4 RayHitK;
+    static __forceinline void intersect(const int* valid, RTCIntersectContext* context, RayHitK& ray) { rtcIntersect4(valid,g_scene,context,&ray); }
+    static __forceinline void occluded (const int* valid, RTCIntersectContext* context, RayHitK& ray) { rtcOccluded4 (valid,g_scene,context,&ray.ray); }
+    static bool supported() { return rtcGetDeviceProperty(g_device,RTC_DEVICE_PROPERTY_NATIVE_RAY4_SUPPORTED); }
+  };
+
+  template<> struct RayPacket<8>
+  {
+    typedef RTCRayHit8 RayHitK;
+    static __forceinline void intersect(const int* valid, RTCIntersectContext* context, RayHitK& ray) { rtcIntersect8(valid,g_scene,context,&ray); }
+    static __forceinline void occluded (const int* valid, RTCIntersectContext* context, RayHitK& ray) { rtcOccluded8 (valid,g_scene,context,&ray.ray); }
+    static bool supported() { return rtcGetDeviceProperty(g_device,RTC_DEVICE_PROPERTY_NATIVE_RAY8_SUPPORTED); }
+  };
+
+  template<> struct RayPacket<16>
+  {
+    typedef RTCRayHit16 RayHitK;
+    static __forceinline void intersect(const int* valid, RTCIntersectContext* context, RayHitK& ray) { rtcIntersect16(valid,g_scene,context,&ray); }
+    static __forceinline void occluded (const int* valid, RTCIntersectContext* context, RayHitK& ray) { rtcOccluded16 (valid,g_scene,context,&ray.ray); }
+    static bool supported() { return rtcGetDeviceProperty(g_device,RTC_DEVICE_PROPERTY_NATIVE_RAY16_SUPPORTED); }
+  };
+
+  /* rays in pointer SOA layout as used by rtcIntersectNp */
+  struct RayStreamSOA
+  {
+    RayStreamSOA (const avector<Ray>& rays)
+      : org_x(rays.size()), org_y(rays.size()), org_z(rays.size()), tnear(rays.size()),
+        dir_x(rays.size()), dir_y(rays.size()), dir_z(rays.size()), time(rays.size()),
+        tfar(rays.size()), mask(rays.size()), id(rays.size()), flags(rays.size()),
+        Ng_x(rays.size()), Ng_y(rays.size()), Ng_z(rays.size()), u(rays.size()), v(rays.size()),
+        primID(rays.size()), geomID(rays.size()), instID(rays.size())
+    {
+      for (size_t i=0; i<rays.size(); i++)
+      {
+        const Ray& ray = rays[i];
+        org_x[i] = ray.org.x; org_y[i] = ray.org.y; org_z[i] = ray.org.z; tnear[i] = ray.tnear();
+        dir_x[i] = ray.dir.x; dir_y[i] = ray.dir.y; dir_z[i] = ray.dir.z; time[i] = ray.time();
+        tfar[i] = ray.tfar; mask[i] = ray.mask; id[i] = ray.id; flags[i] = ray.flags;
+        primID[i] = ray.primID; geomID[i] = ray.geomID; instID[i] = ray.instID[0];
+      }
+    }
+
+    void reset(const avector<Ray>& rays)
+    {
+      for (size_t i=0; i<rays.size(); i++) {
+        tfar[i] = rays[i].tfar;
+        geomID[i] = rays[i].geomID;
+      }
+    }
+
+    /* returns the stream of rays starting at ray i */
+    RTCRayHitNp get(size_t i)
+    {
+      RTCRayHitNp stream;
+      stream.ray.org_x = &org_x[i]; stream.ray.org_y = &org_y[i]; stream.ray.org_z = &org_z[i]; stream.ray.tnear = &tnear[i];
+      stream.ray.dir_x = &dir_x[i]; stream.ray.dir_y = &dir_y[i]; stream.ray.dir_z = &dir_z[i]; stream.ray.time  = &time[i];
+      stream.ray.tfar  = &tfar[i];  stream.ray.mask  = &mask[i];  stream.ray.id    = &id[i];    stream.ray.flags = &flags[i];
+      stream.hit.Ng_x  = &Ng_x[i];  stream.hit.Ng_y  = &Ng_y[i];  stream.hit.Ng_z  = &Ng_z[i];
+      stream.hit.u     = &u[i];     stream.hit.v     = &v[i];
+      stream.hit.primID = &primID[i]; stream.hit.geomID = &geomID[i]; stream.hit.instID[0] = &instID[i];
+      return stream;
+    }
+
+    avector<float> org_x, org_y, org_z, tnear;
+    avector<float> dir_x, dir_y, dir_z, time;
+    avector<float> tfar;
+    avector<unsigned int> mask, id, flags;
+    avector<float> Ng_x, Ng_y, Ng_z, u, v;
+    avector<unsigned int> primID, geomID, instID;
+  };
+
+  /* returns the best time of all measured iterations, the first iteration only warms up */
+  template<typename Reset, typename Trace>
+  double measure(const Reset& reset, const Trace& trace)
+  {
+    double best = inf;
+    for (size_t i=0; i<g_num_iterations+1; i++)
+    {
+      reset();
+      double t0 = getSeconds();
+      trace();
+      double t1 = getSeconds();
+      if (i > 0) best = min(best,t1-t0);
+    }
+    return best;
+  }
+
+  /* traces the rays in blocks of BLOCK_SIZE rays in parallel */
+  template<typename Func>
+  void traceBlocks(const RaySet& set, const Func& func)
+  {
+    const size_t N = set.rays.size();
+    parallel_for((N+BLOCK_SIZE-1)/BLOCK_SIZE,[&](size_t block) {
+      RTCIntersectContext context;
+      rtcInitIntersectContext(&context);
+      context.flags = set.flags;
+      func(&context,block*BLOCK_SIZE,min((block+1)*BLOCK_SIZE,N));
+    });
+  }
+
+  BenchmarkResult benchmarkSingle(const RaySet& set)
+  {
+    avector<Ray> rays;
+    const double time = measure([&] { rays = set.rays; }, [&] {
+        traceBlocks(set,[&] (RTCIntersectContext* context, size_t begin, size_t end) {
+            if (set.shadow) {
+              for (size_t i=begin; i<end; i++) rtcOccluded1(g_scene,context,RTCRay_(rays[i]));
+            } else {
+              for (size_t i=begin; i<end; i++) rtcIntersect1(g_scene,context,RTCRayHit_(rays[i]));
+            }
+          });
+      });
+    return BenchmarkResult(set.name + (set.shadow ? ".rtcOccluded1" : ".rtcIntersect1"),set.rays.size(),time);
+  }
+
+  template<int K>
+  BenchmarkResult benchmarkPacket(const RaySet& set)
+  {
+    typedef typename RayPacket<K>::RayHitK RayHitK;
+    static_assert(BLOCK_SIZE % K == 0,"block size has to be a multiple of the packet size");
+
+    /* converts the rays to packets, the unused lanes of the last packet repeat its last ray */
+    const size_t N = set.rays.size();
+    avector<RayHitK> packets0((N+K-1)/K);
+    for (size_t p=0; p<packets0.size(); p++)
+    {
+      RayHitK& packet = packets0[p];
+      for (size_t k=0; k<K; k++)
+      {
+        const Ray& ray = set.rays[min(p*K+k,N-1)];
+        packet.ray.org_x[k] = ray.org.x; packet.ray.org_y[k] = ray.org.y; packet.ray.org_z[k] = ray.org.z; packet.ray.tnear[k] = ray.tnear();
+        packet.ray.dir_x[k] = ray.dir.x; packet.ray.dir_y[k] = ray.dir.y; packet.ray.dir_z[k] = ray.dir.z; packet.ray.time[k]  = ray.time();
+        packet.ray.tfar[k] = ray.tfar; packet.ray.mask[k] = ray.mask; packet.ray.id[k] = ray.id; packet.ray.flags[k] = ray.flags;
+        packet.hit.primID[k] = ray.primID; packet.hit.geomID[k] = ray.geomID; packet.hit.instID[0][k] = ray.instID[0];
+      }
+    }
+
+    avector<RayHitK> packets;
+    const double time = measure([&] { packets = packets0; }, [&] {
+        traceBlocks(set,[&] (RTCIntersectContext* context, size_t begin, size_t end) {
+            for (size_t i=begin; i<end; i+=K)
+            {
+              int valid[K];
+              for (size_t k=0; k<K; k++) valid[k] = i+k < end ? -1 : 0;
+              if (set.shadow) RayPacket<K>::occluded (valid,context,packets[i/K]);
+              else            RayPacket<K>::intersect(valid,context,packets[i/K]);
+            }
+          });
+      });
+    return BenchmarkResult(set.name + (set.shadow ? ".rtcOccluded" : ".rtcIntersect") + std::to_string(K),N,time);
+  }
+
+  BenchmarkResult benchmarkStream1M(const RaySet& set)
+  {
+    avector<Ray> rays;
+    const double time = measure([&] { rays = set.rays; }, [&] {
+        traceBlocks(set,[&] (RTCIntersectContext* context, size_t begin, size_t end) {
+            for (size_t i=begin; i<end; i+=STREAM_SIZE)
+            {
+              const unsigned int M = (unsigned int) min(STREAM_SIZE,end-i);
+              if (set.shadow) rtcOccluded1M (g_scene,context,RTCRay_(rays[i]),M,sizeof(Ray));
+              else            rtcIntersect1M(g_scene,context,RTCRayHit_(rays[i]),M,sizeof(Ray));
+            }
+          });
+      });
+    return BenchmarkResult(set.name + (set.shadow ? ".rtcOccluded1M" : ".rtcIntersect1M"),set.rays.size(),time);
+  }
+
+  BenchmarkResult benchmarkStreamNp(const RaySet& set)
+  {
+    RayStreamSOA stream(set.rays);
+    const double time = measure([&] { stream.reset(set.rays); }, [&] {
+        traceBlocks(set,[&] (RTCIntersectContext* context, size_t begin, size_t end) {
+            for (size_t i=begin; i<end; i+=STREAM_SIZE)
+            {
+              const unsigned int N = (unsigned int) min(STREAM_SIZE,end-i);
+              RTCRayHitNp rays = stream.get(i);
+              if (set.shadow) rtcOccludedNp (g_scene,context,&rays.ray,N);
+              else            rtcIntersectNp(g_scene,context,&rays,N);
+            }
+          });
+      });
+    return BenchmarkResult(set.name + (set.shadow ? ".rtcOccludedNp" : ".rtcIntersectNp"),set.rays.size(),time);
+  }
+
+  /* generates primary rays in screen tile order */
+  void generatePrimaryRays(RaySet& set, const ISPCCamera& camera, const unsigned int width, const unsigned int height)
+  {
+    const unsigned int numTilesX = (width +TILE_SIZE_X-1)/TILE_SIZE_X;
+    const unsigned int numTilesY = (height+TILE_SIZE_Y-1)/TILE_SIZE_Y;
+    for (unsigned int tileY=0; tileY<numTilesY; tileY++)
+    {
+      for (unsigned int tileX=0; tileX<numTilesX; tileX++)
+      {
+        for (unsigned int y=tileY*TILE_SIZE_Y; y<min((tileY+1)*TILE_SIZE_Y,height); y++)
+        {
+          for (unsigned int x=tileX*TILE_SIZE_X; x<min((tileX+1)*TILE_SIZE_X,width); x++)
+          {
+            const Vec3fa dir = normalize(float(x)*camera.xfm.l.vx + float(y)*camera.xfm.l.vy + camera.xfm.l.vz);
+            Ray ray(Vec3fa(camera.xfm.p),dir,0.0f,inf);
+            ray.id = (unsigned int) set.rays.size();
+            ray.flags = 0;
+            set.rays.push_back(ray);
+          }
+        }
+      }
+    }
+  }
+
+  /* generates secondary rays from the hit points of the primary rays, rays
+   * that missed the scene start at the camera instead */
+  void generateSecondaryRays(RaySet& diffuse, RaySet& shadow, const RaySet& primary)
+  {
+    RTCBounds b;
+    rtcGetSceneBounds(g_scene,&b);
+    const Vec3fa lower(b.lower_x,b.lower_y,b.lower_z);
+    const Vec3fa upper(b.upper_x,b.upper_y,b.upper_z);
+    const float eps = 1E-4f*length(upper-lower);
+
+    /* point light below the top of the scene */
+    const Vec3fa center = 0.5f*(lower+upper);
+    const Vec3fa light(center.x,lower.y+0.9f*(upper.y-lower.y),center.z);
+
+    avector<Ray> hits = primary.rays;
+    traceBlocks(primary,[&] (RTCIntersectContext* context, size_t begin, size_t end) {
+        for (size_t i=begin; i<end; i++) rtcIntersect1(g_scene,context,RTCRayHit_(hits[i]));
+      });
+
+    diffuse.rays.resize(hits.size());
+    shadow.rays.resize(hits.size());
+    for (size_t i=0; i<hits.size(); i++)
+    {
+      const Ray& hit = hits[i];
+      RandomSampler sampler;
+      RandomSampler_init(sampler,(int)i);
+      
+      Vec3fa org = Vec3fa(hit.org);
+      Vec3fa dir = normalize(RandomSampler_get3D(sampler)-Vec3fa(0.5f));
+      if (hit.geomID != RTC_INVALID_GEOMETRY_ID) 
+      {
+        Vec3fa Ng = normalize(Vec3fa(hit.Ng));
+        if (dot(Ng,Vec3fa(hit.dir)) > 0.0f) Ng = -Ng;
+        org = Vec3fa(hit.org) + hit.tfar*Vec3fa(hit.dir) + eps*Ng;
+        dir = frame(Ng) * cosineSampleHemisphere(RandomSampler_get2D(sampler));
+      }
+      
+      diffuse.rays[i] = Ray(org,dir,0.0f,inf);
+      shadow.rays[i] = Ray(org,light-org,0.0f,1.0f-1E-4f);
+      diffuse.rays[i].id = shadow.rays[i].id = (unsigned int) i;
+      diffuse.rays[i].flags = shadow.rays[i].flags = 0;
+    }
+  }
+
+  /* reads the results of an earlier run, every benchmark is on a separate line */
+  bool readResults(const FileName& fileName, std::map<std::string,double>& results)
+  {
+    std::ifstream file(fileName.c_str());
+    if (!file.is_open()) 
+      return false;
+
+    std::string line;
+    while (std::getline(file,line))
+    {
+      const std::string nameKey = "\"name\": \"";
+      const std::string mraysKey = "\"mrays_per_s\": ";
+      const size_t name = line.find(nameKey);
+      const size_t mrays = line.find(mraysKey);
+      if (name == std::string::npos || mrays == std::string::npos) continue;
+      const size_t nameBegin = name+nameKey.size();
+      const size_t nameEnd = line.find('"',nameBegin);
+      results[line.substr(nameBegin,nameEnd-nameBegin)] = std::stod(line.substr(mrays+mraysKey.size()));
+    }
+    return true;
+  }
+
+  void writeResults(std::ostream& out, const std::string& sceneName, const unsigned int width, const unsigned int height,
+                    const std::vector<BenchmarkResult>& results)
+  {
+    IOStreamStateRestorer cout_state(out);
+    out.setf(std::ios::fixed, std::ios::floatfield);
+    out.precision(4);
+
+    out << "{" << std::endl;
+    out << "  \"scene\": \"" << sceneName << "\"," << std::endl;
+    out << "  \"width\": " << width << "," << std::endl;
+    out << "  \"height\": " << height << "," << std::endl;
+    out << "  \"iterations\": " << g_num_iterations << "," << std::endl;
+    out << "  \"benchmarks\": [" << std::endl;
+    for (size_t i=0; i<results.size(); i++)
+    {
+      const BenchmarkResult& result = results[i];
+      out << "    { \"name\": \"" << result.name << "\", \"rays\": " << result.numRays 
+          << ", \"seconds\": " << std::setprecision(6) << result.seconds 
+          << ", \"mrays_per_s\": " << std::setprecision(4) << result.mraysPerSecond() << " }"
+          << (i+1 < results.size() ? "," : "") << std::endl;
+    }
+    out << "  ]" << std::endl;
+    out << "}" << std::endl;
+  }
+
+  /* compares against the earlier results, returns false if some benchmark got slower than tolerated */
+  bool compareResults(const std::vector<BenchmarkResult>& results, const FileName& fileName)
+  {
+    std::map<std::string,double> reference;
+    if (!readResults(fileName,reference)) {
+      std::cerr << "cannot read benchmark results from " << fileName << std::endl;
+      return false;
+    }
+
+    bool passed = true;
+    for (const BenchmarkResult& result : results)
+    {
+      auto ref = reference.find(result.name);
+      if (ref == reference.end()) continue;
+      const double mrays = result.mraysPerSecond();
+      if (mrays >= (1.0-g_tolerance)*ref->second) continue;
+      std::cerr << "regression in " << result.name << ": " << mrays << " Mrays/s, expected at least " 
+                << (1.0-g_tolerance)*ref->second << " Mrays/s (" << ref->second << " Mrays/s in " << fileName << ")" << std::endl;
+      passed = false;
+    }
+    return passed;
+  }
+
+  template<int K>
+  void benchmarkPacketIfSupported(const RaySet& set, std::vector<BenchmarkResult>& results)
+  {
+    if (RayPacket<K>::supported())
+      results.push_back(benchmarkPacket<K>(set));
+  }
+
+  int raybench_run(const std::string& sceneName, const ISPCCamera& camera, const unsigned int width, const unsigned int height)
+  {
+    /* nothing to do if the scene was not loaded */
+    if (g_scene == nullptr) 
+      return 0;
+
+    RaySet coherent("coherent",false,RTC_INTERSECT_CONTEXT_FLAG_COHERENT);
+    RaySet incoherent("incoherent",false,RTC_INTERSECT_CONTEXT_FLAG_INCOHERENT);
+    RaySet shadow("shadow",true,RTC_INTERSECT_CONTEXT_FLAG_INCOHERENT);
+    generatePrimaryRays(coherent,camera,width,height);
+    generateSecondaryRays(incoherent,shadow,coherent);
+
+    std::vector<BenchmarkResult> results;
+    for (const RaySet* set : { &coherent, &incoherent, &shadow })
+    {
+      results.push_back(benchmarkSingle(*set));
+      benchmarkPacketIfSupported<4>(*set,results);
+      benchmarkPacketIfSupported<8>(*set,results);
+      benchmarkPacketIfSupported<16>(*set,results);
+      results.push_back(benchmarkStream1M(*set));
+      results.push_back(benchmarkStreamNp(*set));
+    }
+
+    if (g_json_file.str() != "") {
+      std::ofstream file(g_json_file.c_str());
+      writeResults(file,sceneName,width,height,results);
+    } else {
+      writeResults(std::cout,sceneName,width,height,results);
+    }
+
+    if (g_compare_file.str() != "" && !compareResults(results,g_compare_file))
+      return 1;
+
+    return 0;
+  }
+
+  /* called by the C++ code for initialization */
+  extern "C" void device_init (char* cfg)
+  {
+    g_scene = ConvertScene(g_device, g_ispc_scene, RTC_BUILD_QUALITY_MEDIUM);
+
+    /* commit individual objects in case of instancing */
+    if (g_instancing_mode != ISPC_INSTANCING_NONE)
+    {
+      for (unsigned int i=0; i<g_ispc_scene->numGeometries; i++) {
+        ISPCGeometry* geometry = g_ispc_scene->geometries[i];
+        if (geometry->type == GROUP) rtcCommitScene(geometry->scene);
+      }
+    }
+    rtcCommitScene (g_scene);
+  }
+
+  /* called by the C++ code to render */
+  extern "C" void device_render (int* pixels,
+                                 const unsigned int width,
+                                 const unsigned int height,
+                                 const float time,
+                                 const ISPCCamera& camera)
+  {
+  }
+
+  /* renders a single screen tile */
+  void renderTileStandard(int taskIndex,
+                          int threadIndex,
+                          int* pixels,
+                          const unsigned int width,
+                          const unsigned int height,
+                          const float time,
+                          const ISPCCamera& camera,
+                          const int numTilesX,
+                          const int numTilesY)
+  {
+  }
+
+  /* called by the C++ code for cleanup */
+  extern "C" void device_cleanup ()
+  {
+    rtcReleaseScene (g_scene); g_scene = nullptr;
+  }
+
+} // namespace embree
@@ -22,6 +22,7 @@
 #include "../../common/algorithms/parallel_for.h"
 #include <regex>
 #include <stack>
+#include <set>
 
 #define random  use_random_function_of_test // do use random_int() and random_float() from Test class
 #define drand48 use_random_function_of_test // do use random_int() and random_float() from Test class
@@ -830,6 +831,333 @@ namespace embree
     }
   };
 
+  struct PointQueryTest : public VerifyApplication::Test
+  {
+    GeometryType gtype;
+    SceneFlags sflags;
+    bool instanced;
+
+    PointQueryTest (std::string name, int isa, GeometryType gtype, SceneFlags sflags, bool instanced)
+      : VerifyApplication::Test(name,isa,VerifyApplication::TEST_SHOULD_PASS), gtype(gtype), sflags(sflags), instanced(instanced) {}
+
+    /* reference distance of a point to a triangle, independent of the kernel used by the implementation */
+    static float distanceTriangle(const Vec3fa& p, const Vec3fa& a, const Vec3fa& b, const Vec3fa& c)
+    {
+      auto distanceSegment = [&] (const Vec3fa& a, const Vec3fa& b) {
+        const float t = clamp(dot(p-a,b-a)/dot(b-a,b-a),0.0f,1.0f);
+        return length(p-(a+t*(b-a)));
+      };
+      const Vec3fa Ng = cross(b-a,c-a);
+      const Vec3fa q = p - dot(p-a,Ng)/dot(Ng,Ng)*Ng;
+      if (dot(cross(b-a,q-a),Ng) >= 0.0f && dot(cross(c-b,q-b),Ng) >= 0.0f && dot(cross(a-c,q-c),Ng) >= 0.0f)
+        return length(p-q);
+      return min(distanceSegment(a,b),distanceSegment(b,c),distanceSegment(c,a));
+    }
+
+    struct QueryData
+    {
+      std::vector<float> dist;    // reference distance of each primitive
+      std::vector<bool> visited;  // primitives passed to the query function
+      unsigned int instID;        // expected instance ID
+      bool valid;
+    };
+
+    static bool queryFunc(RTCPointQueryFunctionArguments* args)
+    {
+      QueryData* data = (QueryData*) args->userPtr;
+      if (args->geomID != 0 || args->primID >= data->visited.size() || args->instID[0] != data->instID) {
+        data->valid = false;
+        return false;
+      }
+      data->visited[args->primID] = true;
+      return false;
+    }
+
+    VerifyApplication::TestReturnValue run(VerifyApplication* state, bool silent)
+    {
+      std::string cfg = state->rtcore + ",isa="+stringOfISA(isa);
+      RTCDeviceRef device = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device));
+
+      Ref<SceneGraph::Node> node = nullptr;
+      switch (gtype) {
+      case TRIANGLE_MESH   : node = SceneGraph::createTriangleSphere(zero,1.0f,20); break;
+      case TRIANGLE_MESH_MB: node = SceneGraph::createTriangleSphere(zero,1.0f,20)->set_motion_vector(Vec3fa(1.0f)); break;
+      case QUAD_MESH       : node = SceneGraph::createQuadSphere(zero,1.0f,20); break;
+      case QUAD_MESH_MB    : node = SceneGraph::createQuadSphere(zero,1.0f,20)->set_motion_vector(Vec3fa(1.0f)); break;
+      default: return VerifyApplication::SKIPPED;
+      }
+
+      Ref<VerifyScene> mesh_scene = new VerifyScene(device,sflags);
+      mesh_scene->addGeometry(sflags.qflags,node);
+      rtcCommitScene(*mesh_scene);
+      AssertNoError(device);
+
+      /* optionally query through a scaled, rotated and translated instance */
+      AffineSpace3fa xfm = one;
+      RTCScene scene = *mesh_scene;
+      Ref<VerifyScene> top_scene = nullptr;
+      unsigned int instID = RTC_INVALID_GEOMETRY_ID;
+      if (instanced)
+      {
+        xfm = AffineSpace3fa::translate(Vec3fa(1.0f,-2.0f,0.5f))*AffineSpace3fa::rotate(Vec3fa(1.0f,1.0f,0.0f),0.7f)*AffineSpace3fa::scale(Vec3fa(2.0f,1.0f,0.5f));
+        top_scene = new VerifyScene(device,sflags);
+        RTCGeometry instance = rtcNewGeometry (device, RTC_GEOMETRY_TYPE_INSTANCE);
+        rtcSetGeometryInstancedScene(instance,*mesh_scene);
+        rtcSetGeometryTransform(instance,0,RTC_FORMAT_FLOAT4X4_COLUMN_MAJOR,(float*)&xfm);
+        rtcCommitGeometry(instance);
+        instID = rtcAttachGeometry(*top_scene,instance);
+        rtcReleaseGeometry(instance);
+        rtcCommitScene(*top_scene);
+        scene = *top_scene;
+      }
+      AssertNoError(device);
+
+      for (size_t i=0; i<64; i++)
+      {
+        const Vec3fa p = xfmPoint(xfm,Vec3fa(2.0f*random_float()-1.0f,2.0f*random_float()-1.0f,2.0f*random_float()-1.0f)*1.5f);
+        const float time = (gtype == TRIANGLE_MESH_MB || gtype == QUAD_MESH_MB) ? random_float() : 0.0f;
+
+        /* reference distances of all primitives in world space */
+        QueryData data;
+        auto vertex = [&] (const avector<Vec3fa>& p0, const avector<Vec3fa>& p1, unsigned int v) {
+          return xfmPoint(xfm,lerp(p0[v],p1[v],time));
+        };
+        if (Ref<SceneGraph::TriangleMeshNode> mesh = node.dynamicCast<SceneGraph::TriangleMeshNode>()) {
+          const avector<Vec3fa>& p0 = mesh->positions.front(), p1 = mesh->positions.back();
+          for (auto& tri : mesh->triangles)
+            data.dist.push_back(distanceTriangle(p,vertex(p0,p1,tri.v0),vertex(p0,p1,tri.v1),vertex(p0,p1,tri.v2)));
+        }
+        else if (Ref<SceneGraph::QuadMeshNode> mesh = node.dynamicCast<SceneGraph::QuadMeshNode>()) {
+          const avector<Vec3fa>& p0 = mesh->positions.front(), p1 = mesh->positions.back();
+          for (auto& quad : mesh->quads)
+            data.dist.push_back(min(distanceTriangle(p,vertex(p0,p1,quad.v0),vertex(p0,p1,quad.v1),vertex(p0,p1,quad.v3)),
+                                    distanceTriangle(p,vertex(p0,p1,quad.v2),vertex(p0,p1,quad.v3),vertex(p0,p1,quad.v1))));
+        }
+        const float minDist = *std::min_element(data.dist.begin(),data.dist.end());
+        const float eps = 1E-4f*max(1.0f,minDist);
+
+        /* the query function has to get called for all primitives within the radius */
+        RTCPointQuery query;
+        query.x = p.x; query.y = p.y; query.z = p.z;
+        query.time = time;
+        query.radius = minDist + 0.2f;
+        data.visited.resize(data.dist.size(),false);
+        data.instID = instID;
+        data.valid = true;
+        rtcPointQuery(scene,&query,queryFunc,&data);
+        AssertNoError(device);
+        if (!data.valid) return VerifyApplication::FAILED;
+        for (size_t j=0; j<data.dist.size(); j++)
+          if (data.dist[j] < query.radius-eps && !data.visited[j]) return VerifyApplication::FAILED;
+
+        /* the closest point query has to find the closest primitive */
+        RTCClosestPoint result;
+        query.radius = inf;
+        if (!rtcClosestPoint(scene,&query,&result)) return VerifyApplication::FAILED;
+        AssertNoError(device);
+        if (result.geomID != 0 || result.instID[0] != instID) return VerifyApplication::FAILED;
+        if (result.primID >= data.dist.size()) return VerifyApplication::FAILED;
+        if (abs(query.radius-minDist) > eps) return VerifyApplication::FAILED;
+        if (abs(data.dist[result.primID]-minDist) > eps) return VerifyApplication::FAILED;
+        if (abs(length(Vec3fa(result.x,result.y,result.z)-p)-minDist) > eps) return VerifyApplication::FAILED;
+      }
+      return VerifyApplication::PASSED;
+    }
+  };
+
+  struct CollideTest : public VerifyApplication::Test
+  {
+    GeometryType gtype;
+    SceneFlags sflags;
+    bool self;
+
+    CollideTest (std::string name, int isa, GeometryType gtype, SceneFlags sflags, bool self)
+      : VerifyApplication::Test(name,isa,VerifyApplication::TEST_SHOULD_PASS), gtype(gtype), sflags(sflags), self(self) {}
+
+    typedef std::pair<std::pair<unsigned,unsigned>,std::pair<unsigned,unsigned>> Collision;
+
+    struct CollideData
+    {
+      MutexSys mutex;
+      std::set<Collision> collisions;
+    };
+
+    static void collideFunc(void* userPtr, RTCCollision* collisions, unsigned int num_collisions)
+    {
+      CollideData* data = (CollideData*) userPtr;
+      Lock<MutexSys> lock(data->mutex);
+      for (unsigned int i=0; i<num_collisions; i++)
+        data->collisions.insert(Collision(std::make_pair(collisions[i].geomID0,collisions[i].primID0),
+                                          std::make_pair(collisions[i].geomID1,collisions[i].primID1)));
+    }
+
+    /* bounds of all primitives over all time steps */
+    static std::vector<BBox3fa> primBounds(const Ref<SceneGraph::Node>& node)
+    {
+      std::vector<BBox3fa> bounds;
+      if (Ref<SceneGraph::TriangleMeshNode> mesh = node.dynamicCast<SceneGraph::TriangleMeshNode>()) {
+        for (auto& tri : mesh->triangles) {
+          BBox3fa b = empty;
+          for (auto& p : mesh->positions) b.extend(p[tri.v0]), b.extend(p[tri.v1]), b.extend(p[tri.v2]);
+          bounds.push_back(b);
+        }
+      }
+      else if (Ref<SceneGraph::QuadMeshNode> mesh = node.dynamicCast<SceneGraph::QuadMeshNode>()) {
+        for (auto& quad : mesh->quads) {
+          BBox3fa b = empty;
+          for (auto& p : mesh->positions) b.extend(p[quad.v0]), b.extend(p[quad.v1]), b.extend(p[quad.v2]), b.extend(p[quad.v3]);
+          bounds.push_back(b);
+        }
+      }
+      return bounds;
+    }
+
+    VerifyApplication::TestReturnValue run(VerifyApplication* state, bool silent)
+    {
+      std::string cfg = state->rtcore + ",isa="+stringOfISA(isa);
+      RTCDeviceRef device = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device));
+
+      /* two overlapping spheres */
+      Ref<SceneGraph::Node> node[2];
+      for (size_t i=0; i<2; i++)
+      {
+        const Vec3fa center(0.7f*i,0.1f*i,0.0f);
+        switch (gtype) {
+        case TRIANGLE_MESH   : node[i] = SceneGraph::createTriangleSphere(center,1.0f,20); break;
+        case TRIANGLE_MESH_MB: node[i] = SceneGraph::createTriangleSphere(center,1.0f,20)->set_motion_vector(Vec3fa(0.2f)); break;
+        case QUAD_MESH       : node[i] = SceneGraph::createQuadSphere(center,1.0f,20); break;
+        case QUAD_MESH_MB    : node[i] = SceneGraph::createQuadSphere(center,1.0f,20)->set_motion_vector(Vec3fa(0.2f)); break;
+        default: return VerifyApplication::SKIPPED;
+        }
+      }
+
+      /* either collide a scene containing both spheres with itself, or two scenes containing one sphere each */
+      Ref<VerifyScene> scene0 = new VerifyScene(device,sflags);
+      Ref<VerifyScene> scene1 = self ? scene0 : new VerifyScene(device,sflags);
+      unsigned geomID0 = scene0->addGeometry(sflags.qflags,node[0]);
+      unsigned geomID1 = scene1->addGeometry(sflags.qflags,node[1]);
+      rtcCommitScene(*scene0);
+      if (!self) rtcCommitScene(*scene1);
+      AssertNoError(device);
+
+      CollideData data;
+      rtcCollide(*scene0,*scene1,collideFunc,&data);
+      AssertNoError(device);
+
+      /* brute force reference, self collisions report each unordered pair of different primitives */
+      const std::vector<BBox3fa> bounds[2] = { primBounds(node[0]), primBounds(node[1]) };
+      const unsigned geomIDs[2] = { geomID0, geomID1 };
+      std::set<Collision> expected;
+      for (size_t g0=0; g0<2; g0++)
+        for (size_t g1=0; g1<2; g1++)
+        {
+          if (!self && (g0 != 0 || g1 != 1)) continue;
+          for (unsigned i=0; i<bounds[g0].size(); i++)
+            for (unsigned j=0; j<bounds[g1].size(); j++)
+              if ((g0 != g1 || i != j) && conjoint(bounds[g0][i],bounds[g1][j]))
+                expected.insert(Collision(std::make_pair(geomIDs[g0],i),std::make_pair(geomIDs[g1],j)));
+        }
+
+      for (auto& c : data.collisions)
+      {
+        if (!expected.count(c)) return VerifyApplication::FAILED;
+        if (self && c.first == c.second) return VerifyApplication::FAILED;
+      }
+      /* spatial splits may cull pairs with overlapping bounds but separated geometry */
+      if (sflags.qflags == RTC_BUILD_QUALITY_HIGH)
+        return VerifyApplication::PASSED;
+
+      for (auto& c : expected)
+      {
+        const Collision swapped(c.second,c.first);
+        if (!data.collisions.count(c) && !(self && data.collisions.count(swapped)))
+          return VerifyApplication::FAILED;
+      }
+      return VerifyApplication::PASSED;
+    }
+  };
+
+  struct SaveLoadBVHTest : public VerifyApplication::Test
+  {
+    GeometryType gtype;
+    SceneFlags sflags;
+
+    SaveLoadBVHTest (std::string name, int isa, GeometryType gtype, SceneFlags sflags)
+      : VerifyApplication::Test(name,isa,VerifyApplication::TEST_SHOULD_PASS), gtype(gtype), sflags(sflags) {}
+
+    VerifyApplication::TestReturnValue run(VerifyApplication* state, bool silent)
+    {
+      std::string cfg = state->rtcore + ",isa="+stringOfISA(isa);
+      RTCDeviceRef device = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device));
+
+      Ref<SceneGraph::Node> node[2];
+      for (size_t i=0; i<2; i++)
+      {
+        const Vec3fa center(2.0f*i,0.0f,0.0f);
+        switch (gtype) {
+        case TRIANGLE_MESH   : node[i] = SceneGraph::createTriangleSphere(center,1.0f,50); break;
+        case TRIANGLE_MESH_MB: node[i] = SceneGraph::createTriangleSphere(center,1.0f,50)->set_motion_vector(Vec3fa(0.5f)); break;
+        case QUAD_MESH       : node[i] = SceneGraph::createQuadSphere(center,1.0f,50); break;
+        case QUAD_MESH_MB    : node[i] = SceneGraph::createQuadSphere(center,1.0f,50)->set_motion_vector(Vec3fa(0.5f)); break;
+        case GRID_MESH       : node[i] = SceneGraph::createGridSphere(center,1.0f,50); break;
+        case GRID_MESH_MB    : node[i] = SceneGraph::createGridSphere(center,1.0f,50)->set_motion_vector(Vec3fa(0.5f)); break;
+        default: return VerifyApplication::SKIPPED;
+        }
+      }
+
+      /* build and save the BVH of the first scene */
+      Ref<VerifyScene> scene0 = new VerifyScene(device,sflags);
+      for (size_t i=0; i<2; i++) scene0->addGeometry(sflags.qflags,node[i]);
+      rtcCommitScene(*scene0);
+      AssertNoError(device);
+
+      const std::string fileName = "verify." + stringOfISA(isa) + "." + name + ".bvh";
+      rtcSaveSceneBVH(*scene0,fileName.c_str());
+      AssertNoError(device);
+
+      /* load the BVH into a second scene with the same geometries */
+      Ref<VerifyScene> scene1 = new VerifyScene(device,sflags);
+      for (size_t i=0; i<2; i++) scene1->addGeometry(sflags.qflags,node[i]);
+      rtcLoadSceneBVH(*scene1,fileName.c_str());
+      AssertNoError(device);
+
+      /* loading into a scene with different geometries has to fail */
+      Ref<VerifyScene> scene2 = new VerifyScene(device,sflags);
+      scene2->addGeometry(sflags.qflags,node[0]);
+      rtcLoadSceneBVH(*scene2,fileName.c_str());
+      AssertError(device,RTC_ERROR_INVALID_OPERATION);
+      std::remove(fileName.c_str());
+
+      /* both scenes have to produce identical hits */
+      RTCIntersectContext context;
+      rtcInitIntersectContext(&context);
+      for (size_t i=0; i<256; i++)
+      {
+        const Vec3fa org(2.0f*random_float()-0.5f,2.0f*random_float()-1.0f,5.0f);
+        const Vec3fa dir = Vec3fa(1.0f,0.0f,0.0f) - org + Vec3fa(random_float()-0.5f,random_float()-0.5f,0.0f);
+        RTCRayHit ray0 = makeRay(org,dir);
+        ray0.ray.time = random_float();
+        RTCRayHit ray1 = ray0;
+        rtcIntersect1(*scene0,&context,&ray0);
+        rtcIntersect1(*scene1,&context,&ray1);
+        if (ray0.hit.geomID != ray1.hit.geomID) return VerifyApplication::FAILED;
+        if (ray0.hit.primID != ray1.hit.primID) return VerifyApplication::FAILED;
+        if (ray0.ray.tfar != ray1.ray.tfar) return VerifyApplication::FAILED;
+      }
+      AssertNoError(device);
+
+      RTCBounds bounds0, bounds1;
+      rtcGetSceneBounds(*scene0,&bounds0);
+      rtcGetSceneBounds(*scene1,&bounds1);
+      if (bounds0.lower_x != bounds1.lower_x || bounds0.lower_y != bounds1.lower_y || bounds0.lower_z != bounds1.lower_z) return VerifyApplication::FAILED;
+      if (bounds0.upper_x != bounds1.upper_x || bounds0.upper_y != bounds1.upper_y || bounds0.upper_z != bounds1.upper_z) return VerifyApplication::FAILED;
+      return VerifyApplication::PASSED;
+    }
+  };
+
   struct GetUserDataTest : public VerifyApplication::Test
   {
     GetUserDataTest (std::string name, int isa)
@@ -1277,6 +1605,7 @@ namespace embree
           case RTC_SCENE_FLAG_NONE: return has_avx ?  70.0f*NN :  63.0f*NN; // triangle4
           case RTC_SCENE_FLAG_ROBUST : return has_avx ?  70.0f*NN :  63.0f*NN; // triangle4v
           case RTC_SCENE_FLAG_COMPACT: return has_avx ?  35.0f*NN :  35.0f*NN; // triangle4i
+          case RTC_SCENE_FLAG_COMPRESSED: return has_avx ?  30.0f*NN :  30.0f*NN; // qbvh4.triangle4i
           default: return inf;
           }
           
@@ -1285,6 +1614,7 @@ namespace embree
           case RTC_SCENE_FLAG_NONE: return has_avx2 ? 55.0f*NN : 45.0f*NN; // triangle4imb
           case RTC_SCENE_FLAG_ROBUST : return has_avx2 ? 55.0f*NN : 45.0f*NN; // triangle4imb
           case RTC_SCENE_FLAG_COMPACT: return has_avx2 ? 45.0f*NN : 45.0f*NN; // triangle4imb
+          case RTC_SCENE_FLAG_COMPRESSED: return has_avx2 ? 45.0f*NN : 45.0f*NN; // triangle4imb
           default: return inf;
           }
           
@@ -1292,12 +1622,14 @@ namespace embree
           case RTC_SCENE_FLAG_NONE: return has_avx ? 85.0f*NN : 79.0f*NN; // quad4v
           case RTC_SCENE_FLAG_ROBUST : return has_avx ? 85.0f*NN : 79.0f*NN; // quad4v
           case RTC_SCENE_FLAG_COMPACT: return has_avx ? 41.0f*NN : 41.0f*NN; // quad4i
+          case RTC_SCENE_FLAG_COMPRESSED: return has_avx ? 36.0f*NN : 36.0f*NN; // qbvh4.quad4i
           default: return inf;
           }
         case QUAD_MESH_MB: switch (sflags.sflags) {
           case RTC_SCENE_FLAG_NONE: return has_avx ? 68.0f*NN : 53.0f*NN; // quad4imb
           case RTC_SCENE_FLAG_ROBUST : return has_avx ? 68.0f*NN : 53.0f*NN; // quad4imb
           case RTC_SCENE_FLAG_COMPACT: return has_avx ? 53.0f*NN : 53.0f*NN; // quad4imb
+          case RTC_SCENE_FLAG_COMPRESSED: return has_avx ? 53.0f*NN : 53.0f*NN; // quad4imb
           default: return inf;
           }
           
@@ -1305,6 +1637,7 @@ namespace embree
           case RTC_SCENE_FLAG_NONE: return has_avx2 ?  222.0f*NN : 165.0f*NN; // bezier1v
           case RTC_SCENE_FLAG_ROBUST : return has_avx2 ?  222.0f*NN : 165.0f*NN; // bezier1v
           case RTC_SCENE_FLAG_COMPACT: return has_avx2 ?  105.0f*NN : 105.0f*NN; // bezier1i
+          case RTC_SCENE_FLAG_COMPRESSED: return has_avx2 ?  105.0f*NN : 105.0f*NN; // bezier1i
           default: return inf;
           }
           
@@ -1312,6 +1645,7 @@ namespace embree
           case RTC_SCENE_FLAG_NONE: return has_avx2 ?  386.0f*NN : 190.0f*NN; // bezier1i // FIXME: 386 are very loose bounds
           case RTC_SCENE_FLAG_ROBUST : return has_avx2 ?  386.0f*NN : 190.0f*NN; // bezier1i // FIXME: 386 are very loose bounds 
           case RTC_SCENE_FLAG_COMPACT: return has_avx2 ?  190.0f*NN : 190.0f*NN; // bezier1i
+          case RTC_SCENE_FLAG_COMPRESSED: return has_avx2 ?  190.0f*NN : 190.0f*NN; // bezier1i
           default: return inf;
           }
           
@@ -1319,6 +1653,7 @@ namespace embree
           case RTC_SCENE_FLAG_NONE: return has_avx ? 32.0f*NN : 26.0f*NN; // line4i
           case RTC_SCENE_FLAG_ROBUST : return has_avx ? 32.0f*NN : 26.0f*NN; // line4i
           case RTC_SCENE_FLAG_COMPACT: return has_avx ? 26.0f*NN : 26.0f*NN; // line4i
+          case RTC_SCENE_FLAG_COMPRESSED: return has_avx ? 26.0f*NN : 26.0f*NN; // line4i
           default: return inf;
           }
           
@@ -1326,6 +1661,7 @@ namespace embree
           case RTC_SCENE_FLAG_NONE: return has_avx ? 45.0f*NN : 36.0f*NN; // line4i
           case RTC_SCENE_FLAG_ROBUST : return has_avx ? 45.0f*NN : 36.0f*NN; // line4i
           case RTC_SCENE_FLAG_COMPACT: return has_avx ? 36.0f*NN : 36.0f*NN; // line4i
+          case RTC_SCENE_FLAG_COMPRESSED: return has_avx ? 36.0f*NN : 36.0f*NN; // line4i
           default: return inf;
           }
           
@@ -1669,35 +2005,716 @@ namespace embree
       
       for (size_t i=0; i<16; i++) 
       {
-        bool move0 = i & 1, move1 = i & 2, move2 = i & 4, move3 = i & 8;
-        Vec3fa ds(2,0.1f,2,0.0f);
-        if (move0) { move_mesh(hgeom0,numVertices,ds); pos0 += ds; }
-        if (move1) { move_mesh(hgeom1,numVertices,ds); pos1 += ds; }
-        if (move2) { move_mesh(hgeom2,numVertices,ds); pos2 += ds; }
-        if (move3) { move_mesh(hgeom3,4,ds); pos3 += ds; }
-        rtcCommitScene (scene);
-        AssertNoError(device);
+        bool move0 = i & 1, move1 = i & 2, move2 = i & 4, move3 = i & 8;
+        Vec3fa ds(2,0.1f,2,0.0f);
+        if (move0) { move_mesh(hgeom0,numVertices,ds); pos0 += ds; }
+        if (move1) { move_mesh(hgeom1,numVertices,ds); pos1 += ds; }
+        if (move2) { move_mesh(hgeom2,numVertices,ds); pos2 += ds; }
+        if (move3) { move_mesh(hgeom3,4,ds); pos3 += ds; }
+        rtcCommitScene (scene);
+        AssertNoError(device);
+
+        RTCRayHit ray0 = makeRay(pos0+Vec3fa(0,10,0),Vec3fa(0,-1,0)); // hits geomID == 0
+        RTCRayHit ray1 = makeRay(pos1+Vec3fa(0,10,0),Vec3fa(0,-1,0)); // hits geomID == 1
+        RTCRayHit ray2 = makeRay(pos2+Vec3fa(0,10,0),Vec3fa(0,-1,0)); // hits geomID == 2
+        RTCRayHit ray3 = makeRay(pos3+Vec3fa(0,10,0),Vec3fa(0,-1,0)); // hits geomID == 3
+        RTCRayHit testRays[4] = { ray0, ray1, ray2, ray3 };
+
+        const unsigned int maxRays = 100;
+        RTCRayHit rays[maxRays];
+        for (unsigned int numRays=1; numRays<maxRays; numRays++) {
+          for (size_t i=0; i<numRays; i++) rays[i] = testRays[i%4];
+          IntersectWithMode(imode,ivariant,scene,rays,numRays);
+          for (size_t i=0; i<numRays; i++)
+            if (ivariant & VARIANT_INTERSECT) {
+              if (rays[i].hit.geomID == RTC_INVALID_GEOMETRY_ID)
+                return VerifyApplication::FAILED;
+            }
+            else {
+              if (rays[i].ray.tfar != float(neg_inf))
+                return VerifyApplication::FAILED;
+            }
+        }
+      }
+      AssertNoError(device);
+
+      return VerifyApplication::PASSED;
+    }
+  };
+
+  struct RefitDegradationTest : public VerifyApplication::Test
+  {
+    std::string config;
+    
+    RefitDegradationTest (std::string name, int isa, std::string config)
+      : VerifyApplication::Test(name,isa,VerifyApplication::TEST_SHOULD_PASS), config(config) {}
+
+    VerifyApplication::TestReturnValue run(VerifyApplication* state, bool silent)
+    {
+      std::string cfg = state->rtcore + ",isa="+stringOfISA(isa) + "," + config;
+      RTCDeviceRef device = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device));
+      VerifyScene scene(device,SceneFlags(RTC_SCENE_FLAG_DYNAMIC,RTC_BUILD_QUALITY_LOW));
+      AssertNoError(device);
+
+      /* grid of small triangles that get randomly shuffled between
+       * the grid cells, which quickly degrades a refitted BVH */
+      const unsigned int gridSize = 100;
+      const unsigned int numTriangles = gridSize*gridSize;
+      RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_TRIANGLE);
+      rtcSetGeometryBuildQuality(geom,RTC_BUILD_QUALITY_REFIT);
+      Vec3fa* vertices = (Vec3fa*) rtcSetNewGeometryBuffer(geom,RTC_BUFFER_TYPE_VERTEX,0,RTC_FORMAT_FLOAT3,sizeof(Vec3fa),3*numTriangles);
+      Triangle* triangles = (Triangle*) rtcSetNewGeometryBuffer(geom,RTC_BUFFER_TYPE_INDEX,0,RTC_FORMAT_UINT3,sizeof(Triangle),numTriangles);
+      for (unsigned int i=0; i<numTriangles; i++)
+        triangles[i] = Triangle(3*i+0,3*i+1,3*i+2);
+      std::vector<unsigned int> cells(numTriangles);
+      for (unsigned int i=0; i<numTriangles; i++)
+        cells[i] = i;
+      
+      auto cellCenter = [&] (unsigned int cell) {
+        return Vec3fa(float(cell%gridSize)+0.37f,0.0f,float(cell/gridSize)+0.37f);
+      };
+      
+      auto placeTriangles = [&] ()
+      {
+        for (unsigned int i=0; i<numTriangles; i++) {
+          const Vec3fa p = Vec3fa(float(cells[i]%gridSize),0.0f,float(cells[i]/gridSize));
+          vertices[3*i+0] = p+Vec3fa(0.1f,0.0f,0.1f);
+          vertices[3*i+1] = p+Vec3fa(0.9f,0.0f,0.1f);
+          vertices[3*i+2] = p+Vec3fa(0.1f,0.0f,0.9f);
+        }
+      };
+      
+      placeTriangles();
+      rtcCommitGeometry(geom);
+      rtcAttachGeometry(scene,geom);
+      rtcReleaseGeometry(geom);
+
+      for (size_t frame=0; frame<8; frame++)
+      {
+        if (frame > 0)
+        {
+          for (unsigned int i=numTriangles-1; i>0; i--)
+            std::swap(cells[i],cells[RandomSampler_getUInt(sampler) % (i+1)]);
+          
+          placeTriangles();
+          rtcUpdateGeometryBuffer(geom,RTC_BUFFER_TYPE_VERTEX,0);
+          rtcCommitGeometry(geom);
+        }
+        rtcCommitScene (scene);
+        AssertNoError(device);
+
+        for (size_t i=0; i<256; i++)
+        {
+          const unsigned int primID = RandomSampler_getUInt(sampler) % numTriangles;
+          RTCRayHit ray = makeRay(cellCenter(cells[primID])+Vec3fa(0.0f,1.0f,0.0f),Vec3fa(0.0f,-1.0f,0.0f));
+          IntersectWithMode(MODE_INTERSECT1,VARIANT_INTERSECT,scene,&ray,1);
+          if (ray.hit.primID != primID) return VerifyApplication::FAILED;
+        }
+      }
+      AssertNoError(device);
+
+      return VerifyApplication::PASSED;
+    }
+  };
+
+  struct CompareBuildersTest : public VerifyApplication::Test
+  {
+    std::string model;
+    std::string config;
+    
+    CompareBuildersTest (std::string name, int isa, std::string model, std::string config)
+      : VerifyApplication::Test(name,isa,VerifyApplication::TEST_SHOULD_PASS), model(model), config(config) {}
+
+    VerifyApplication::TestReturnValue run(VerifyApplication* state, bool silent)
+    {
+      /* the same scene gets build with the default and the configured builder */
+      std::string cfg = state->rtcore + ",isa="+stringOfISA(isa);
+      RTCDeviceRef device0 = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device0));
+      RTCDeviceRef device1 = rtcNewDevice((cfg+","+config).c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device1));
+
+      const size_t numPhi = state->intensity < 1.0f ? 50 : 200;
+      Ref<SceneGraph::Node> sphere = model == "quads"
+        ? SceneGraph::createQuadSphere(zero,2.0f,numPhi)
+        : SceneGraph::createTriangleSphere(zero,2.0f,numPhi);
+      
+      /* many identical triangles have identical merge costs */
+      Ref<SceneGraph::TriangleMeshNode> duplicates = new SceneGraph::TriangleMeshNode(nullptr,1);
+      for (unsigned int i=0; i<1000; i++) {
+        duplicates->positions[0].push_back(Vec3fa(0.0f,0.0f,0.0f));
+        duplicates->positions[0].push_back(Vec3fa(0.1f,0.0f,0.0f));
+        duplicates->positions[0].push_back(Vec3fa(0.0f,0.1f,0.0f));
+        duplicates->triangles.push_back(SceneGraph::TriangleMeshNode::Triangle(3*i+0,3*i+1,3*i+2));
+      }
+
+      VerifyScene scene0(device0,SceneFlags(RTC_SCENE_FLAG_NONE,RTC_BUILD_QUALITY_MEDIUM));
+      VerifyScene scene1(device1,SceneFlags(RTC_SCENE_FLAG_NONE,RTC_BUILD_QUALITY_MEDIUM));
+      scene0.addGeometry(RTC_BUILD_QUALITY_MEDIUM,sphere);
+      scene1.addGeometry(RTC_BUILD_QUALITY_MEDIUM,sphere);
+      scene0.addGeometry(RTC_BUILD_QUALITY_MEDIUM,duplicates.dynamicCast<SceneGraph::Node>());
+      scene1.addGeometry(RTC_BUILD_QUALITY_MEDIUM,duplicates.dynamicCast<SceneGraph::Node>());
+      rtcCommitScene (scene0);
+      AssertNoError(device0);
+      rtcCommitScene (scene1);
+      AssertNoError(device1);
+
+      /* rays from inside the sphere have to find the same hits */
+      for (size_t i=0; i<size_t(10000*state->intensity); i++)
+      {
+        const Vec3fa org = 2.0f*random_Vec3fa()-Vec3fa(1.0f);
+        const Vec3fa dir = 2.0f*random_Vec3fa()-Vec3fa(1.0f);
+        RTCRayHit ray0 = makeRay(org,dir);
+        RTCRayHit ray1 = makeRay(org,dir);
+        IntersectWithMode(MODE_INTERSECT1,VARIANT_INTERSECT,scene0,&ray0,1);
+        IntersectWithMode(MODE_INTERSECT1,VARIANT_INTERSECT,scene1,&ray1,1);
+        if (ray1.hit.geomID == RTC_INVALID_GEOMETRY_ID) return VerifyApplication::FAILED;
+        if (ray0.hit.geomID != ray1.hit.geomID) return VerifyApplication::FAILED;
+        if (ray0.hit.geomID == 0 && ray0.hit.primID != ray1.hit.primID) return VerifyApplication::FAILED;
+        if (ray0.ray.tfar != ray1.ray.tfar) return VerifyApplication::FAILED;
+      }
+      AssertNoError(device0);
+      AssertNoError(device1);
+
+      return VerifyApplication::PASSED;
+    }
+  };
+
+  struct TwoLevelRefitTest : public VerifyApplication::Test
+  {
+    std::string config;
+    
+    TwoLevelRefitTest (std::string name, int isa, std::string config)
+      : VerifyApplication::Test(name,isa,VerifyApplication::TEST_SHOULD_PASS), config(config) {}
+
+    VerifyApplication::TestReturnValue run(VerifyApplication* state, bool silent)
+    {
+      std::string cfg = state->rtcore + ",isa="+stringOfISA(isa) + "," + config;
+      RTCDeviceRef device = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device));
+      VerifyScene scene(device,SceneFlags(RTC_SCENE_FLAG_DYNAMIC,RTC_BUILD_QUALITY_LOW));
+      AssertNoError(device);
+
+      /* grid of single triangle geometries, some of them move slightly
+       * each frame and some get shuffled between the grid cells */
+      const unsigned int gridSize = 40;
+      const unsigned int numGeometries = gridSize*gridSize;
+      std::vector<RTCGeometry> geoms(numGeometries);
+      std::vector<unsigned int> cells(numGeometries);
+      std::vector<float> offsets(numGeometries,0.0f);
+      for (unsigned int i=0; i<numGeometries; i++)
+      {
+        cells[i] = i;
+        geoms[i] = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_TRIANGLE);
+        rtcSetNewGeometryBuffer(geoms[i],RTC_BUFFER_TYPE_VERTEX,0,RTC_FORMAT_FLOAT3,sizeof(Vec3fa),3);
+        Triangle* triangles = (Triangle*) rtcSetNewGeometryBuffer(geoms[i],RTC_BUFFER_TYPE_INDEX,0,RTC_FORMAT_UINT3,sizeof(Triangle),1);
+        triangles[0] = Triangle(0,1,2);
+      }
+      
+      auto cellCenter = [&] (unsigned int i) {
+        return Vec3fa(float(cells[i]%gridSize)+0.37f,0.0f,float(cells[i]/gridSize)+0.37f);
+      };
+      
+      auto placeGeometry = [&] (unsigned int i)
+      {
+        Vec3fa* vertices = (Vec3fa*) rtcGetGeometryBufferData(geoms[i],RTC_BUFFER_TYPE_VERTEX,0);
+        const Vec3fa p = Vec3fa(float(cells[i]%gridSize),offsets[i],float(cells[i]/gridSize));
+        vertices[0] = p+Vec3fa(0.1f,0.0f,0.1f);
+        vertices[1] = p+Vec3fa(0.9f,0.0f,0.1f);
+        vertices[2] = p+Vec3fa(0.1f,0.0f,0.9f);
+        rtcUpdateGeometryBuffer(geoms[i],RTC_BUFFER_TYPE_VERTEX,0);
+        rtcCommitGeometry(geoms[i]);
+      };
+      
+      for (unsigned int i=0; i<numGeometries; i++) {
+        placeGeometry(i);
+        rtcAttachGeometryByID(scene,geoms[i],i);
+      }
+
+      for (size_t frame=0; frame<12; frame++)
+      {
+        if (frame > 0)
+        {
+          for (unsigned int i=0; i<numGeometries/8; i++) {
+            const unsigned int geomID = RandomSampler_getUInt(sampler) % numGeometries;
+            offsets[geomID] = 0.1f*RandomSampler_getFloat(sampler);
+            placeGeometry(geomID);
+          }
+          
+          /* every few frames a quarter of the geometries gets shuffled */
+          if (frame % 4 == 0)
+          {
+            for (unsigned int i=0; i<numGeometries/4; i++) {
+              const unsigned int a = RandomSampler_getUInt(sampler) % numGeometries;
+              const unsigned int b = RandomSampler_getUInt(sampler) % numGeometries;
+              std::swap(cells[a],cells[b]);
+              placeGeometry(a);
+              placeGeometry(b);
+            }
+          }
+        }
+        rtcCommitScene (scene);
+        AssertNoError(device);
+
+        for (size_t i=0; i<256; i++)
+        {
+          const unsigned int geomID = RandomSampler_getUInt(sampler) % numGeometries;
+          RTCRayHit ray = makeRay(cellCenter(geomID)+Vec3fa(0.0f,1.0f,0.0f),Vec3fa(0.0f,-1.0f,0.0f));
+          IntersectWithMode(MODE_INTERSECT1,VARIANT_INTERSECT,scene,&ray,1);
+          if (ray.hit.geomID != geomID) return VerifyApplication::FAILED;
+        }
+      }
+
+      for (unsigned int i=0; i<numGeometries; i++)
+        rtcReleaseGeometry(geoms[i]);
+      AssertNoError(device);
+
+      return VerifyApplication::PASSED;
+    }
+  };
+
+  struct TwoLevelClustersTest : public VerifyApplication::Test
+  {
+    TwoLevelClustersTest (std::string name, int isa)
+      : VerifyApplication::Test(name,isa,VerifyApplication::TEST_SHOULD_PASS) {}
+
+    VerifyApplication::TestReturnValue run(VerifyApplication* state, bool silent)
+    {
+      /* the same scene gets build with a single and with a clustered top level build */
+      std::string cfg = state->rtcore + ",isa="+stringOfISA(isa);
+      RTCDeviceRef device0 = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device0));
+      RTCDeviceRef device1 = rtcNewDevice((cfg+",twolevel_cluster_threshold=2").c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device1));
+
+      /* a grid of small spheres, large enough to create multiple clusters */
+      const int numGrid = state->intensity < 1.0f ? 72 : 128;
+      VerifyScene scene0(device0,SceneFlags(RTC_SCENE_FLAG_NONE,RTC_BUILD_QUALITY_LOW));
+      VerifyScene scene1(device1,SceneFlags(RTC_SCENE_FLAG_NONE,RTC_BUILD_QUALITY_LOW));
+      for (int z=0; z<numGrid; z++)
+      {
+        for (int x=0; x<numGrid; x++)
+        {
+          const Vec3fa pos(float(x)+0.5f,0.5f,float(z)+0.5f);
+          Ref<SceneGraph::Node> sphere = SceneGraph::createTriangleSphere(pos,0.1f+0.3f*random_float(),4);
+          scene0.addGeometry(RTC_BUILD_QUALITY_LOW,sphere);
+          scene1.addGeometry(RTC_BUILD_QUALITY_LOW,sphere);
+        }
+      }
+
+      rtcSetDeviceProperty(device1,RTC_DEVICE_PROPERTY_BUILD_TOPLEVEL_NODES,0);
+      rtcCommitScene (scene0);
+      AssertNoError(device0);
+      rtcCommitScene (scene1);
+      AssertNoError(device1);
+      if (rtcGetDeviceProperty(device1,RTC_DEVICE_PROPERTY_BUILD_TOPLEVEL_NODES) == 0)
+        return VerifyApplication::FAILED;
+
+      /* rays through the grid have to find the same hits */
+      for (size_t i=0; i<size_t(10000*state->intensity); i++)
+      {
+        const Vec3fa org = Vec3fa(float(numGrid)*random_float(),2.0f,float(numGrid)*random_float());
+        const Vec3fa dir = Vec3fa(2.0f*random_float()-1.0f,-1.0f,2.0f*random_float()-1.0f);
+        RTCRayHit ray0 = makeRay(org,dir);
+        RTCRayHit ray1 = makeRay(org,dir);
+        IntersectWithMode(MODE_INTERSECT1,VARIANT_INTERSECT,scene0,&ray0,1);
+        IntersectWithMode(MODE_INTERSECT1,VARIANT_INTERSECT,scene1,&ray1,1);
+        if (ray0.hit.geomID != ray1.hit.geomID) return VerifyApplication::FAILED;
+        if (ray0.hit.primID != ray1.hit.primID) return VerifyApplication::FAILED;
+        if (ray0.ray.tfar != ray1.ray.tfar) return VerifyApplication::FAILED;
+      }
+      AssertNoError(device0);
+      AssertNoError(device1);
+
+      return VerifyApplication::PASSED;
+    }
+  };
+
+  struct AsyncCommitTest : public VerifyApplication::Test
+  {
+    SceneFlags sflags;
+    
+    AsyncCommitTest (std::string name, int isa, SceneFlags sflags)
+      : VerifyApplication::Test(name,isa,VerifyApplication::TEST_SHOULD_PASS), sflags(sflags) {}
+
+    struct Completion
+    {
+      Completion () : count(0), error(RTC_ERROR_NONE) {}
+      std::atomic<size_t> count;
+      RTCError error;
+    };
+
+    static void complete(void* userPtr, RTCScene scene, RTCError error)
+    {
+      Completion* completion = (Completion*) userPtr;
+      if (error != RTC_ERROR_NONE) completion->error = error;
+      completion->count++;
+    }
+
+    VerifyApplication::TestReturnValue run(VerifyApplication* state, bool silent)
+    {
+      std::string cfg = state->rtcore + ",isa="+stringOfISA(isa);
+      RTCDeviceRef device = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device));
+      Ref<VerifyScene> scene = new VerifyScene(device,sflags);
+      AssertNoError(device);
+
+      /* plane of many triangles over [0,1]x[0,1] that moves up by one each frame */
+      const unsigned int num = state->intensity < 1.0f ? 200 : 400;
+      RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_TRIANGLE);
+      Vec3fa* vertices = (Vec3fa*) rtcSetNewGeometryBuffer(geom,RTC_BUFFER_TYPE_VERTEX,0,RTC_FORMAT_FLOAT3,sizeof(Vec3fa),(num+1)*(num+1));
+      Triangle* triangles = (Triangle*) rtcSetNewGeometryBuffer(geom,RTC_BUFFER_TYPE_INDEX,0,RTC_FORMAT_UINT3,sizeof(Triangle),2*num*num);
+      for (unsigned int y=0; y<num; y++) {
+        for (unsigned int x=0; x<num; x++) {
+          const unsigned int p00 = (y+0)*(num+1)+x+0, p01 = (y+0)*(num+1)+x+1;
+          const unsigned int p10 = (y+1)*(num+1)+x+0, p11 = (y+1)*(num+1)+x+1;
+          triangles[2*(y*num+x)+0] = Triangle(p00,p01,p10);
+          triangles[2*(y*num+x)+1] = Triangle(p01,p11,p10);
+        }
+      }
+
+      auto placePlane = [&] (float height)
+      {
+        for (unsigned int y=0; y<=num; y++)
+          for (unsigned int x=0; x<=num; x++)
+            vertices[y*(num+1)+x] = Vec3fa(float(x)/float(num),height,float(y)/float(num));
+        rtcUpdateGeometryBuffer(geom,RTC_BUFFER_TYPE_VERTEX,0);
+        rtcCommitGeometry(geom);
+      };
+      
+      auto traceHeight = [&] () -> float
+      {
+        const Vec3fa org(0.01f+0.98f*RandomSampler_getFloat(sampler),10.0f,0.01f+0.98f*RandomSampler_getFloat(sampler));
+        RTCRayHit ray = makeRay(org,Vec3fa(0.0f,-1.0f,0.0f));
+        IntersectWithMode(MODE_INTERSECT1,VARIANT_INTERSECT,*scene,&ray,1);
+        if (ray.hit.geomID == RTC_INVALID_GEOMETRY_ID) return neg_inf;
+        return floorf(10.0f-ray.ray.tfar+0.5f);
+      };
+
+      placePlane(0.0f);
+      rtcAttachGeometry(*scene,geom);
+      rtcCommitScene (*scene);
+      AssertNoError(device);
+      
+      /* rays have to see the plane of the last completed commit while the next one builds */
+      Completion completion;
+      for (size_t frame=1; frame<8; frame++)
+      {
+        const float oldHeight = float(frame-1);
+        const float newHeight = float(frame);
+        placePlane(newHeight);
+
+        /* one commit in between is a regular one */
+        if (frame == 4) {
+          rtcCommitScene (*scene);
+          AssertNoError(device);
+        }
+        else
+        {
+          const size_t count = completion.count;
+          rtcCommitSceneAsync (*scene,complete,&completion);
+          AssertNoError(device);
+          
+          while (true)
+          {
+            const bool done0 = rtcIsSceneCommitDone(*scene);
+            const float height = traceHeight();
+            const bool done1 = rtcIsSceneCommitDone(*scene);
+            if (!done1 && height != oldHeight) return VerifyApplication::FAILED;
+            if (done0 && height != newHeight) return VerifyApplication::FAILED;
+            if (height != oldHeight && height != newHeight) return VerifyApplication::FAILED;
+            if (done0) break;
+          }
+          if (completion.count != count+1) return VerifyApplication::FAILED;
+          if (completion.error != RTC_ERROR_NONE) return VerifyApplication::FAILED;
+        }
+
+        for (size_t i=0; i<64; i++)
+          if (traceHeight() != newHeight) return VerifyApplication::FAILED;
+      }
+      AssertNoError(device);
+
+      /* release the scene while an asynchronous commit may still be running */
+      placePlane(10.0f);
+      rtcCommitSceneAsync (*scene,nullptr,nullptr);
+      AssertNoError(device);
+      scene = nullptr;
+      rtcReleaseGeometry(geom);
+      AssertNoError(device);
+
+      return VerifyApplication::PASSED;
+    }
+  };
+
+  struct NumaTest : public VerifyApplication::Test
+  {
+    SceneFlags sflags;
+    
+    NumaTest (std::string name, int isa, SceneFlags sflags)
+      : VerifyApplication::Test(name,isa,VerifyApplication::TEST_SHOULD_PASS), sflags(sflags) {}
+
+    VerifyApplication::TestReturnValue run(VerifyApplication* state, bool silent)
+    {
+      /* the same scene gets build without and with two emulated NUMA nodes, static scenes get replicated to both nodes */
+      std::string cfg = state->rtcore + ",isa="+stringOfISA(isa);
+      RTCDeviceRef device0 = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device0));
+      RTCDeviceRef device1 = rtcNewDevice((cfg+",numa=1,numa_nodes=2,numa_replication_threshold=0").c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device1));
+
+      const int numGrid = state->intensity < 1.0f ? 8 : 16;
+      VerifyScene scene0(device0,sflags);
+      VerifyScene scene1(device1,sflags);
+      for (int z=0; z<numGrid; z++)
+      {
+        for (int x=0; x<numGrid; x++)
+        {
+          const Vec3fa pos(float(x)+0.5f,0.5f,float(z)+0.5f);
+          Ref<SceneGraph::Node> sphere = (x+z)%2 ? SceneGraph::createTriangleSphere(pos,0.1f+0.3f*random_float(),8) : SceneGraph::createQuadSphere(pos,0.1f+0.3f*random_float(),8);
+          scene0.addGeometry(sflags.qflags,sphere);
+          scene1.addGeometry(sflags.qflags,sphere);
+        }
+      }
+
+      /* commit twice to also release the copies of the first commit */
+      for (size_t commit=0; commit<2; commit++)
+      {
+        rtcCommitScene (scene0);
+        AssertNoError(device0);
+        rtcCommitScene (scene1);
+        AssertNoError(device1);
+
+        /* rays through the grid have to find the same hits with all ray types */
+        IntersectMode modes[] = { MODE_INTERSECT1, MODE_INTERSECT4, MODE_INTERSECT1M };
+        for (IntersectMode mode : modes)
+        {
+          if (!supportsIntersectMode(device0,mode)) continue;
+          for (size_t i=0; i<size_t(100*state->intensity); i++)
+          {
+            RTCRayHit rays0[16], rays1[16];
+            for (size_t j=0; j<16; j++) {
+              const Vec3fa org = Vec3fa(float(numGrid)*random_float(),2.0f,float(numGrid)*random_float());
+              const Vec3fa dir = Vec3fa(2.0f*random_float()-1.0f,-1.0f,2.0f*random_float()-1.0f);
+              rays0[j] = rays1[j] = makeRay(org,dir);
+            }
+            IntersectWithMode(mode,VARIANT_INTERSECT_OCCLUDED,scene0,rays0,16);
+            IntersectWithMode(mode,VARIANT_INTERSECT_OCCLUDED,scene1,rays1,16);
+            for (size_t j=0; j<16; j++) {
+              if (rays0[j].hit.geomID != rays1[j].hit.geomID) return VerifyApplication::FAILED;
+              if (rays0[j].hit.primID != rays1[j].hit.primID) return VerifyApplication::FAILED;
+              if (rays0[j].ray.tfar != rays1[j].ray.tfar) return VerifyApplication::FAILED;
+            }
+          }
+        }
+      }
+      AssertNoError(device0);
+      AssertNoError(device1);
+
+      return VerifyApplication::PASSED;
+    }
+  };
+
+  struct MemoryBudgetTest : public VerifyApplication::Test
+  {
+    RTCBuildQuality quality;
+
+    MemoryBudgetTest (std::string name, int isa, RTCBuildQuality quality)
+      : VerifyApplication::Test(name,isa,VerifyApplication::TEST_SHOULD_PASS), quality(quality) {}
+
+    VerifyApplication::TestReturnValue run(VerifyApplication* state, bool silent)
+    {
+      std::string cfg = state->rtcore + ",isa="+stringOfISA(isa);
+      RTCDeviceRef device = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device));
+
+      const size_t numPhi = state->intensity < 1.0f ? 50 : 200;
+      Ref<SceneGraph::Node> sphere = SceneGraph::createTriangleSphere(zero,2.0f,numPhi);
+
+      VerifyScene scene0(device,SceneFlags(RTC_SCENE_FLAG_NONE,quality));
+      scene0.addGeometry(quality,sphere);
+      rtcCommitScene (scene0);
+      AssertNoError(device);
+
+      /* find the smallest budget that can be met, the builders have to fail cleanly for all smaller budgets */
+      Ref<VerifyScene> scene1 = nullptr;
+      size_t budget = 16*1024;
+      for (; budget < (size_t(1) << 32); budget *= 2)
+      {
+        scene1 = new VerifyScene(device,SceneFlags(RTC_SCENE_FLAG_NONE,quality));
+        rtcSetSceneMemoryBudget(*scene1,budget);
+        scene1->addGeometry(quality,sphere);
+        rtcCommitScene (*scene1);
+        const RTCError error = rtcGetDeviceError(device);
+        if (error == RTC_ERROR_NONE) break;
+        if (error != RTC_ERROR_OUT_OF_MEMORY) return VerifyApplication::FAILED;
+      }
+      if (budget == 16*1024 || budget >= (size_t(1) << 32))
+        return VerifyApplication::FAILED;
+
+      /* the scene built within the budget has to find the same hits */
+      for (size_t i=0; i<size_t(10000*state->intensity); i++)
+      {
+        const Vec3fa org = 2.0f*random_Vec3fa()-Vec3fa(1.0f);
+        const Vec3fa dir = 2.0f*random_Vec3fa()-Vec3fa(1.0f);
+        RTCRayHit ray0 = makeRay(org,dir);
+        RTCRayHit ray1 = makeRay(org,dir);
+        IntersectWithMode(MODE_INTERSECT1,VARIANT_INTERSECT,scene0,&ray0,1);
+        IntersectWithMode(MODE_INTERSECT1,VARIANT_INTERSECT,*scene1,&ray1,1);
+        if (ray1.hit.geomID == RTC_INVALID_GEOMETRY_ID) return VerifyApplication::FAILED;
+        if (ray0.hit.primID != ray1.hit.primID) return VerifyApplication::FAILED;
+        if (ray0.ray.tfar != ray1.ray.tfar) return VerifyApplication::FAILED;
+      }
+      AssertNoError(device);
+
+      return VerifyApplication::PASSED;
+    }
+  };
+
+  struct BlockPoolTest : public VerifyApplication::Test
+  {
+    RTCBuildQuality quality;
+
+    BlockPoolTest (std::string name, int isa, RTCBuildQuality quality)
+      : VerifyApplication::Test(name,isa,VerifyApplication::TEST_SHOULD_PASS), quality(quality) {}
+
+    VerifyApplication::TestReturnValue run(VerifyApplication* state, bool silent)
+    {
+      std::string cfg = state->rtcore + ",isa="+stringOfISA(isa);
+      RTCDeviceRef device0 = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device0));
+      RTCDeviceRef device1 = rtcNewDevice((cfg+",alloc_pool_size=256").c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device1));
+      if (rtcGetDeviceProperty(device0,RTC_DEVICE_PROPERTY_BLOCK_POOL_SIZE) != 0) return VerifyApplication::FAILED;
+      if (rtcGetDeviceProperty(device1,RTC_DEVICE_PROPERTY_BLOCK_POOL_SIZE) != 256*1024*1024) return VerifyApplication::FAILED;
+
+      const size_t numPhi = state->intensity < 1.0f ? 100 : 200;
+      Ref<SceneGraph::Node> sphere = SceneGraph::createTriangleSphere(zero,2.0f,numPhi);
+      VerifyScene scene0(device0,SceneFlags(RTC_SCENE_FLAG_NONE,quality));
+      scene0.addGeometry(quality,sphere);
+      rtcCommitScene (scene0);
+      AssertNoError(device0);
+
+      /* scenes built from recycled blocks have to find the same hits */
+      for (size_t round=0; round<3; round++)
+      {
+        Ref<VerifyScene> scene1 = new VerifyScene(device1,SceneFlags(RTC_SCENE_FLAG_NONE,quality));
+        scene1->addGeometry(quality,sphere);
+        rtcCommitScene (*scene1);
+        AssertNoError(device1);
+
+        for (size_t i=0; i<size_t(1000*state->intensity); i++)
+        {
+          const Vec3fa org = 2.0f*random_Vec3fa()-Vec3fa(1.0f);
+          const Vec3fa dir = 2.0f*random_Vec3fa()-Vec3fa(1.0f);
+          RTCRayHit ray0 = makeRay(org,dir);
+          RTCRayHit ray1 = makeRay(org,dir);
+          IntersectWithMode(MODE_INTERSECT1,VARIANT_INTERSECT,scene0,&ray0,1);
+          IntersectWithMode(MODE_INTERSECT1,VARIANT_INTERSECT,*scene1,&ray1,1);
+          if (ray0.hit.primID != ray1.hit.primID) return VerifyApplication::FAILED;
+          if (ray0.ray.tfar != ray1.ray.tfar) return VerifyApplication::FAILED;
+        }
+      }
+
+      /* all builds after the first one take blocks from the pool */
+      if (rtcGetDeviceProperty(device1,RTC_DEVICE_PROPERTY_BLOCK_POOL_HITS) == 0) return VerifyApplication::FAILED;
+      if (rtcGetDeviceProperty(device1,RTC_DEVICE_PROPERTY_BLOCK_POOL_BYTES) == 0) return VerifyApplication::FAILED;
+      if (rtcGetDeviceProperty(device0,RTC_DEVICE_PROPERTY_BLOCK_POOL_HITS) != 0) return VerifyApplication::FAILED;
+
+      /* shrinking the pool frees the pooled blocks */
+      rtcSetDeviceProperty(device1,RTC_DEVICE_PROPERTY_BLOCK_POOL_SIZE,0);
+      rtcSetDeviceProperty(device1,RTC_DEVICE_PROPERTY_BLOCK_POOL_HITS,0);
+      AssertNoError(device1);
+      if (rtcGetDeviceProperty(device1,RTC_DEVICE_PROPERTY_BLOCK_POOL_BYTES) != 0) return VerifyApplication::FAILED;
+      if (rtcGetDeviceProperty(device1,RTC_DEVICE_PROPERTY_BLOCK_POOL_HITS) != 0) return VerifyApplication::FAILED;
+      AssertNoError(device0);
+      AssertNoError(device1);
+
+      return VerifyApplication::PASSED;
+    }
+  };
+
+  struct UpdateInstancesTest : public VerifyApplication::Test
+  {
+    SceneFlags sflags;
+
+    UpdateInstancesTest (std::string name, int isa, SceneFlags sflags)
+      : VerifyApplication::Test(name,isa,VerifyApplication::TEST_SHOULD_PASS), sflags(sflags) {}
+
+    VerifyApplication::TestReturnValue run(VerifyApplication* state, bool silent)
+    {
+      RTCIntersectContext context;
+      rtcInitIntersectContext(&context);
+
+      std::string cfg = state->rtcore + ",isa="+stringOfISA(isa);
+      RTCDeviceRef device = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device));
+
+      VerifyScene object(device,SceneFlags(RTC_SCENE_FLAG_NONE,RTC_BUILD_QUALITY_MEDIUM));
+      object.addSphere(sampler,RTC_BUILD_QUALITY_MEDIUM,zero,0.4f,20);
+      rtcCommitScene(object);
+      AssertNoError(device);
+
+      /* instances are placed into the cells of a grid with some jitter */
+      const unsigned int W = 16;
+      const unsigned int numInstances = W*W;
+      std::vector<unsigned int> cell(numInstances);
+      std::vector<Vec3fa> pos(numInstances);
+      std::vector<bool> enabled(numInstances,true);
+      VerifyScene scene(device,sflags);
+      for (unsigned int i=0; i<numInstances; i++)
+      {
+        cell[i] = i;
+        RTCGeometry instance = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_INSTANCE);
+        rtcSetGeometryInstancedScene(instance,object);
+        rtcAttachGeometryByID(scene,instance,i);
+        rtcReleaseGeometry(instance);
+      }
+      AssertNoError(device);
+
+      for (size_t frame=0; frame<32; frame++)
+      {
+        /* jitter a few instances and every fourth frame swap some instances far apart */
+        std::vector<bool> moved(numInstances,frame == 0);
+        for (unsigned int i=0; i<numInstances; i++)
+        {
+          if (random_int() % 32 == 0) moved[i] = true;
+          if (frame % 4 == 3 && random_int() % 16 == 0) {
+            const unsigned int j = random_int() % numInstances;
+            std::swap(cell[i],cell[j]);
+            moved[i] = moved[j] = true;
+          }
+        }
 
-        RTCRayHit ray0 = makeRay(pos0+Vec3fa(0,10,0),Vec3fa(0,-1,0)); // hits geomID == 0
-        RTCRayHit ray1 = makeRay(pos1+Vec3fa(0,10,0),Vec3fa(0,-1,0)); // hits geomID == 1
-        RTCRayHit ray2 = makeRay(pos2+Vec3fa(0,10,0),Vec3fa(0,-1,0)); // hits geomID == 2
-        RTCRayHit ray3 = makeRay(pos3+Vec3fa(0,10,0),Vec3fa(0,-1,0)); // hits geomID == 3
-        RTCRayHit testRays[4] = { ray0, ray1, ray2, ray3 };
+        for (unsigned int i=0; i<numInstances; i++)
+        {
+          if (!moved[i]) continue;
+          const Vec3fa jitter(0.6f*random_float()-0.3f,0.6f*random_float()-0.3f,0.0f);
+          pos[i] = Vec3fa(2.0f*float(cell[i] % W),2.0f*float(cell[i] / W),0.0f) + jitter;
+
+          RTCGeometry instance = rtcGetGeometry(scene,i);
+          const AffineSpace3fa xfm = AffineSpace3fa::translate(pos[i]);
+          rtcSetGeometryTransform(instance,0,RTC_FORMAT_FLOAT4X4_COLUMN_MAJOR,(float*)&xfm);
+          rtcCommitGeometry(instance);
+        }
 
-        const unsigned int maxRays = 100;
-        RTCRayHit rays[maxRays];
-        for (unsigned int numRays=1; numRays<maxRays; numRays++) {
-          for (size_t i=0; i<numRays; i++) rays[i] = testRays[i%4];
-          IntersectWithMode(imode,ivariant,scene,rays,numRays);
-          for (size_t i=0; i<numRays; i++)
-            if (ivariant & VARIANT_INTERSECT) {
-              if (rays[i].hit.geomID == RTC_INVALID_GEOMETRY_ID)
-                return VerifyApplication::FAILED;
-            }
-            else {
-              if (rays[i].ray.tfar != float(neg_inf))
-                return VerifyApplication::FAILED;
-            }
+        /* occasionally toggle some instance */
+        if (frame % 8 == 5) {
+          const unsigned int i = random_int() % numInstances;
+          enabled[i] = !enabled[i];
+          if (enabled[i]) rtcEnableGeometry(rtcGetGeometry(scene,i));
+          else            rtcDisableGeometry(rtcGetGeometry(scene,i));
+        }
+
+        rtcCommitScene(scene);
+        AssertNoError(device);
+
+        for (unsigned int i=0; i<numInstances; i++)
+        {
+          RTCRayHit ray = makeRay(pos[i]+Vec3fa(0.0f,0.0f,10.0f),Vec3fa(0.0f,0.0f,-1.0f));
+          rtcIntersect1(scene,&context,&ray);
+          const unsigned int expected = enabled[i] ? i : RTC_INVALID_GEOMETRY_ID;
+          if (ray.hit.instID[0] != expected) return VerifyApplication::FAILED;
         }
       }
       AssertNoError(device);
@@ -1970,6 +2987,65 @@ namespace embree
     }
   };
 
+  struct TessellationCacheTest : public VerifyApplication::Test
+  {
+    TessellationCacheTest (std::string name, int isa)
+      : VerifyApplication::Test(name,isa,VerifyApplication::TEST_SHOULD_PASS) {}
+
+    VerifyApplication::TestReturnValue run(VerifyApplication* state, bool silent)
+    {
+      std::string cfg = state->rtcore + ",isa="+stringOfISA(isa);
+      RTCDeviceRef device = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device));
+      RTCDeviceRef device2 = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device2));
+
+      RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_SUBDIVISION);
+      rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT, interpolation_quad_indices, 0, sizeof(unsigned int), num_interpolation_quad_faces*4);
+      rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_FACE,  0, RTC_FORMAT_UINT, interpolation_quad_faces,   0, sizeof(unsigned int), num_interpolation_quad_faces);
+      std::vector<Vec3fa> vertices(num_interpolation_vertices);
+      for (size_t i=0; i<vertices.size(); i++) vertices[i] = random_Vec3fa();
+      rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3, vertices.data(), 0, sizeof(Vec3fa), num_interpolation_vertices);
+      rtcCommitGeometry(geom);
+      AssertNoError(device);
+
+      auto interpolateAll = [&] () {
+        for (unsigned int f=0; f<num_interpolation_quad_faces; f++) {
+          float P[3];
+          rtcInterpolate0(geom,f,0.3f,0.6f,RTC_BUFFER_TYPE_VERTEX,0,P,3);
+        }
+      };
+
+      /* the first pass builds all patches, the second pass finds them in the cache */
+      interpolateAll();
+      const ssize_t misses0 = rtcGetDeviceProperty(device,RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_MISSES);
+      const ssize_t hits0   = rtcGetDeviceProperty(device,RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_HITS);
+      interpolateAll();
+      const ssize_t misses1 = rtcGetDeviceProperty(device,RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_MISSES);
+      const ssize_t hits1   = rtcGetDeviceProperty(device,RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_HITS);
+      AssertNoError(device);
+      if (misses0 == 0 || misses1 != misses0) return VerifyApplication::FAILED;
+      if (hits1-hits0 != (ssize_t)num_interpolation_quad_faces) return VerifyApplication::FAILED;
+
+      /* the cache of some other device is not affected */
+      if (rtcGetDeviceProperty(device2,RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_HITS) != 0) return VerifyApplication::FAILED;
+      if (rtcGetDeviceProperty(device2,RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_MISSES) != 0) return VerifyApplication::FAILED;
+
+      /* resizing invalidates all patches */
+      const ssize_t size = 4*1024*1024;
+      rtcSetDeviceProperty(device,RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_SIZE,size);
+      AssertNoError(device);
+      if (rtcGetDeviceProperty(device,RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_SIZE) != size) return VerifyApplication::FAILED;
+      interpolateAll();
+      const ssize_t misses2 = rtcGetDeviceProperty(device,RTC_DEVICE_PROPERTY_TESSELLATION_CACHE_MISSES);
+      if (misses2 <= misses1) return VerifyApplication::FAILED;
+
+      rtcReleaseGeometry(geom);
+      AssertNoError(device);
+      return VerifyApplication::PASSED;
+    }
+  };
+
   struct InterpolateTrianglesTest : public VerifyApplication::Test
   {
     size_t N;
@@ -2340,6 +3416,65 @@ namespace embree
     }
   };
 
+  struct SceneStatisticsTest : public VerifyApplication::IntersectTest
+  {
+    SceneStatisticsTest (std::string name, int isa, IntersectMode imode, IntersectVariant ivariant)
+      : VerifyApplication::IntersectTest(name,isa,imode,ivariant,VerifyApplication::TEST_SHOULD_PASS) {}
+
+    static bool isZero(const RTCTraversalStatistics& stats) {
+      return stats.rays == 0 && stats.nodes == 0 && stats.leaves == 0 && stats.primitives == 0 && stats.filters == 0;
+    }
+
+    VerifyApplication::TestReturnValue run(VerifyApplication* state, bool silent)
+    {
+      std::string cfg = state->rtcore + ",isa="+stringOfISA(isa);
+      RTCDeviceRef device = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device));
+      if (!supportsIntersectMode(device,imode))
+        return VerifyApplication::SKIPPED;
+
+      const size_t numRays = 256;
+      RTCRayHit rays[numRays];
+      for (int statistics=0; statistics<2; statistics++)
+      {
+        VerifyScene scene(device,SceneFlags(statistics ? RTC_SCENE_FLAG_STATISTICS : RTC_SCENE_FLAG_NONE,RTC_BUILD_QUALITY_MEDIUM));
+        scene.addGeometry(RTC_BUILD_QUALITY_MEDIUM,SceneGraph::createTriangleSphere(zero,1.0f,50));
+        rtcCommitScene (scene);
+        AssertNoError(device);
+
+        for (size_t i=0; i<numRays; i++) {
+          Vec3fa to(2.0f*random_float()-1.0f,2.0f*random_float()-1.0f,0.0f);
+          rays[i] = makeRay(Vec3fa(0.0f,0.0f,-4.0f),0.5f*to-Vec3fa(0.0f,0.0f,-4.0f));
+        }
+        IntersectWithMode(imode,ivariant,scene,rays,numRays);
+        AssertNoError(device);
+
+        RTCSceneStatistics stats;
+        rtcGetSceneStatistics(scene,&stats);
+        AssertNoError(device);
+
+        const RTCTraversalStatistics& active   = (ivariant & VARIANT_INTERSECT) ? stats.intersect : stats.occluded;
+        const RTCTraversalStatistics& inactive = (ivariant & VARIANT_INTERSECT) ? stats.occluded  : stats.intersect;
+        if (!isZero(inactive)) return VerifyApplication::FAILED;
+
+        if (statistics) {
+          if (active.rays < numRays) return VerifyApplication::FAILED; // streams also count padding rays
+          if (active.nodes == 0 || active.leaves == 0) return VerifyApplication::FAILED;
+          if (active.primitives < active.leaves) return VerifyApplication::FAILED;
+          if (active.filters != 0) return VerifyApplication::FAILED;
+        }
+        else if (!isZero(active)) 
+          return VerifyApplication::FAILED;
+
+        rtcResetSceneStatistics(scene);
+        rtcGetSceneStatistics(scene,&stats);
+        AssertNoError(device);
+        if (!isZero(stats.intersect) || !isZero(stats.occluded)) return VerifyApplication::FAILED;
+      }
+      return VerifyApplication::PASSED;
+    }
+  };
+
   struct QuadHitTest : public VerifyApplication::IntersectTest
   {
     SceneFlags sflags; 
@@ -2419,6 +3554,191 @@ namespace embree
     }
   };
   
+  struct MixedGeometryHitTest : public VerifyApplication::IntersectTest
+  {
+    SceneFlags sflags; 
+
+    MixedGeometryHitTest (std::string name, int isa, SceneFlags sflags, IntersectMode imode, IntersectVariant ivariant)
+      : VerifyApplication::IntersectTest(name,isa,imode,ivariant,VerifyApplication::TEST_SHOULD_PASS), sflags(sflags) {}
+
+    VerifyApplication::TestReturnValue run(VerifyApplication* state, bool silent)
+    {
+      std::string cfg = state->rtcore + ",isa="+stringOfISA(isa);
+      RTCDeviceRef device = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device));
+      if (!supportsIntersectMode(device,imode))
+        return VerifyApplication::SKIPPED;
+
+      /* a quad at z=0 and two triangles at z=2 end up in different acceleration structures */
+      Vec3f quadVertices[5] = {
+        Vec3f(0.0f,0.0f,0.0f), Vec3f(1.0f,0.0f,0.0f), Vec3f(1.0f,1.0f,0.0f), Vec3f(0.0f,1.0f,0.0f), Vec3f(zero)
+      };
+      Vec3f triangleVertices[5] = {
+        Vec3f(0.0f,0.0f,2.0f), Vec3f(1.0f,0.0f,2.0f), Vec3f(1.0f,1.0f,2.0f), Vec3f(0.0f,1.0f,2.0f), Vec3f(zero)
+      };
+      int quads[4] = { 0,1,2,3 };
+      int triangles[6] = { 0,1,2, 0,2,3 };
+
+      RTCSceneRef scene = rtcNewScene(device);
+      rtcSetSceneFlags(scene,sflags.sflags);
+      rtcSetSceneBuildQuality(scene,sflags.qflags);
+
+      RTCGeometry quad = rtcNewGeometry (device, RTC_GEOMETRY_TYPE_QUAD);
+      rtcSetSharedGeometryBuffer(quad, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3, quadVertices, 0, sizeof(Vec3f), 4);
+      rtcSetSharedGeometryBuffer(quad, RTC_BUFFER_TYPE_INDEX , 0, RTC_FORMAT_UINT4,  quads, 0, 4*sizeof(int), 1);
+      rtcCommitGeometry(quad);
+      const unsigned int quadID = rtcAttachGeometry(scene,quad);
+      rtcReleaseGeometry(quad);
+
+      RTCGeometry triangle = rtcNewGeometry (device, RTC_GEOMETRY_TYPE_TRIANGLE);
+      rtcSetSharedGeometryBuffer(triangle, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3, triangleVertices, 0, sizeof(Vec3f), 4);
+      rtcSetSharedGeometryBuffer(triangle, RTC_BUFFER_TYPE_INDEX , 0, RTC_FORMAT_UINT3,  triangles, 0, 3*sizeof(int), 2);
+      rtcCommitGeometry(triangle);
+      const unsigned int triangleID = rtcAttachGeometry(scene,triangle);
+      rtcReleaseGeometry(triangle);
+      rtcCommitScene (scene);
+      AssertNoError(device);
+
+      /* rays alternate between both sides, some rays miss both geometries */
+      RTCRayHit rays[256];
+      unsigned int expected[256];
+      for (size_t i=0; i<256; i++)
+      {
+        const float u = 0.1f+0.8f*random_float();
+        const float v = (i%5 == 4) ? 1.5f : 0.1f+0.8f*random_float();
+        const bool front = i%2 == 0;
+        rays[i] = makeRay(Vec3fa(u,v,front ? -1.0f : 3.0f),Vec3fa(0.0f,0.0f,front ? 1.0f : -1.0f));
+        if (v > 1.0f) expected[i] = RTC_INVALID_GEOMETRY_ID;
+        else          expected[i] = front ? quadID : triangleID;
+      }
+      IntersectWithMode(imode,ivariant,scene,rays,256);
+
+      for (size_t i=0; i<256; i++)
+      {
+        if (!(ivariant & VARIANT_INTERSECT))
+        {
+          const bool hit = rays[i].ray.tfar == float(neg_inf);
+          if (hit != (expected[i] != RTC_INVALID_GEOMETRY_ID)) return VerifyApplication::FAILED;
+          continue;
+        }
+        if (rays[i].hit.geomID != expected[i]) return VerifyApplication::FAILED;
+        if (expected[i] != RTC_INVALID_GEOMETRY_ID && abs(rays[i].ray.tfar - 1.0f) > 16.0f*float(ulp)) return VerifyApplication::FAILED;
+      }
+      AssertNoError(device);
+      
+      return VerifyApplication::PASSED;
+    }
+  };
+  
+  struct InstanceLevelsHitTest : public VerifyApplication::IntersectTest
+  {
+    SceneFlags sflags;
+    unsigned int levels;
+
+    InstanceLevelsHitTest (std::string name, int isa, SceneFlags sflags, unsigned int levels, IntersectMode imode, IntersectVariant ivariant)
+      : VerifyApplication::IntersectTest(name,isa,imode,ivariant,VerifyApplication::TEST_SHOULD_PASS), sflags(sflags), levels(levels) {}
+
+    VerifyApplication::TestReturnValue run(VerifyApplication* state, bool silent)
+    {
+      std::string cfg = state->rtcore + ",isa="+stringOfISA(isa);
+      RTCDeviceRef device = rtcNewDevice(cfg.c_str());
+      errorHandler(nullptr,rtcGetDeviceError(device));
+      if (!supportsIntersectMode(device,imode))
+        return VerifyApplication::SKIPPED;
+
+      Vec3f vertices[4] = {
+        Vec3f(0.0f,0.0f,0.0f),
+        Vec3f(1.0f,0.0f,0.0f),
+        Vec3f(0.0f,1.0f,0.0f),
+        Vec3f(zero) // dummy vertex for 16 byte padding
+      };
+      Triangle triangles[1] = {
+        Triangle(0,1,2)
+      };
+      RTCScene scene = rtcNewScene(device);
+      rtcSetSceneFlags(scene,sflags.sflags);
+      rtcSetSceneBuildQuality(scene,sflags.qflags);
+      
+      RTCGeometry geom = rtcNewGeometry (device, RTC_GEOMETRY_TYPE_TRIANGLE);
+      rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3, vertices , 0, sizeof(Vec3f), 3);
+      rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_INDEX , 0, RTC_FORMAT_UINT3,  triangles, 0, sizeof(Triangle), 1);
+      rtcCommitGeometry(geom);
+      rtcAttachGeometry(scene,geom);
+      rtcReleaseGeometry(geom);
+      rtcCommitScene (scene);
+
+      /* nest the triangle scene into the requested number of instance levels, each translating by one unit along z */
+      const float xfm[12] = { 1.0f,0.0f,0.0f, 0.0f,1.0f,0.0f, 0.0f,0.0f,1.0f, 0.0f,0.0f,1.0f };
+      for (unsigned int l=0; l<levels; l++)
+      {
+        RTCScene parent = rtcNewScene(device);
+        rtcSetSceneFlags(parent,sflags.sflags);
+        rtcSetSceneBuildQuality(parent,sflags.qflags);
+        RTCGeometry instance = rtcNewGeometry (device, RTC_GEOMETRY_TYPE_INSTANCE);
+        rtcSetGeometryInstancedScene(instance,scene);
+        rtcSetGeometryTransform(instance,0,RTC_FORMAT_FLOAT3X4_COLUMN_MAJOR,xfm);
+        rtcCommitGeometry(instance);
+        rtcAttachGeometryByID(parent,instance,l+1);
+        rtcReleaseGeometry(instance);
+        rtcCommitScene (parent);
+        rtcReleaseScene(scene);
+        scene = parent;
+      }
+      RTCSceneRef top = scene;
+      AssertNoError(device);
+
+      float u[256], v[256];
+      RTCRayHit rays[256];
+      for (size_t i=0; i<256; i++)
+      {
+        u[i] = random_float(); 
+        v[i] = random_float();
+        Vec3fa from(0.0f,0.0f,-1.0f);
+        Vec3fa to = uniformSampleTriangle(vertices[1],vertices[2],vertices[0],u[i],v[i]) + Vec3fa(0.0f,0.0f,float(levels));
+        rays[i] = makeRay(from,(to-from)/float(levels+1));
+      }
+      IntersectWithMode(imode,ivariant,top,rays,256);
+
+      /* instances deeper than the maximal instance level are ignored */
+      const bool expectHit = levels <= RTC_MAX_INSTANCE_LEVEL_COUNT;
+      for (size_t i=0; i<256; i++)
+      {
+        if (!(ivariant & VARIANT_INTERSECT)) 
+        {
+          if ((rays[i].ray.tfar == float(neg_inf)) != expectHit) return VerifyApplication::FAILED;
+          continue;
+        }
+
+        if (!expectHit) {
+          if (rays[i].hit.geomID != RTC_INVALID_GEOMETRY_ID) return VerifyApplication::FAILED;
+          continue;
+        }
+
+        if (rays[i].hit.geomID != 0) return VerifyApplication::FAILED;
+        if (rays[i].hit.primID != 0) return VerifyApplication::FAILED;
+        for (unsigned int l=0; l<RTC_MAX_INSTANCE_LEVEL_COUNT; l++) {
+          const unsigned int instID = l < levels ? levels-l : RTC_INVALID_GEOMETRY_ID;
+          if (rays[i].hit.instID[l] != instID) return VerifyApplication::FAILED;
+        }
+        if (abs(rays[i].hit.u - u[i]) > 16.0f*float(ulp)) return VerifyApplication::FAILED;
+        if (abs(rays[i].hit.v - v[i]) > 16.0f*float(ulp)) return VerifyApplication::FAILED;
+        if (abs(rays[i].ray.tfar - float(levels+1)) > 16.0f*float(levels+1)*float(ulp)) return VerifyApplication::FAILED;
+      }
+      AssertNoError(device);
+
+      return VerifyApplication::PASSED;
+    }
+
+    inline Vec3fa uniformSampleTriangle(const Vec3fa &a, const Vec3fa &b, const Vec3fa &c, float &u, float& v)
+    {
+      const float su = sqrtf(u);
+      v *= su;
+      u = 1.0f-su;
+      if (u < 0.001f || v < 0.001f || (u+v) > 0.999f) { u = 0.333f; v = 0.333f; } // avoid hitting edges
+      return c + u * (a-c) + v * (b-c);
+    }
+  };
+  
   struct RayMasksTest : public VerifyApplication::IntersectTest
   {
     SceneFlags sflags; 
@@ -4209,6 +5529,7 @@ namespace embree
     sceneFlags.push_back(SceneFlags(RTC_SCENE_FLAG_ROBUST,        RTC_BUILD_QUALITY_MEDIUM));
     sceneFlags.push_back(SceneFlags(RTC_SCENE_FLAG_COMPACT,       RTC_BUILD_QUALITY_MEDIUM));
     sceneFlags.push_back(SceneFlags(RTC_SCENE_FLAG_ROBUST | RTC_SCENE_FLAG_COMPACT,RTC_BUILD_QUALITY_MEDIUM));
+    sceneFlags.push_back(SceneFlags(RTC_SCENE_FLAG_COMPRESSED,    RTC_BUILD_QUALITY_MEDIUM));
     sceneFlags.push_back(SceneFlags(RTC_SCENE_FLAG_NONE,       RTC_BUILD_QUALITY_HIGH));
     sceneFlags.push_back(SceneFlags(RTC_SCENE_FLAG_DYNAMIC,       RTC_BUILD_QUALITY_LOW));
     sceneFlags.push_back(SceneFlags(RTC_SCENE_FLAG_DYNAMIC | RTC_SCENE_FLAG_ROBUST,        RTC_BUILD_QUALITY_LOW));
@@ -4261,6 +5582,26 @@ namespace embree
       for (auto gtype : gtypes_all)
         groups.top()->add(new GetLinearBoundsTest(to_string(gtype),isa,gtype));
       groups.pop();
+
+      push(new TestGroup("point_query",true,true));
+      for (auto gtype : { TRIANGLE_MESH, TRIANGLE_MESH_MB, QUAD_MESH, QUAD_MESH_MB })
+        for (auto sflags : sceneFlags)
+          for (bool instanced : { false, true })
+            groups.top()->add(new PointQueryTest(to_string(gtype)+"."+to_string(sflags)+(instanced ? ".instanced" : ""),isa,gtype,sflags,instanced));
+      groups.pop();
+
+      push(new TestGroup("collide",true,true));
+      for (auto gtype : { TRIANGLE_MESH, TRIANGLE_MESH_MB, QUAD_MESH, QUAD_MESH_MB })
+        for (auto sflags : sceneFlags)
+          for (bool self : { false, true })
+            groups.top()->add(new CollideTest(to_string(gtype)+"."+to_string(sflags)+(self ? ".self" : ""),isa,gtype,sflags,self));
+      groups.pop();
+
+      push(new TestGroup("save_load_bvh",true,true));
+      for (auto gtype : { TRIANGLE_MESH, TRIANGLE_MESH_MB, QUAD_MESH, QUAD_MESH_MB, GRID_MESH, GRID_MESH_MB })
+        for (auto sflags : sceneFlags)
+          groups.top()->add(new SaveLoadBVHTest(to_string(gtype)+"."+to_string(sflags),isa,gtype,sflags));
+      groups.pop();
       
       groups.top()->add(new GetUserDataTest("get_user_data",isa));
 
@@ -4312,6 +5653,11 @@ namespace embree
       for (auto sflags : sceneFlagsDynamic) 
         groups.top()->add(new EnableDisableGeometryTest(to_string(sflags),isa,sflags));
       groups.pop();
+
+      push(new TestGroup("update_instances",true,true));
+      for (auto sflags : sceneFlagsDynamic)
+        groups.top()->add(new UpdateInstancesTest(to_string(sflags),isa,sflags));
+      groups.pop();
       
       push(new TestGroup("update",true,true));
       for (auto sflags : sceneFlagsDynamic) {
@@ -4326,12 +5672,63 @@ namespace embree
       }
       groups.pop();
 
+      push(new TestGroup("refit_degradation",true,true));
+      groups.top()->add(new RefitDegradationTest("refit",isa,"refit_rotations=0,refit_rebuild_threshold=0"));
+      groups.top()->add(new RefitDegradationTest("rotations",isa,"refit_rotations=1,refit_rebuild_threshold=0"));
+      groups.top()->add(new RefitDegradationTest("rebuild",isa,"refit_rotations=1,refit_rebuild_threshold=1.5"));
+      groups.pop();
+
+      push(new TestGroup("ploc_builder",true,true));
+      groups.top()->add(new CompareBuildersTest("triangles",isa,"triangles","tri_builder=ploc"));
+      groups.top()->add(new CompareBuildersTest("quads",isa,"quads","quad_builder=ploc"));
+      groups.pop();
+
+      push(new TestGroup("memory_budget",true,true));
+      groups.top()->add(new MemoryBudgetTest("medium",isa,RTC_BUILD_QUALITY_MEDIUM));
+      groups.top()->add(new MemoryBudgetTest("high",isa,RTC_BUILD_QUALITY_HIGH));
+      groups.top()->add(new MemoryBudgetTest("low",isa,RTC_BUILD_QUALITY_LOW));
+      groups.pop();
+
+      push(new TestGroup("block_pool",true,true));
+      groups.top()->add(new BlockPoolTest("medium",isa,RTC_BUILD_QUALITY_MEDIUM));
+      groups.top()->add(new BlockPoolTest("high",isa,RTC_BUILD_QUALITY_HIGH));
+      groups.top()->add(new BlockPoolTest("low",isa,RTC_BUILD_QUALITY_LOW));
+      groups.pop();
+
+      groups.top()->add(new TwoLevelClustersTest("twolevel_clusters",isa));
+
+      push(new TestGroup("twolevel_refit",true,true));
+      groups.top()->add(new TwoLevelRefitTest("rebuild",isa,"twolevel_rebuild_threshold=0"));
+      groups.top()->add(new TwoLevelRefitTest("refit",isa,"twolevel_rebuild_threshold=1000"));
+      groups.top()->add(new TwoLevelRefitTest("refit_rebuild",isa,"twolevel_rebuild_threshold=1.05"));
+      groups.top()->add(new TwoLevelRefitTest("refit_clusters",isa,"twolevel_rebuild_threshold=1.05,twolevel_cluster_threshold=2"));
+      groups.pop();
+
+      push(new TestGroup("async_commit",true,true));
+      groups.top()->add(new AsyncCommitTest("static",isa,SceneFlags(RTC_SCENE_FLAG_NONE,RTC_BUILD_QUALITY_MEDIUM)));
+      groups.top()->add(new AsyncCommitTest("dynamic",isa,SceneFlags(RTC_SCENE_FLAG_DYNAMIC,RTC_BUILD_QUALITY_LOW)));
+      groups.top()->add(new AsyncCommitTest("high",isa,SceneFlags(RTC_SCENE_FLAG_NONE,RTC_BUILD_QUALITY_HIGH)));
+      groups.pop();
+
+      push(new TestGroup("numa",true,true));
+      groups.top()->add(new NumaTest("static",isa,SceneFlags(RTC_SCENE_FLAG_NONE,RTC_BUILD_QUALITY_MEDIUM)));
+      groups.top()->add(new NumaTest("dynamic",isa,SceneFlags(RTC_SCENE_FLAG_DYNAMIC,RTC_BUILD_QUALITY_LOW)));
+      groups.top()->add(new NumaTest("high",isa,SceneFlags(RTC_SCENE_FLAG_NONE,RTC_BUILD_QUALITY_HIGH)));
+      groups.pop();
+
+      push(new TestGroup("chunked_builder",true,true));
+      groups.top()->add(new CompareBuildersTest("triangles",isa,"triangles","tri_builder=sah_chunked,build_chunk_size=1000"));
+      groups.top()->add(new CompareBuildersTest("quads",isa,"quads","quad_builder=sah_chunked,build_chunk_size=1000"));
+      groups.top()->add(new CompareBuildersTest("spill",isa,"triangles","tri_builder=sah_chunked,build_chunk_size=1000,build_spill_dir=\".\""));
+      groups.pop();
+
       groups.top()->add(new GarbageGeometryTest("build_garbage_geom",isa));
 
       GeometryType gtypes_memory[] = { TRIANGLE_MESH, TRIANGLE_MESH_MB, QUAD_MESH, QUAD_MESH_MB, HAIR_GEOMETRY, HAIR_GEOMETRY_MB, LINE_GEOMETRY, LINE_GEOMETRY_MB };
       std::vector<std::pair<SceneFlags,RTCBuildQuality>> sflags_quality_memory;
       sflags_quality_memory.push_back(std::make_pair(SceneFlags(RTC_SCENE_FLAG_NONE   ,RTC_BUILD_QUALITY_MEDIUM), RTC_BUILD_QUALITY_MEDIUM));
       sflags_quality_memory.push_back(std::make_pair(SceneFlags(RTC_SCENE_FLAG_COMPACT,RTC_BUILD_QUALITY_MEDIUM), RTC_BUILD_QUALITY_MEDIUM));
+      sflags_quality_memory.push_back(std::make_pair(SceneFlags(RTC_SCENE_FLAG_COMPRESSED,RTC_BUILD_QUALITY_MEDIUM), RTC_BUILD_QUALITY_MEDIUM));
       sflags_quality_memory.push_back(std::make_pair(SceneFlags(RTC_SCENE_FLAG_ROBUST ,RTC_BUILD_QUALITY_MEDIUM), RTC_BUILD_QUALITY_MEDIUM));
       sflags_quality_memory.push_back(std::make_pair(SceneFlags(RTC_SCENE_FLAG_DYNAMIC,RTC_BUILD_QUALITY_LOW)   , RTC_BUILD_QUALITY_LOW));
 
@@ -4367,6 +5764,8 @@ namespace embree
       for (auto s : interpolateTests)
         groups.top()->add(new InterpolateSubdivTest(std::to_string((long long)(s)),isa,s));
       groups.pop();
+
+      groups.top()->add(new TessellationCacheTest("tessellation_cache",isa));
         
       push(new TestGroup("hair",true,true));
       for (auto s : interpolateTests) 
@@ -4387,6 +5786,13 @@ namespace embree
                 groups.top()->add(new TriangleHitTest(to_string(sflags,imode,ivariant),isa,sflags,RTC_BUILD_QUALITY_MEDIUM,imode,ivariant));
       groups.pop();
       
+      push(new TestGroup("scene_statistics",true,true));
+      for (auto imode : intersectModes) 
+        for (auto ivariant : intersectVariants)
+          if (has_variant(imode,ivariant) && (ivariant & VARIANT_INTERSECT_OCCLUDED) != VARIANT_INTERSECT_OCCLUDED)
+            groups.top()->add(new SceneStatisticsTest(to_string(imode,ivariant),isa,imode,ivariant));
+      groups.pop();
+      
       push(new TestGroup("quad_hit",true,true));
       for (auto sflags : sceneFlags) 
         for (auto imode : intersectModes) 
@@ -4395,6 +5801,23 @@ namespace embree
                 groups.top()->add(new QuadHitTest(to_string(sflags,imode,ivariant),isa,sflags,RTC_BUILD_QUALITY_MEDIUM,imode,ivariant));
       groups.pop();
 
+      push(new TestGroup("mixed_geometry_hit",true,true));
+      for (auto sflags : sceneFlags) 
+        for (auto imode : intersectModes) 
+          for (auto ivariant : intersectVariants)
+            if (has_variant(imode,ivariant))
+                groups.top()->add(new MixedGeometryHitTest(to_string(sflags,imode,ivariant),isa,sflags,imode,ivariant));
+      groups.pop();
+
+      push(new TestGroup("instance_levels",true,true));
+      for (unsigned int levels=1; levels<=RTC_MAX_INSTANCE_LEVEL_COUNT+1; levels++)
+        for (auto sflags : sceneFlags) 
+          for (auto imode : intersectModes) 
+            for (auto ivariant : intersectVariants)
+              if (has_variant(imode,ivariant))
+                groups.top()->add(new InstanceLevelsHitTest(std::to_string((long long)levels)+"."+to_string(sflags,imode,ivariant),isa,sflags,levels,imode,ivariant));
+      groups.pop();
+
       if (rtcGetDeviceProperty(device,RTC_DEVICE_PROPERTY_RAY_MASK_SUPPORTED)) 
       {
         push(new TestGroup("ray_masks",true,true));